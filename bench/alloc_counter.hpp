@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+// The benchmark binary replaces the global operator new to count heap allocations, so each
+// case can report allocations per iteration next to its throughput
+namespace bench
+{
+    uint64_t allocations();
+}
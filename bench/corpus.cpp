@@ -0,0 +1,255 @@
+#include "corpus.hpp"
+
+namespace bench::corpus
+{
+    uint64_t Random::next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    namespace
+    {
+        const char *const words[] = {
+            "json", "parser", "stream", "value", "lorem", "ipsum", "delta", "orbit", "signal", "cache",
+            "render", "kernel", "vector", "prairie", "harbor", "lantern", "copper", "meadow", "quartz", "tundra"};
+        constexpr size_t word_count = sizeof(words) / sizeof(words[0]);
+
+        const char *const levels[] = {"DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR"};
+
+        void append_words(std::string &out, Random &random, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (i)
+                {
+                    out += ' ';
+                }
+                out += words[random.below(word_count)];
+            }
+        }
+
+        // Fixed-point decimal built from integers so formatting never depends on the locale or libc
+        void append_decimal(std::string &out, Random &random, uint64_t whole_bound, int fraction_digits)
+        {
+            if (random.below(2))
+            {
+                out += '-';
+            }
+            out += std::to_string(random.below(whole_bound));
+            out += '.';
+            for (int i = 0; i < fraction_digits; ++i)
+            {
+                out += static_cast<char>('0' + random.below(10));
+            }
+        }
+
+        void append_timestamp(std::string &out, Random &random)
+        {
+            // 2024-MM-DDTHH:MM:SSZ, zero padded
+            auto two = [&out](uint64_t v)
+            {
+                out += static_cast<char>('0' + v / 10);
+                out += static_cast<char>('0' + v % 10);
+            };
+            out += "2024-";
+            two(1 + random.below(12));
+            out += '-';
+            two(1 + random.below(28));
+            out += 'T';
+            two(random.below(24));
+            out += ':';
+            two(random.below(60));
+            out += ':';
+            two(random.below(60));
+            out += 'Z';
+        }
+    }
+
+    std::string twitter_like(size_t statuses, uint64_t seed)
+    {
+        Random random(seed);
+        std::string out = "{\"statuses\": [";
+        for (size_t i = 0; i < statuses; ++i)
+        {
+            if (i)
+            {
+                out += ", ";
+            }
+            uint64_t user = random.below(100000);
+            out += "{\"id\": " + std::to_string(1000000000000ull + random.below(1000000000ull));
+            out += ", \"created_at\": \"";
+            append_timestamp(out, random);
+            out += "\", \"text\": \"";
+            append_words(out, random, 8 + random.below(16));
+            if (random.below(4) == 0)
+            {
+                out += " \\u00e9t\\u00e9 \xE4\xB8\x96\xE7\x95\x8C"; // escaped and raw non-ASCII
+            }
+            out += "\", \"user\": {\"id\": " + std::to_string(user);
+            out += ", \"screen_name\": \"user_" + std::to_string(user);
+            out += "\", \"followers_count\": " + std::to_string(random.below(50000));
+            out += ", \"verified\": ";
+            out += random.below(10) == 0 ? "true" : "false";
+            out += ", \"description\": \"";
+            append_words(out, random, 4 + random.below(8));
+            out += "\"}, \"entities\": {\"hashtags\": [";
+            size_t tags = random.below(4);
+            for (size_t t = 0; t < tags; ++t)
+            {
+                if (t)
+                {
+                    out += ", ";
+                }
+                out += "{\"text\": \"";
+                out += words[random.below(word_count)];
+                out += "\", \"indices\": [" + std::to_string(t * 10) + ", " + std::to_string(t * 10 + 8) + "]}";
+            }
+            out += "]}, \"retweet_count\": " + std::to_string(random.below(1000));
+            out += ", \"in_reply_to\": ";
+            out += random.below(3) == 0 ? std::to_string(random.below(1000000)) : "null";
+            out += '}';
+        }
+        out += "], \"search_metadata\": {\"count\": " + std::to_string(statuses) + ", \"completed_in\": 0.087}}";
+        return out;
+    }
+
+    std::string canada_like(size_t points, uint64_t seed)
+    {
+        Random random(seed);
+        std::string out = "{\"type\": \"FeatureCollection\", \"features\": [{\"type\": \"Feature\", "
+                          "\"properties\": {\"name\": \"Canada\"}, \"geometry\": {\"type\": \"Polygon\", \"coordinates\": [";
+        constexpr size_t ring_size = 512;
+        for (size_t i = 0; i < points; ++i)
+        {
+            if (i % ring_size == 0)
+            {
+                out += i ? "], [" : "[";
+            }
+            else
+            {
+                out += ", ";
+            }
+            out += '[';
+            append_decimal(out, random, 180, 14);
+            out += ", ";
+            append_decimal(out, random, 90, 14);
+            out += ']';
+        }
+        out += points ? "]]}}]}" : "]}}]}";
+        return out;
+    }
+
+    std::string log_ndjson(size_t lines, uint64_t seed)
+    {
+        Random random(seed);
+        std::string out;
+        for (size_t i = 0; i < lines; ++i)
+        {
+            out += "{\"ts\": \"";
+            append_timestamp(out, random);
+            out += "\", \"level\": \"";
+            out += levels[random.below(sizeof(levels) / sizeof(levels[0]))];
+            out += "\", \"service\": \"";
+            out += words[random.below(word_count)];
+            out += "\", \"latency_ms\": ";
+            append_decimal(out, random, 2000, 3);
+            out += ", \"status\": " + std::to_string(200 + 100 * random.below(4));
+            out += ", \"message\": \"";
+            append_words(out, random, 5 + random.below(10));
+            out += "\", \"request\": {\"path\": \"/api/";
+            out += words[random.below(word_count)];
+            out += "\", \"bytes\": " + std::to_string(random.below(1 << 20)) + "}}\n";
+        }
+        return out;
+    }
+
+    std::string escape_heavy(size_t strings, uint64_t seed)
+    {
+        static const char *const escapes[] = {"\\n", "\\t", "\\\"", "\\\\", "\\/", "\\u00e9", "\\u4e16", "\\ud83c\\udf0d"};
+        Random random(seed);
+        std::string out = "{\"text\": [";
+        for (size_t i = 0; i < strings; ++i)
+        {
+            if (i)
+            {
+                out += ", ";
+            }
+            out += '"';
+            size_t pieces = 8 + random.below(8);
+            for (size_t p = 0; p < pieces; ++p)
+            {
+                out += words[random.below(word_count)];
+                out += escapes[random.below(sizeof(escapes) / sizeof(escapes[0]))];
+            }
+            out += '"';
+        }
+        out += "]}";
+        return out;
+    }
+
+    std::string number_heavy(size_t numbers, uint64_t seed)
+    {
+        Random random(seed);
+        std::string out = "{\"values\": [";
+        for (size_t i = 0; i < numbers; ++i)
+        {
+            if (i)
+            {
+                out += ", ";
+            }
+            switch (random.below(3))
+            {
+            case 0:
+                out += std::to_string(static_cast<int64_t>(random.below(2000000000)) - 1000000000);
+                break;
+            case 1:
+                append_decimal(out, random, 100000, 6);
+                break;
+            default:
+                append_decimal(out, random, 10, 4);
+                out += random.below(2) ? "e-" : "e+";
+                out += std::to_string(random.below(300));
+                break;
+            }
+        }
+        out += "]}";
+        return out;
+    }
+
+    std::string deep(size_t depth)
+    {
+        std::string out = "{\"root\": ";
+        out.append(depth, '[');
+        out += '1';
+        out.append(depth, ']');
+        out += '}';
+        return out;
+    }
+
+    std::string wide(size_t members, uint64_t seed)
+    {
+        Random random(seed);
+        std::string out = "{";
+        for (size_t i = 0; i < members; ++i)
+        {
+            if (i)
+            {
+                out += ", ";
+            }
+            out += "\"k" + std::to_string(i) + "\": ";
+            if (random.below(2))
+            {
+                out += std::to_string(random.below(1000000));
+            }
+            else
+            {
+                out += "\"v" + std::to_string(i) + '"';
+            }
+        }
+        out += '}';
+        return out;
+    }
+}
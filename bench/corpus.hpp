@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Deterministic synthetic documents for the benchmarks. Every generator is a pure function
+// of its arguments (fixed seed, integer-only formatting of the random stream), so the same
+// call yields byte-identical text on every platform and commit.
+namespace bench::corpus
+{
+    // Small fixed-seed PRNG (splitmix64); std distributions differ between standard libraries
+    class Random
+    {
+    public:
+        explicit Random(uint64_t seed) : state(seed) {}
+
+        uint64_t next();
+        // Uniform in [0, bound)
+        uint64_t below(uint64_t bound) { return next() % bound; }
+
+    private:
+        uint64_t state;
+    };
+
+    // Social-feed style object: {"statuses": [...]} with users, entities and mixed strings
+    std::string twitter_like(size_t statuses, uint64_t seed = 1);
+
+    // GeoJSON polygon rings, almost entirely floating-point coordinates
+    std::string canada_like(size_t points, uint64_t seed = 2);
+
+    // One log record per line (NDJSON); each line is a complete object
+    std::string log_ndjson(size_t lines, uint64_t seed = 3);
+
+    // {"text": [...]} of strings dense with \n, \", \\ and \u escapes
+    std::string escape_heavy(size_t strings, uint64_t seed = 4);
+
+    // {"values": [...]} of integers, decimals and exponents
+    std::string number_heavy(size_t numbers, uint64_t seed = 5);
+
+    // {"root": [[[ ... ]]]} nested depth levels
+    std::string deep(size_t depth);
+
+    // {"k0": 0, "k1": "v1", ...} with members keys at one level
+    std::string wide(size_t members, uint64_t seed = 6);
+}
@@ -0,0 +1,259 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../json-parser.hpp"
+#include "alloc_counter.hpp"
+#include "corpus.hpp"
+
+using namespace hh_json;
+
+namespace
+{
+    struct Document
+    {
+        const char *name;
+        std::string text;
+    };
+
+    // Sizes are chosen so each document is a few hundred KB to a few MB
+    const std::vector<Document> &documents()
+    {
+        static const std::vector<Document> docs = {
+            {"twitter", bench::corpus::twitter_like(2000)},
+            {"canada", bench::corpus::canada_like(50000)},
+            {"escapes", bench::corpus::escape_heavy(5000)},
+            {"numbers", bench::corpus::number_heavy(100000)},
+            {"deep", bench::corpus::deep(1000)},
+            {"wide", bench::corpus::wide(50000)},
+        };
+        return docs;
+    }
+
+    // Reports throughput over bytes per iteration and the average heap allocations per iteration
+    void report(benchmark::State &state, size_t bytes, uint64_t allocations_before)
+    {
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+        state.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(bench::allocations() - allocations_before), benchmark::Counter::kAvgIterations);
+    }
+
+    void parse_document(benchmark::State &state, const std::string &text, ParseOptions options)
+    {
+        uint64_t before = bench::allocations();
+        for (auto _ : state)
+        {
+            auto parsed = parse(text, options);
+            benchmark::DoNotOptimize(parsed);
+        }
+        report(state, text.size(), before);
+    }
+
+    // Same document through one Parser, the way a server thread handles request after request
+    void parse_reused(benchmark::State &state, const std::string &text)
+    {
+        Parser parser;
+        uint64_t before = bench::allocations();
+        for (auto _ : state)
+        {
+            auto parsed = parser.parse(text);
+            benchmark::DoNotOptimize(parsed);
+        }
+        report(state, text.size(), before);
+    }
+
+    void json_value(benchmark::State &state, const std::string &text)
+    {
+        uint64_t before = bench::allocations();
+        for (auto _ : state)
+        {
+            auto value = JsonValue(text);
+            benchmark::DoNotOptimize(value);
+        }
+        report(state, text.size(), before);
+    }
+
+    void stringify_document(benchmark::State &state, const std::string &text)
+    {
+        auto root = JsonValue(text);
+        size_t bytes = root->stringify().size();
+        uint64_t before = bench::allocations();
+        for (auto _ : state)
+        {
+            auto out = root->stringify();
+            benchmark::DoNotOptimize(out);
+        }
+        report(state, bytes, before);
+    }
+
+    // Hash of the canonical form, streamed without building the text
+    void canonical_hash(benchmark::State &state, const std::string &text)
+    {
+        auto root = JsonValue(text);
+        size_t bytes = canonical::stringify(root).size();
+        uint64_t before = bench::allocations();
+        for (auto _ : state)
+        {
+            auto digest = canonical::hash(root);
+            benchmark::DoNotOptimize(digest);
+        }
+        report(state, bytes, before);
+    }
+
+    // One parse per line, the way an NDJSON reader consumes log files; with reuse, all lines
+    // go through the same Parser
+    void parse_ndjson(benchmark::State &state, bool reuse)
+    {
+        static const std::string log = bench::corpus::log_ndjson(20000);
+        Parser parser;
+        uint64_t before = bench::allocations();
+        for (auto _ : state)
+        {
+            size_t start = 0;
+            while (start < log.size())
+            {
+                size_t end = log.find('\n', start);
+                if (reuse)
+                {
+                    auto record = parser.parse(log.substr(start, end - start));
+                    benchmark::DoNotOptimize(record);
+                }
+                else
+                {
+                    auto record = parse(log.substr(start, end - start));
+                    benchmark::DoNotOptimize(record);
+                }
+                start = end + 1;
+            }
+        }
+        report(state, log.size(), before);
+    }
+
+    // Exports the log records again: threads == 0 is the stringify()-and-concatenate baseline
+    void write_ndjson(benchmark::State &state, size_t threads)
+    {
+        static const std::string log = bench::corpus::log_ndjson(20000);
+        static const auto records = []
+        {
+            std::vector<std::shared_ptr<JsonObject>> parsed;
+            size_t start = 0;
+            while (start < log.size())
+            {
+                size_t end = log.find('\n', start);
+                parsed.push_back(std::make_shared<JsonObject>(parse(log.substr(start, end - start))));
+                start = end + 1;
+            }
+            return parsed;
+        }();
+        ndjson::WriteOptions options;
+        options.threads = threads;
+        std::string out;
+        ndjson::StringSink sink(out);
+        uint64_t before = bench::allocations();
+        for (auto _ : state)
+        {
+            out.clear();
+            if (threads == 0)
+            {
+                for (const auto &record : records)
+                {
+                    out += record->stringify() + "\n";
+                }
+            }
+            else
+            {
+                ndjson::write(records, sink, options);
+            }
+            benchmark::DoNotOptimize(out);
+        }
+        report(state, log.size(), before);
+    }
+
+    // Walks every status the way application code reads fields out of a parsed document
+    void getters(benchmark::State &state)
+    {
+        static const std::string text = bench::corpus::twitter_like(2000);
+        auto parsed = parse(text);
+        uint64_t before = bench::allocations();
+        for (auto _ : state)
+        {
+            double ids = 0;
+            size_t characters = 0;
+            for (const auto &status : getter::get_array_ref(parsed["statuses"]))
+            {
+                ids += getter::get_number(status->get("id"));
+                characters += getter::get_string_view(status->get("text")).size();
+                characters += getter::get_string_view(status->get("user")->get("screen_name")).size();
+                if (getter::get_boolean(status->get("user")->get("verified")))
+                {
+                    ++characters;
+                }
+                characters += getter::get_array_ref(status->get("entities")->get("hashtags")).size();
+            }
+            benchmark::DoNotOptimize(ids);
+            benchmark::DoNotOptimize(characters);
+        }
+        report(state, text.size(), before);
+    }
+
+    void register_benchmarks()
+    {
+        ParseOptions lazy;
+        lazy.lazy_strings = true;
+        ParseOptions lazy_numbers;
+        lazy_numbers.lazy_numbers = true;
+
+        for (const auto &doc : documents())
+        {
+            const std::string *text = &doc.text;
+            benchmark::RegisterBenchmark((std::string("parse/") + doc.name).c_str(),
+                                         [text](benchmark::State &state)
+                                         { parse_document(state, *text, ParseOptions{}); });
+            benchmark::RegisterBenchmark((std::string("parse_lazy/") + doc.name).c_str(),
+                                         [text, lazy](benchmark::State &state)
+                                         { parse_document(state, *text, lazy); });
+            benchmark::RegisterBenchmark((std::string("parse_lazy_numbers/") + doc.name).c_str(),
+                                         [text, lazy_numbers](benchmark::State &state)
+                                         { parse_document(state, *text, lazy_numbers); });
+            benchmark::RegisterBenchmark((std::string("parse_reused/") + doc.name).c_str(),
+                                         [text](benchmark::State &state)
+                                         { parse_reused(state, *text); });
+            benchmark::RegisterBenchmark((std::string("JsonValue/") + doc.name).c_str(),
+                                         [text](benchmark::State &state)
+                                         { json_value(state, *text); });
+            benchmark::RegisterBenchmark((std::string("stringify/") + doc.name).c_str(),
+                                         [text](benchmark::State &state)
+                                         { stringify_document(state, *text); });
+            benchmark::RegisterBenchmark((std::string("canonical_hash/") + doc.name).c_str(),
+                                         [text](benchmark::State &state)
+                                         { canonical_hash(state, *text); });
+        }
+        benchmark::RegisterBenchmark("parse/log_ndjson", [](benchmark::State &state)
+                                     { parse_ndjson(state, false); });
+        benchmark::RegisterBenchmark("parse_reused/log_ndjson", [](benchmark::State &state)
+                                     { parse_ndjson(state, true); });
+        for (size_t threads : {0, 1, 4})
+        {
+            benchmark::RegisterBenchmark((std::string("write_ndjson/threads:") + std::to_string(threads)).c_str(),
+                                         [threads](benchmark::State &state)
+                                         { write_ndjson(state, threads); });
+        }
+        benchmark::RegisterBenchmark("getters/twitter", getters);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    register_benchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
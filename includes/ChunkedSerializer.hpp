@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "JsonObject.hpp"
+
+namespace hh_json
+{
+    /**
+     * Serializes a tree a piece at a time, e.g. to write a large document to a socket without
+     * building its whole text first. The pieces concatenate to exactly what stringify() gives.
+     *
+     * Nodes are walked with an explicit stack, so a piece can end between any two values. Node
+     * types other than the library's own objects and arrays are written whole. The tree must not
+     * change until the serializer is done.
+     */
+    class ChunkedSerializer
+    {
+    public:
+        explicit ChunkedSerializer(std::shared_ptr<const JsonObject> root); // null writes "null"
+
+        // Appends the next piece to out: at least max_bytes unless the document ends first,
+        // stopping at the first value boundary after that. Returns true once all is written.
+        bool write_some(std::string &out, size_t max_bytes);
+        bool done() const { return started && stack.empty(); }
+
+    private:
+        struct Frame
+        {
+            const JsonObject *node;
+            bool is_array;
+            bool first = true;
+            size_t index = 0; // arrays
+            std::unordered_map<std::string, std::shared_ptr<JsonObject>>::const_iterator member; // objects
+        };
+
+        void write_value(const JsonObject &value, std::string &out);
+
+        std::shared_ptr<const JsonObject> root;
+        std::vector<Frame> stack;
+        bool started = false;
+    };
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FrozenDocument.hpp"
+
+namespace hh_json
+{
+    namespace detail
+    {
+        struct ReaderSlot;
+        struct ReaderRegistry;
+    }
+
+    /**
+     * Current version of a document that writers replace while readers keep going (RCU).
+     *
+     * A writer parses and freezes the next version on its own thread, then publish() swaps it in
+     * with one atomic store. read() pins the version it sees through an epoch-based scheme: each
+     * reader thread announces the epoch it entered in a slot of its own, so entering and leaving
+     * a read touches no shared reference count. A replaced version is freed by a later publish()
+     * or reclaim() once no reader that could have seen it is still inside read().
+     *
+     * Readers on any number of threads are lock-free; writers are serialized by a mutex. The
+     * handle must outlive every ReadGuard taken from it.
+     */
+    class DocumentHandle
+    {
+    public:
+        // Pins the version that was current when it was created; keep it short-lived
+        class ReadGuard
+        {
+        public:
+            ReadGuard(ReadGuard &&other) noexcept
+                : document(std::exchange(other.document, nullptr)), slot(std::exchange(other.slot, nullptr)) {}
+            ReadGuard(const ReadGuard &) = delete;
+            ReadGuard &operator=(const ReadGuard &) = delete;
+            ReadGuard &operator=(ReadGuard &&) = delete;
+            ~ReadGuard();
+
+            const FrozenDocument &operator*() const { return *document; }
+            const FrozenDocument *operator->() const { return document; }
+            FrozenValue operator[](const std::string &key) const { return (*document)[key]; }
+
+        private:
+            friend class DocumentHandle;
+            ReadGuard(const FrozenDocument *document, detail::ReaderSlot *slot) : document(document), slot(slot) {}
+
+            const FrozenDocument *document;
+            detail::ReaderSlot *slot;
+        };
+
+        explicit DocumentHandle(FrozenDocument initial = FrozenDocument());
+        ~DocumentHandle();
+        DocumentHandle(const DocumentHandle &) = delete;
+        DocumentHandle &operator=(const DocumentHandle &) = delete;
+
+        ReadGuard read() const;
+
+        // Copy of the current version that stays valid after the guard is gone; costs a
+        // reference count increment, so prefer read() on hot paths
+        FrozenDocument snapshot() const;
+
+        // Makes next the current version and frees replaced versions no reader can still see
+        void publish(FrozenDocument next);
+
+        // Frees replaced versions that are no longer pinned; returns how many are still pending
+        size_t reclaim();
+
+        // Number of publish() calls so far
+        uint64_t version() const { return published.load(std::memory_order_relaxed); }
+
+    private:
+        struct Retired
+        {
+            uint64_t epoch; // global epoch when it was replaced
+            std::unique_ptr<const FrozenDocument> document;
+        };
+
+        detail::ReaderSlot &local_slot() const;
+        size_t reclaim_locked();
+
+        const uint64_t id; // distinguishes handles in the per-thread slot cache
+        std::shared_ptr<detail::ReaderRegistry> registry;
+        std::atomic<const FrozenDocument *> current;
+        std::atomic<uint64_t> published{0};
+
+        std::mutex writer_mutex;
+        std::vector<Retired> retired;
+    };
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "JsonObject.hpp"
+
+namespace hh_json
+{
+    class FrozenMembers;
+    class FrozenElements;
+
+    /**
+     * Read-only handle to one node of a FrozenDocument.
+     *
+     * Lookups never insert: a missing member or an out-of-range index yields a Null value. A
+     * FrozenValue is a plain pointer, so copying one costs nothing and touches no reference
+     * count; it is valid while its document is alive.
+     */
+    class FrozenValue
+    {
+    public:
+        FrozenValue() = default;
+
+        JsonType type() const;
+        bool is_null() const { return node == nullptr; }
+
+        // Members and elements; Null when missing or when this is not an object / array.
+        // Keys are the member's text; members() holds them in the escaped form they are stored in.
+        FrozenValue operator[](const std::string &key) const;
+        FrozenValue operator[](size_t index) const;
+        bool contains(const std::string &key) const;
+        size_t size() const; // members or elements; 0 for scalars
+
+        // Typed access; throws std::runtime_error on a type mismatch
+        double as_number() const;
+        bool as_boolean() const;
+        std::string_view as_string() const;
+        // Read-only views for iteration; they hand out FrozenValues, never the shared nodes
+        FrozenMembers members() const;
+        FrozenElements elements() const;
+
+        std::string stringify() const;
+        void stringify_to(std::string &out) const;
+
+        // The underlying node, for the const JsonObject API; nullptr for null
+        const JsonObject *get() const { return node; }
+
+    private:
+        friend class FrozenDocument;
+        friend class FrozenMembers;
+        friend class FrozenElements;
+        explicit FrozenValue(const JsonObject *node) : node(node) {}
+
+        const JsonObject *node = nullptr;
+    };
+
+    // Members of a frozen object as (stored key, FrozenValue) pairs, in unspecified order
+    class FrozenMembers
+    {
+        using Map = std::unordered_map<std::string, std::shared_ptr<JsonObject>>;
+
+    public:
+        class iterator
+        {
+        public:
+            std::pair<const std::string &, FrozenValue> operator*() const { return {it->first, FrozenValue(it->second.get())}; }
+            iterator &operator++()
+            {
+                ++it;
+                return *this;
+            }
+            bool operator==(const iterator &other) const { return it == other.it; }
+            bool operator!=(const iterator &other) const { return it != other.it; }
+
+        private:
+            friend class FrozenMembers;
+            explicit iterator(Map::const_iterator it) : it(it) {}
+
+            Map::const_iterator it;
+        };
+
+        iterator begin() const { return iterator(map->begin()); }
+        iterator end() const { return iterator(map->end()); }
+        size_t size() const { return map->size(); }
+        bool empty() const { return map->empty(); }
+
+    private:
+        friend class FrozenValue;
+        explicit FrozenMembers(const Map &map) : map(&map) {}
+
+        const Map *map;
+    };
+
+    // Elements of a frozen array as FrozenValues
+    class FrozenElements
+    {
+        using Vector = std::vector<std::shared_ptr<JsonObject>>;
+
+    public:
+        class iterator
+        {
+        public:
+            FrozenValue operator*() const { return FrozenValue(it->get()); }
+            iterator &operator++()
+            {
+                ++it;
+                return *this;
+            }
+            bool operator==(const iterator &other) const { return it == other.it; }
+            bool operator!=(const iterator &other) const { return it != other.it; }
+
+        private:
+            friend class FrozenElements;
+            explicit iterator(Vector::const_iterator it) : it(it) {}
+
+            Vector::const_iterator it;
+        };
+
+        iterator begin() const { return iterator(items->begin()); }
+        iterator end() const { return iterator(items->end()); }
+        size_t size() const { return items->size(); }
+        bool empty() const { return items->empty(); }
+        FrozenValue operator[](size_t index) const { return FrozenValue((*items)[index].get()); }
+
+    private:
+        friend class FrozenValue;
+        explicit FrozenElements(const Vector &items) : items(&items) {}
+
+        const Vector *items;
+    };
+
+    /**
+     * Parsed document that is never modified again, so any number of threads can read it
+     * without locks.
+     *
+     * Freezing decodes every lazy string and number up front. After that no read writes to a
+     * node: there are no inserting lookups and no caches filled on first access. Copies share
+     * the same tree.
+     */
+    class FrozenDocument
+    {
+    public:
+        FrozenDocument(); // empty object
+
+        FrozenValue root() const { return FrozenValue(tree.get()); }
+        FrozenValue operator[](const std::string &key) const { return root()[key]; }
+        bool contains(const std::string &key) const { return root().contains(key); }
+        std::string stringify() const { return root().stringify(); }
+
+        // Shared owner of the root, e.g. to keep the tree alive beside FrozenValues
+        const std::shared_ptr<const JsonObject> &shared() const { return tree; }
+
+        friend FrozenDocument freeze(std::unordered_map<std::string, std::shared_ptr<JsonObject>> &&members);
+        friend FrozenDocument freeze(const std::shared_ptr<JsonObject> &value);
+
+    private:
+        explicit FrozenDocument(std::shared_ptr<const JsonObject> tree) : tree(std::move(tree)) {}
+
+        std::shared_ptr<const JsonObject> tree;
+    };
+
+    // Adopts the members of a parse() result without copying them. The caller must not keep
+    // other references to those nodes.
+    FrozenDocument freeze(std::unordered_map<std::string, std::shared_ptr<JsonObject>> &&members);
+
+    // Deep-copies value, so later changes to it cannot race with readers of the frozen copy
+    FrozenDocument freeze(const std::shared_ptr<JsonObject> &value);
+}
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cerrno>
+#include <cstdlib>
 #include <vector>
 #include <stdexcept>
 #include <memory>
+#include <utility>
 #include "JsonObject.hpp"
 #include "parser.hpp"
 namespace hh_json
@@ -13,29 +16,25 @@ namespace hh_json
     public:
         std::vector<std::shared_ptr<JsonObject>> elements;
         JsonArray() = default;
-        JsonArray(const std::vector<std::shared_ptr<JsonObject>> &elements) : elements(elements) {}
+        JsonArray(std::vector<std::shared_ptr<JsonObject>> elements) : elements(std::move(elements)) {}
         ~JsonArray() = default;
 
         virtual std::shared_ptr<JsonObject> get([[maybe_unused]] const std::string &key) const
         {
-            try
+            // Same acceptance as std::stoi: optional whitespace and sign, then leading digits
+            const char *begin = key.c_str();
+            char *end = nullptr;
+            errno = 0;
+            long idx = std::strtol(begin, &end, 10);
+            if (end == begin)
             {
-                int idx = std::stoi(key);
-
-                if (idx < 0 || idx >= static_cast<int>(elements.size()))
-                {
-                    throw std::out_of_range("Invalid array index");
-                }
-                return elements[idx];
+                HH_JSON_THROW(std::runtime_error("JsonArray does not support key-based access with non-numeric keys"));
             }
-            catch (const std::invalid_argument &)
+            if (errno == ERANGE || idx < 0 || static_cast<unsigned long>(idx) >= elements.size())
             {
-                throw std::runtime_error("JsonArray does not support key-based access with non-numeric keys");
-            }
-            catch (const std::out_of_range &)
-            {
-                throw std::runtime_error("JsonArray index out of range");
+                HH_JSON_THROW(std::runtime_error("JsonArray index out of range"));
             }
+            return elements[idx];
         }
 
         bool set_json_data([[maybe_unused]] const std::string &jsonString) override
@@ -47,7 +46,7 @@ namespace hh_json
             }
             if (auto arr = std::dynamic_pointer_cast<JsonArray>(obj))
             {
-                elements = arr->elements;
+                elements = std::move(arr->elements);
             }
             else
             {
@@ -55,23 +54,37 @@ namespace hh_json
             }
             return true;
         }
+        JsonType type() const override
+        {
+            return JsonType::Array;
+        }
         void insert(std::shared_ptr<JsonObject> value)
         {
+            elements.push_back(std::move(value));
+        }
+        // Constructs the element in place at the end, returning the new node
+        template <typename T, typename... Args>
+        std::shared_ptr<T> emplace_back(Args &&...args)
+        {
+            auto value = std::make_shared<T>(std::forward<Args>(args)...);
             elements.push_back(value);
+            return value;
         }
-        std::string stringify() const override
+        void stringify_to(std::string &out) const override
         {
-            std::string result = "[";
-            for (const auto &element : elements)
-            {
-                result += element->stringify() + ",";
-            }
-            if (result.back() == ',')
+            out += '[';
+            for (size_t i = 0; i < elements.size(); ++i)
             {
-                result.pop_back(); // Remove trailing comma
+                if (i)
+                {
+                    out += ',';
+                }
+                if (elements[i])
+                    elements[i]->stringify_to(out);
+                else
+                    out += "null";
             }
-            result += "]";
-            return result;
+            out += ']';
         }
 
     private:
@@ -18,7 +18,7 @@ namespace hh_json
         ~JsonBoolean() = default;
         virtual std::shared_ptr<JsonObject> get([[maybe_unused]] const std::string &key) const
         {
-            throw std::runtime_error("JsonBoolean does not contain objects");
+            HH_JSON_THROW(std::runtime_error("JsonBoolean does not contain objects"));
         }
         bool set_json_data(const std::string &temp) override
         {
@@ -36,9 +36,13 @@ namespace hh_json
             }
             return false;
         }
-        std::string stringify() const override
+        JsonType type() const override
         {
-            return value ? "true" : "false";
+            return JsonType::Boolean;
+        }
+        void stringify_to(std::string &out) const override
+        {
+            out += value ? "true" : "false";
         }
 
     private:
@@ -1,5 +1,15 @@
 #pragma once
 
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
 #include "JsonObject.hpp"
 
 namespace hh_json
@@ -8,50 +18,193 @@ namespace hh_json
     {
 
     public:
-        double value;
+        // Converted value. 0 while the number is lazy; read through number() unless the node
+        // is known to be materialized. Do not write it while is_lazy(): stringify() keeps
+        // copying the source text and number() overwrites the write. Use set() instead.
+        mutable double value = 0;
         JsonNumber() = default;
 
         JsonNumber(double value) : value(value) {}
+
+        // Lazy number: refers to the text source[offset, offset + length), which the parser
+        // has already validated and range-checked, so converting it cannot fail
+        JsonNumber(std::shared_ptr<const std::string> source, size_t offset, size_t length)
+            : source(std::move(source)), offset(offset), length(length) {}
         ~JsonNumber() = default;
 
+        bool is_lazy() const
+        {
+            return source != nullptr;
+        }
+
+        // Turns a recycled node into a lazy number; same contract as the lazy constructor
+        void assign_lazy(std::shared_ptr<const std::string> text, size_t at, size_t size)
+        {
+            source = std::move(text);
+            offset = at;
+            length = size;
+        }
+
+        // The value, converting the text on first access. Like lazy strings, the first access
+        // writes to the node, so threads sharing a lazy node must synchronize it or call
+        // materialize() beforehand.
+        double number() const
+        {
+            materialize();
+            return value;
+        }
+
+        // Replaces the value, dropping lazy text
+        void set(double number)
+        {
+            value = number;
+            source.reset();
+        }
+
+        // Converts into value and drops the reference to the input buffer
+        void materialize() const
+        {
+            if (!source)
+            {
+                return;
+            }
+            convert(raw(), value);
+            source.reset();
+        }
+
+        // The number as a 64-bit integer if it is one. Untouched integer text converts
+        // exactly, beyond the 2^53 a double holds; nothing is materialized.
+        bool to_int64(int64_t &result) const
+        {
+            if (source)
+            {
+                std::string_view text = raw();
+                if (text.find_first_of(".eE") == std::string_view::npos)
+                {
+                    char buffer[32];
+                    if (text.size() >= sizeof(buffer))
+                    {
+                        return false;
+                    }
+                    std::memcpy(buffer, text.data(), text.size());
+                    buffer[text.size()] = '\0';
+                    errno = 0;
+                    long long parsed = std::strtoll(buffer, nullptr, 10);
+                    if (errno == ERANGE)
+                    {
+                        return false;
+                    }
+                    result = parsed;
+                    return true;
+                }
+            }
+            double converted = value;
+            if (source)
+            {
+                convert(raw(), converted);
+            }
+            // 2^63 is exactly representable; anything at or above it does not fit
+            if (converted != converted || converted < -9223372036854775808.0 || converted >= 9223372036854775808.0 ||
+                static_cast<double>(static_cast<int64_t>(converted)) != converted)
+            {
+                return false;
+            }
+            result = static_cast<int64_t>(converted);
+            return true;
+        }
+
         virtual std::shared_ptr<JsonObject> get([[maybe_unused]] const std::string &key) const
         {
-            throw std::runtime_error("JsonNumber does not contain objects");
+            HH_JSON_THROW(std::runtime_error("JsonNumber does not contain objects"));
         }
 
         bool set_json_data(const std::string &jsonString) override
         {
-            if (jsonString.empty())
+            if (!convert(jsonString.c_str(), jsonString.length(), value))
             {
                 return false;
             }
+            source.reset();
+            return true;
+        }
+        // Zero, dropping lazy text
+        void clear() override
+        {
+            value = 0;
+            source.reset();
+        }
 
-            try
+        // Converts the NUL-terminated text of the given length with strtod, with the same
+        // rejections std::stod would throw for; result is left alone on failure
+        static bool convert(const char *text, size_t length, double &result)
+        {
+            if (length == 0)
             {
-                size_t pos = 0;
-                double parsed_value = std::stod(jsonString, &pos);
-
-                // Check if the entire string was consumed (no trailing characters)
-                if (pos != jsonString.length())
-                {
-                    return false;
-                }
+                return false;
+            }
 
-                value = parsed_value;
-                return true;
+            char *end = nullptr;
+            errno = 0;
+            double parsed_value = std::strtod(text, &end);
+            if (end == text || errno == ERANGE)
+            {
+                return false;
             }
-            catch (...)
+
+            // Check if the entire string was consumed (no trailing characters)
+            if (static_cast<size_t>(end - text) != length)
             {
                 return false;
             }
+
+            result = parsed_value;
+            return true;
+        }
+
+        // Same for text that is not NUL-terminated, copied to the stack unless it is very long
+        static bool convert(std::string_view text, double &result)
+        {
+            char buffer[64];
+            if (text.size() < sizeof(buffer))
+            {
+                std::memcpy(buffer, text.data(), text.size());
+                buffer[text.size()] = '\0';
+                return convert(buffer, text.size(), result);
+            }
+            std::string copy(text);
+            return convert(copy.c_str(), copy.size(), result);
+        }
+
+        JsonType type() const override
+        {
+            return JsonType::Number;
         }
-        std::string stringify() const override
+        void stringify_to(std::string &out) const override
         {
+            if (source)
+            {
+                // Untouched input is already valid JSON; copy it verbatim
+                out.append(source->data() + offset, length);
+                return;
+            }
+            // Same text as std::to_string, formatted on the stack instead of in a temporary
+            char buffer[512];
+            int length;
             if ((long long)value == value)
-                return std::to_string((long long)value);
-            return std::to_string(value);
+                length = std::snprintf(buffer, sizeof(buffer), "%lld", (long long)value);
+            else
+                length = std::snprintf(buffer, sizeof(buffer), "%f", value);
+            out.append(buffer, static_cast<size_t>(length));
         }
 
     private:
+        std::string_view raw() const
+        {
+            return std::string_view(source->data() + offset, length);
+        }
+
+        mutable std::shared_ptr<const std::string> source;
+        size_t offset = 0;
+        size_t length = 0;
     };
 }
@@ -4,26 +4,67 @@
 #include <unordered_map>
 #include <memory>
 #include <stdexcept>
+#include <utility>
+
+#include "error.hpp"
 namespace hh_json
 {
+    // Dynamic type of a JSON value; JSON null is represented by a nullptr JsonObject
+    enum class JsonType
+    {
+        Null,
+        Object,
+        Array,
+        String,
+        Number,
+        Boolean
+    };
+
     class JsonObject
     {
         std::unordered_map<std::string, std::shared_ptr<JsonObject>> data;
 
     public:
         JsonObject();
-        JsonObject(const std::unordered_map<std::string, std::shared_ptr<JsonObject>> &initial_data);
+        JsonObject(std::unordered_map<std::string, std::shared_ptr<JsonObject>> initial_data);
         virtual ~JsonObject();
 
         virtual bool set_json_data(const std::string &jsonString);
-        virtual void insert(const std::string &key, std::shared_ptr<JsonObject> value);
+        virtual void insert(std::string key, std::shared_ptr<JsonObject> value);
         virtual void erase(const std::string &key);
         virtual std::shared_ptr<JsonObject> get(const std::string &key) const;
+        // Serializes through stringify_to into a per-thread buffer that keeps its capacity,
+        // so once warm the returned string is the only allocation
         virtual std::string stringify() const;
+        // Appends the serialization to out; allocates only when out has to grow
+        virtual void stringify_to(std::string &out) const;
         virtual void clear();
+        virtual JsonType type() const;
 
         const std::unordered_map<std::string, std::shared_ptr<JsonObject>> &get_data() const;
+        // Moves the members out, leaving this object empty
+        std::unordered_map<std::string, std::shared_ptr<JsonObject>> take_data();
+        void reserve(size_t count);
+
+        // Member entries as map node handles, so they can be moved between objects and reused
+        // without reallocating. extract_member() takes any member (an empty handle when there is
+        // none); insert_member() overwrites an existing key like insert() and returns the entry
+        // it did not need, or an empty handle.
+        std::unordered_map<std::string, std::shared_ptr<JsonObject>>::node_type extract_member();
+        std::unordered_map<std::string, std::shared_ptr<JsonObject>>::node_type
+        insert_member(std::unordered_map<std::string, std::shared_ptr<JsonObject>>::node_type member);
+
+        // Constructs the value in place and inserts it under key, returning the new node
+        template <typename T, typename... Args>
+        std::shared_ptr<T> emplace(std::string key, Args &&...args)
+        {
+            auto value = std::make_shared<T>(std::forward<Args>(args)...);
+            insert(std::move(key), value);
+            return value;
+        }
 
+        // Inserts an empty object when key is missing, so it is a write even when used to read;
+        // use get(), or freeze the document for sharing between threads
         std::shared_ptr<JsonObject> &operator[](const std::string &key);
 
         bool has_key(const std::string &key) const;
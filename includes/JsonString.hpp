@@ -1,89 +1,239 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include "JsonObject.hpp"
 
 namespace hh_json
 {
+    namespace detail
+    {
+        // Decodes the escapes of an already validated string body (the text between the quotes)
+        void unescape(std::string_view raw, std::string &out);
+
+        // Appends text with backslashes, quotes and control characters escaped; the common
+        // controls get their short escapes, the rest \u00XX
+        inline void append_escaped(std::string &out, std::string_view text)
+        {
+            static const char hex[] = "0123456789abcdef";
+            size_t copied = 0;
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                auto c = static_cast<unsigned char>(text[i]);
+                if (c >= 0x20 && c != '\\' && c != '\"')
+                    continue;
+                out.append(text.data() + copied, i - copied);
+                copied = i + 1;
+                out += '\\';
+                switch (c)
+                {
+                case '\\':
+                case '\"':
+                    out += static_cast<char>(c);
+                    break;
+                case '\n':
+                    out += 'n';
+                    break;
+                case '\r':
+                    out += 'r';
+                    break;
+                case '\t':
+                    out += 't';
+                    break;
+                case '\b':
+                    out += 'b';
+                    break;
+                case '\f':
+                    out += 'f';
+                    break;
+                default:
+                    out += "u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+                }
+            }
+            out.append(text.data() + copied, text.size() - copied);
+        }
+
+        // Object keys are stored as append_escaped leaves them (the parser escapes decoded keys);
+        // these convert between that stored form and the key's actual text
+        inline std::string escape_key(std::string_view key)
+        {
+            std::string stored;
+            append_escaped(stored, key);
+            return stored;
+        }
+
+        inline std::string unescape_key(std::string_view stored)
+        {
+            std::string key;
+            key.reserve(stored.size());
+            for (size_t i = 0; i < stored.size(); ++i)
+            {
+                if (stored[i] != '\\' || i + 1 == stored.size())
+                {
+                    key += stored[i];
+                    continue;
+                }
+                switch (stored[++i])
+                {
+                case 'n':
+                    key += '\n';
+                    break;
+                case 'r':
+                    key += '\r';
+                    break;
+                case 't':
+                    key += '\t';
+                    break;
+                case 'b':
+                    key += '\b';
+                    break;
+                case 'f':
+                    key += '\f';
+                    break;
+                case 'u':
+                    // Only \u00XX controls are produced
+                    if (i + 4 < stored.size())
+                    {
+                        auto digit = [](char c)
+                        { return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10; };
+                        key += static_cast<char>(digit(stored[i + 3]) * 16 + digit(stored[i + 4]));
+                        i += 4;
+                        break;
+                    }
+                    key += 'u';
+                    break;
+                default:
+                    key += stored[i];
+                }
+            }
+            return key;
+        }
+
+        // True if append_escaped would change text
+        inline bool needs_escaping(std::string_view text)
+        {
+            for (char ch : text)
+            {
+                auto c = static_cast<unsigned char>(ch);
+                if (c < 0x20 || c == '\\' || c == '\"')
+                    return true;
+            }
+            return false;
+        }
+    }
+
     class JsonString : public JsonObject
     {
 
     public:
-        std::string value;
+        // Decoded text. Empty while the string is lazy; read through str() or view() unless
+        // the node is known to be materialized. Do not write it while is_lazy(): view() and
+        // stringify() keep using the source slice and str() overwrites the write. Use set() instead.
+        mutable std::string value;
         JsonString() = default;
 
-        JsonString(const std::string &value) : value(value) {}
+        JsonString(std::string value) : value(std::move(value)) {}
+
+        // Lazy string: refers to the encoded body source[offset, offset + length), which the
+        // parser has already validated. escaped says whether it contains backslash escapes.
+        JsonString(std::shared_ptr<const std::string> source, size_t offset, size_t length, bool escaped)
+            : source(std::move(source)), offset(offset), length(length), escaped(escaped) {}
         ~JsonString() = default;
 
-        virtual std::shared_ptr<JsonObject> get([[maybe_unused]] const std::string &key) const
+        bool is_lazy() const
         {
-            throw std::runtime_error("JsonString does not contain objects");
+            return source != nullptr;
         }
-        bool set_json_data(const std::string &jsonString) override
-        {
-            value = jsonString;
-            return true;
-        }
-        std::string stringify() const override
-        {
-            // Handle escape characters properly
-            std::string escaped = value;
-            size_t pos = 0;
 
-            // Escape backslashes first (must be done before other escapes)
-            while ((pos = escaped.find("\\", pos)) != std::string::npos)
+        // Decoded text without copying when it has no escapes; otherwise decodes once.
+        // The first access of a lazy string writes to the node, so threads sharing a lazy
+        // node must synchronize it or call materialize() beforehand.
+        std::string_view view() const
+        {
+            if (source && !escaped)
             {
-                escaped.replace(pos, 1, "\\\\");
-                pos += 2; // Skip the newly inserted characters
+                return std::string_view(source->data() + offset, length);
             }
+            return str();
+        }
 
-            // Escape double quotes
-            pos = 0;
-            while ((pos = escaped.find("\"", pos)) != std::string::npos)
-            {
-                escaped.replace(pos, 1, "\\\"");
-                pos += 2; // Skip the newly inserted characters
-            }
+        const std::string &str() const
+        {
+            materialize();
+            return value;
+        }
+
+        // Replaces the text, dropping a lazy slice
+        void set(std::string text)
+        {
+            value = std::move(text);
+            source.reset();
+        }
 
-            // Escape other common characters
-            pos = 0;
-            while ((pos = escaped.find("\n", pos)) != std::string::npos)
+        // Decodes into value and drops the reference to the input buffer
+        void materialize() const
+        {
+            if (!source)
             {
-                escaped.replace(pos, 1, "\\n");
-                pos += 2;
+                return;
             }
-
-            pos = 0;
-            while ((pos = escaped.find("\r", pos)) != std::string::npos)
+            std::string_view raw(source->data() + offset, length);
+            if (escaped)
             {
-                escaped.replace(pos, 1, "\\r");
-                pos += 2;
+                value.clear();
+                detail::unescape(raw, value);
             }
-
-            pos = 0;
-            while ((pos = escaped.find("\t", pos)) != std::string::npos)
+            else
             {
-                escaped.replace(pos, 1, "\\t");
-                pos += 2;
+                value.assign(raw);
             }
+            source.reset();
+        }
 
-            pos = 0;
-            while ((pos = escaped.find("\b", pos)) != std::string::npos)
+        virtual std::shared_ptr<JsonObject> get([[maybe_unused]] const std::string &key) const
+        {
+            HH_JSON_THROW(std::runtime_error("JsonString does not contain objects"));
+        }
+        bool set_json_data(const std::string &jsonString) override
+        {
+            value = jsonString;
+            source.reset();
+            return true;
+        }
+        // Empties the string, keeping the capacity of value
+        void clear() override
+        {
+            value.clear();
+            source.reset();
+        }
+        JsonType type() const override
+        {
+            return JsonType::String;
+        }
+        void stringify_to(std::string &out) const override
+        {
+            out += '\"';
+            if (source)
             {
-                escaped.replace(pos, 1, "\\b");
-                pos += 2;
+                // Untouched input is already valid JSON (the scanner rejects raw control
+                // characters, so the slice needs no escaping); copy it verbatim
+                out.append(source->data() + offset, length);
             }
-
-            pos = 0;
-            while ((pos = escaped.find("\f", pos)) != std::string::npos)
+            else
             {
-                escaped.replace(pos, 1, "\\f");
-                pos += 2;
+                detail::append_escaped(out, value);
             }
-
-            return "\"" + escaped + "\"";
+            out += '\"';
         }
 
     private:
+        mutable std::shared_ptr<const std::string> source;
+        size_t offset = 0;
+        size_t length = 0;
+        bool escaped = false;
     };
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "JsonObject.hpp"
+
+namespace hh_json
+{
+    /**
+     * Bounded LRU cache of parsed documents keyed by an XXH64 hash of the input bytes.
+     *
+     * Repeated payloads (configs, feature flags) are parsed once; later calls return a
+     * shared handle to the same tree. Handles stay valid after eviction.
+     *
+     * The tree is const only at the top: get_data() and the array elements still hand out
+     * non-const shared_ptr<JsonObject> children. Callers must treat the whole tree as read-only,
+     * since a change made through one handle is seen by every later hit, on every thread. A
+     * document that will be modified should be parsed without the cache.
+     * The stored input is compared on every hit, so a hash collision is a miss, never a wrong document.
+     * All methods are thread-safe; parsing happens outside the lock.
+     */
+    class ParseCache
+    {
+    public:
+        struct Stats
+        {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            size_t entries = 0;
+            size_t bytes = 0; // estimated footprint of cached inputs and trees
+        };
+
+        explicit ParseCache(size_t max_bytes);
+
+        // Cached hh_json::parse; the returned object's get_data() is the parsed top-level map.
+        // Shared with other callers: do not modify anything reachable from it
+        std::shared_ptr<const JsonObject> parse(const std::string &jsonString);
+
+        // Cached hh_json::JsonValue; inputs JsonValue rejects are returned as nullptr and not cached
+        std::shared_ptr<const JsonObject> value(const std::string &valueString);
+
+        Stats stats() const;
+        size_t capacity() const;
+        void clear();
+
+        // Approximate heap footprint of a tree, used for the memory cap
+        static size_t estimate_size(const std::shared_ptr<const JsonObject> &value);
+
+    private:
+        enum class Kind : uint8_t
+        {
+            Document,
+            Value
+        };
+
+        struct Entry
+        {
+            uint64_t key;
+            std::string input;
+            std::shared_ptr<const JsonObject> document;
+            size_t bytes;
+        };
+
+        size_t max_bytes;
+        mutable std::mutex mutex;
+        std::list<Entry> lru; // most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        Stats counters;
+
+        std::shared_ptr<const JsonObject> lookup(uint64_t key, const std::string &input);
+        void store(uint64_t key, const std::string &input, const std::shared_ptr<const JsonObject> &document);
+        static uint64_t make_key(Kind kind, const std::string &input);
+    };
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstddef>
+
+#include "JsonObject.hpp"
+
+namespace hh_json
+{
+    namespace detail
+    {
+        struct PersistentNode;
+    }
+
+    /**
+     * Immutable JSON document with structural sharing.
+     *
+     * with()/without() return a new version and leave this one untouched. Only the nodes on the
+     * path to the change are copied; every other subtree is shared between versions. Objects are
+     * hash array mapped tries (32-way, XXH64 of the key), so changing one member of a large object
+     * copies O(log32 n) small nodes instead of the whole map. Arrays copy their element pointers.
+     *
+     * Paths are JSON Pointers (RFC 6901). Copies of a PersistentDocument are cheap and, since no
+     * version is ever mutated, safe to read from several threads.
+     */
+    class PersistentDocument
+    {
+    public:
+        PersistentDocument(); // empty object
+        explicit PersistentDocument(const std::shared_ptr<JsonObject> &root);
+
+        // Sets the value at pointer (replacing a member or array element, "-" or size appends);
+        // every parent must already exist
+        PersistentDocument with(const std::string &pointer, const std::shared_ptr<JsonObject> &value) const;
+        PersistentDocument without(const std::string &pointer) const;
+
+        bool contains(const std::string &pointer) const;
+        JsonType type(const std::string &pointer = "") const;
+        size_t size(const std::string &pointer = "") const;
+
+        // Returns a fresh mutable copy of the value at pointer (nullptr for null); throws if missing
+        std::shared_ptr<JsonObject> get(const std::string &pointer) const;
+        std::shared_ptr<JsonObject> to_object() const;
+        std::string stringify() const;
+
+        // True when both documents hold the physically same subtree at pointer
+        bool same_subtree(const PersistentDocument &other, const std::string &pointer = "") const;
+
+    private:
+        explicit PersistentDocument(std::shared_ptr<const detail::PersistentNode> root);
+
+        std::shared_ptr<const detail::PersistentNode> root;
+    };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <regex>
+#include <limits>
+#include <utility>
+
+#include "JsonObject.hpp"
+
+namespace hh_json
+{
+    // Opcodes of the compiled schema program; each one constrains a single JSON type
+    enum class SchemaOp : uint8_t
+    {
+        Integer,          // number must have no fractional part
+        Minimum,          // number >= operand
+        Maximum,          // number <= operand
+        ExclusiveMinimum, // number > operand
+        ExclusiveMaximum, // number < operand
+        MinLength,        // string code points >= a
+        MaxLength,        // string code points <= a
+        MinItems,         // array size >= a
+        MaxItems,         // array size <= a
+        Pattern,          // string matches patterns[a]
+        Enum,             // value equals one of enums[a]
+        Required          // object has the stored keys of required[a, a + b)
+    };
+
+    struct SchemaInstruction
+    {
+        SchemaOp op;
+        uint32_t a = 0;
+        uint32_t b = 0;
+        double operand = 0.0;
+    };
+
+    /**
+     * A JSON Schema subset (type, required, properties, enum, minimum/maximum,
+     * exclusiveMinimum/exclusiveMaximum, minLength/maxLength, minItems/maxItems,
+     * pattern, items) compiled once into a flat instruction program.
+     *
+     * The validator can walk an already parsed tree with validate(), or be handed to
+     * parse(jsonString, validator) so every value is checked as soon as the parser
+     * builds it and the parse stops at the first violation.
+     */
+    class SchemaValidator
+    {
+    public:
+        // Node index meaning "no constraints" (absent or `true` schema)
+        static constexpr uint32_t unconstrained = std::numeric_limits<uint32_t>::max();
+
+        explicit SchemaValidator(const std::string &schemaJson);
+        explicit SchemaValidator(const std::shared_ptr<JsonObject> &schema);
+
+        // Walks the whole tree; on failure writes "<json pointer>: <reason>" to error
+        bool validate(const std::shared_ptr<JsonObject> &value, std::string *error = nullptr) const;
+
+        // Node-level interface used by the parser to validate while building the tree
+        uint32_t root() const;
+        uint32_t property_schema(uint32_t node, const std::string &key) const;
+        uint32_t items_schema(uint32_t node) const;
+        bool accepts_type(uint32_t node, JsonType type) const;
+        bool check(uint32_t node, const std::shared_ptr<JsonObject> &value, std::string *error = nullptr) const;
+
+        size_t program_size() const;
+
+    private:
+        struct Node
+        {
+            uint32_t type_mask;
+            uint32_t first = 0;
+            uint32_t count = 0;
+            uint32_t properties_begin = 0;
+            uint32_t properties_end = 0;
+            uint32_t items = unconstrained;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<SchemaInstruction> program;
+        std::vector<std::pair<std::string, uint32_t>> properties; // sorted by key within each node
+        std::vector<std::pair<std::string, std::string>> required; // (key as objects store it, name as written)
+        std::vector<std::vector<std::shared_ptr<JsonObject>>> enums;
+        std::vector<std::regex> patterns;
+        std::vector<std::string> pattern_sources;
+
+        uint32_t compile(const std::shared_ptr<JsonObject> &schema);
+        bool validate_node(uint32_t node, const std::shared_ptr<JsonObject> &value, std::string &path, std::string *error) const;
+    };
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+// Awaitable parsing and serialization for coroutine-based event loops. Needs C++20 coroutines;
+// in earlier language modes this header declares nothing.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "ChunkedSerializer.hpp"
+#include "JsonObject.hpp"
+#include "error.hpp"
+#include "parser.hpp"
+
+namespace hh_json::async
+{
+    // How much work is done between suspensions
+    struct Budget
+    {
+        size_t piece = 64 * 1024;              // bytes serialized per sink.write()
+        std::chrono::microseconds slice{1000}; // work before co_await x.yield(), if x has one
+    };
+
+    namespace detail
+    {
+        template <typename Promise>
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> done) noexcept
+            {
+                auto continuation = done.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+
+        struct PromiseBase
+        {
+            std::coroutine_handle<> continuation;
+            std::exception_ptr exception;
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            void unhandled_exception() { exception = std::current_exception(); }
+        };
+
+        template <typename T>
+        struct Promise : PromiseBase
+        {
+            std::optional<T> value;
+
+            void return_value(T result) { value = std::move(result); }
+        };
+
+        template <>
+        struct Promise<void> : PromiseBase
+        {
+            void return_void() {}
+        };
+
+        using Clock = std::chrono::steady_clock;
+    }
+
+    /**
+     * Lazily started coroutine producing T. Awaiting it from another coroutine starts it and
+     * resumes the awaiter when it finishes; at top level, start() it and read get() once done().
+     */
+    template <typename T>
+    class Task
+    {
+    public:
+        struct promise_type : detail::Promise<T>
+        {
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            detail::FinalAwaiter<promise_type> final_suspend() noexcept { return {}; }
+        };
+
+        Task(Task &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+        Task &operator=(Task &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle)
+                    handle.destroy();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+        ~Task()
+        {
+            if (handle)
+                handle.destroy();
+        }
+
+        void start() { handle.resume(); }
+        bool done() const { return handle.done(); }
+
+        // The result of a finished task; rethrows what the coroutine threw
+        T get()
+        {
+            if (handle.promise().exception)
+                std::rethrow_exception(handle.promise().exception);
+            if constexpr (!std::is_void_v<T>)
+                return std::move(*handle.promise().value);
+        }
+
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+        T await_resume() { return get(); }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    /**
+     * Parses the document read from source, suspending whenever the source does and, for a
+     * source that offers co_await source.yield(), after each budget.slice of parsing work.
+     *
+     * co_await source.read() must give the next chunk as something convertible to
+     * std::string_view, empty at the end of the input; the chunk must stay valid until the next
+     * read(). Chunks go through an IncrementalParser, so only an unfinished token is buffered.
+     */
+    template <typename Source>
+    Task<Result<std::shared_ptr<JsonObject>>> parse_async(Source &source, ParseOptions options = ParseOptions(), Budget budget = Budget())
+    {
+        using Status = IncrementalParser::Status;
+        IncrementalParser parser(options);
+        StepBudget step;
+        if constexpr (requires { source.yield(); })
+        {
+            step.time = budget.slice;
+        }
+        Status status = Status::NeedInput;
+        while (status == Status::NeedInput)
+        {
+            std::string_view chunk = co_await source.read();
+            if (chunk.empty())
+            {
+                parser.end_input();
+            }
+            else
+            {
+                parser.append(chunk);
+            }
+            status = parser.step(step);
+            // The slice ran out within the chunk; let the loop run, when it can, before going on
+            while (status == Status::NeedTime)
+            {
+                if constexpr (requires { source.yield(); })
+                {
+                    co_await source.yield();
+                }
+                status = parser.step(step);
+            }
+        }
+        co_return parser.result();
+    }
+
+    /**
+     * Serializes document to sink in pieces of about budget.piece bytes, with the same text
+     * stringify() gives. co_await sink.write(std::string_view) must be done with the data when
+     * it resumes. A sink that offers co_await sink.yield() also gets one after each budget.slice
+     * of serialization work.
+     */
+    template <typename Sink>
+    Task<void> serialize_async(std::shared_ptr<const JsonObject> document, Sink &sink, Budget budget = Budget())
+    {
+        ChunkedSerializer serializer(std::move(document));
+        std::string piece;
+        piece.reserve(budget.piece + 64);
+        auto slice_start = detail::Clock::now();
+        bool finished = false;
+        while (!finished)
+        {
+            piece.clear();
+            finished = serializer.write_some(piece, budget.piece);
+            co_await sink.write(std::string_view(piece));
+            if constexpr (requires { sink.yield(); })
+            {
+                if (!finished && detail::Clock::now() - slice_start >= budget.slice)
+                {
+                    co_await sink.yield();
+                    slice_start = detail::Clock::now();
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstddef>
+
+namespace hh_json
+{
+    class JsonObject;
+}
+
+// CBOR (RFC 8949) encoding of the hh_json tree.
+// Encoders append to a caller-owned buffer so repeated messages can reuse its capacity;
+// decoders read straight from the input bytes without an intermediate copy.
+namespace hh_json::cbor
+{
+    void encode(const std::shared_ptr<JsonObject> &value, std::string &out);
+    std::string encode(const std::shared_ptr<JsonObject> &value);
+
+    std::shared_ptr<JsonObject> decode(const char *data, size_t size);
+    std::shared_ptr<JsonObject> decode(const std::string &data);
+}
+
+// MessagePack encoding of the hh_json tree, same conventions as hh_json::cbor
+namespace hh_json::msgpack
+{
+    void encode(const std::shared_ptr<JsonObject> &value, std::string &out);
+    std::string encode(const std::shared_ptr<JsonObject> &value);
+
+    std::shared_ptr<JsonObject> decode(const char *data, size_t size);
+    std::shared_ptr<JsonObject> decode(const std::string &data);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "JsonObject.hpp"
+
+// Canonical JSON (RFC 8785, JCS): members sorted by their UTF-16 code units, numbers in the
+// shortest form that reads back to the same double (as ECMAScript prints them), strings with
+// only the mandatory escapes, no whitespace. Equal documents give identical text, unlike
+// stringify(), which follows the unordered_map's iteration order.
+namespace hh_json::canonical
+{
+    // Appends the canonical form of value (nullptr is null). Throws std::runtime_error for a
+    // NaN or infinite number, which JSON cannot represent.
+    void write(const std::shared_ptr<JsonObject> &value, std::string &out);
+    void write(const JsonObject &value, std::string &out);
+
+    std::string stringify(const std::shared_ptr<JsonObject> &value);
+    std::string stringify(const JsonObject &value);
+
+    // ECMAScript Number::toString of a finite double: 1e+21, 1e-7, 0.000001, 123, -0 as 0
+    void append_number(double number, std::string &out);
+
+    /**
+     * XXH64 of the canonical form, computed while walking the tree through a small buffer, so
+     * the text is never held whole. Equals hash::xxh64(stringify(value), seed) and is stable
+     * across runs and builds, which makes it usable as a dedup or cache key.
+     */
+    uint64_t hash(const std::shared_ptr<JsonObject> &value, uint64_t seed = 0);
+    uint64_t hash(const JsonObject &value, uint64_t seed = 0);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "JsonObject.hpp"
+#include "error.hpp"
+#include "parser.hpp"
+
+// Parsing straight from compressed archives (.json.gz, .jsonl.zst) without inflating them into
+// one string first. A reader thread decompresses fixed-size blocks while the calling thread
+// parses the blocks already done, so memory stays bounded by a few blocks plus the result.
+// gzip/zlib needs the library built with zlib (HH_JSON_ZLIB), zstd with libzstd (HH_JSON_ZSTD).
+namespace hh_json::compression
+{
+    enum class Format
+    {
+        Plain,
+        Gzip, // gzip or zlib framing; concatenated gzip members are read in turn
+        Zstd, // one or more zstd frames
+        Auto  // chosen from the magic bytes at the start of the input
+    };
+
+    // Whether this build can decompress format; Plain and Auto always can
+    bool available(Format format);
+
+    // Format of a stream starting with head (a few bytes suffice); Plain when unrecognized
+    Format detect(std::string_view head);
+
+    /**
+     * Streaming decompressor: compressed bytes in, decompressed bytes appended to a string.
+     * A Plain decompressor copies its input.
+     */
+    class Decompressor
+    {
+    public:
+        // Throws std::runtime_error for Auto or for a format this build does not support
+        explicit Decompressor(Format format);
+        ~Decompressor();
+        Decompressor(Decompressor &&) noexcept;
+        Decompressor &operator=(Decompressor &&) noexcept;
+
+        // Decompresses all of input onto out; false once the data is found to be corrupt
+        bool write(std::string_view input, std::string &out);
+
+        // True at a frame or member boundary, i.e. when the input may end here
+        bool at_boundary() const;
+
+        // Why write() failed; empty otherwise
+        const std::string &error() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> state;
+    };
+
+    // How the input is read and handed from the reader thread to the parser
+    struct PipelineOptions
+    {
+        Format format = Format::Auto;
+        size_t block_size = 64 * 1024; // compressed bytes read at a time
+        size_t queue_depth = 4;        // decompressed blocks waiting for the parser
+        bool threaded = true;          // false: read and decompress on the calling thread
+    };
+
+    /**
+     * Parses the one document in a (possibly compressed) stream, like IncrementalParser fed
+     * block by block. Decompression errors are reported as ParseErrc::DecompressionFailed with
+     * the compressed offset; parse errors carry offsets into the decompressed text. Reading
+     * stops as soon as the document is complete.
+     */
+    Result<std::shared_ptr<JsonObject>> parse(std::istream &in, const ParseOptions &options = ParseOptions(),
+                                              const PipelineOptions &pipeline = PipelineOptions());
+
+    // Receives each NDJSON record with its 1-based line number; return false to stop reading
+    using RecordHandler = std::function<bool(size_t line, Result<std::shared_ptr<JsonObject>> record)>;
+
+    /**
+     * Reads newline-delimited JSON from a (possibly compressed) stream, parsing each non-blank
+     * line with one reused Parser and handing the records to on_record in order. A malformed
+     * line is passed on as its error and reading continues. Returns the number of records, or
+     * the error that ended the stream early (decompression or a stream read failure).
+     */
+    Result<size_t> read_ndjson(std::istream &in, const RecordHandler &on_record, const ParseOptions &options = ParseOptions(),
+                               const PipelineOptions &pipeline = PipelineOptions());
+}
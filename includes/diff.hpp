@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "JsonObject.hpp"
+#include "JsonArray.hpp"
+#include "snapshot.hpp"
+
+namespace hh_json::patch
+{
+    /**
+     * Order-independent structural hashes of subtrees, memoized per node.
+     *
+     * Equal subtrees hash equally no matter how their unordered_map members iterate, so the
+     * diff can tell most differing subtrees apart without walking them; equal hashes are still
+     * confirmed with equals(). Keep one instance around to reuse the hashes of an unchanged
+     * base document across several diffs; call clear() after mutating a hashed tree. Entries
+     * hold weak references, so a freed node's hash is never reused for a new node at the same
+     * address, and clear() releases the memory they keep.
+     */
+    class SubtreeHasher
+    {
+    public:
+        uint64_t hash(const std::shared_ptr<JsonObject> &value);
+        void clear();
+        size_t cached() const;
+
+    private:
+        struct Cached
+        {
+            std::weak_ptr<const JsonObject> node;
+            uint64_t hash;
+        };
+        std::unordered_map<const JsonObject *, Cached> cache;
+    };
+
+    // Minimal JSON Patch (RFC 6902) turning `from` into `to`: per-key changes for objects,
+    // LCS-aligned add/remove for arrays, replace for everything else. Values in the patch
+    // share nodes with `to`.
+    std::shared_ptr<JsonArray> diff(const std::shared_ptr<JsonObject> &from, const std::shared_ptr<JsonObject> &to);
+    std::shared_ptr<JsonArray> diff(const std::shared_ptr<JsonObject> &from, const std::shared_ptr<JsonObject> &to,
+                                    SubtreeHasher &hasher);
+
+    // Snapshot images are diffed through their materialized trees
+    std::shared_ptr<JsonArray> diff(const snapshot::View &from, const snapshot::View &to);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Builds with exceptions disabled (-fno-exceptions) turn every throw into a call to
+// detail::fail, which reports the message and aborts. The try_* parse functions never
+// throw, so callers that must not abort check their results instead.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define HH_JSON_EXCEPTIONS 1
+#define HH_JSON_THROW(exception) throw exception
+#define HH_JSON_TRY try
+#define HH_JSON_CATCH_ALL catch (...)
+#define HH_JSON_RETHROW throw
+#else
+#define HH_JSON_EXCEPTIONS 0
+#define HH_JSON_THROW(exception) ::hh_json::detail::fail((exception).what())
+#define HH_JSON_TRY if (true)
+#define HH_JSON_CATCH_ALL if (false)
+#define HH_JSON_RETHROW ::hh_json::detail::fail("rethrow without exception support")
+#endif
+
+namespace hh_json
+{
+    namespace detail
+    {
+        [[noreturn]] void fail(const char *message);
+    }
+
+    enum class ParseErrc : uint8_t
+    {
+        None,
+        UnexpectedEnd,
+        UnexpectedCharacter,
+        UnterminatedString,
+        InvalidNumber,
+        InvalidLiteral,
+        ExpectedKey,
+        ExpectedColon,
+        ExpectedCommaOrBracket,
+        ExpectedCommaOrBrace,
+        UnterminatedArray,
+        UnterminatedObject,
+        RootNotObject,
+        SchemaViolation,
+        DepthLimitExceeded,
+        DocumentTooLarge,
+        StringTooLong,
+        TooManyElements,
+        InvalidEscape,
+        InvalidUtf8,
+        ControlCharacter,
+        Cancelled,
+        DecompressionFailed,
+        ReadFailed
+    };
+
+    // Short description of an error code, without position
+    const char *describe(ParseErrc code);
+
+    // Error code plus the offset it was detected at. The message is only formatted on request.
+    struct ParseError
+    {
+        ParseErrc code = ParseErrc::None;
+        size_t offset = 0; // byte offset into the caller's input (whitespace and comments count)
+        std::string detail; // schema violation or decompression reason; empty otherwise
+
+        explicit operator bool() const { return code != ParseErrc::None; }
+        std::string message() const;
+    };
+
+    // Either a value or a ParseError, in the spirit of std::expected
+    template <typename T>
+    class Result
+    {
+    public:
+        Result(T value) : stored(std::move(value)) {}
+        Result(ParseError error) : failure(std::move(error)) {}
+
+        bool has_value() const { return !failure; }
+        explicit operator bool() const { return has_value(); }
+
+        const ParseError &error() const { return failure; }
+
+        // Throws std::runtime_error with the formatted message when there is no value
+        T &value() &
+        {
+            check();
+            return stored;
+        }
+        const T &value() const &
+        {
+            check();
+            return stored;
+        }
+        T &&value() &&
+        {
+            check();
+            return std::move(stored);
+        }
+
+        T &operator*() & { return stored; }
+        const T &operator*() const & { return stored; }
+        T &&operator*() && { return std::move(stored); }
+        T *operator->() { return &stored; }
+        const T *operator->() const { return &stored; }
+
+    private:
+        T stored{};
+        ParseError failure;
+
+        void check() const
+        {
+            if (failure)
+            {
+                HH_JSON_THROW(std::runtime_error(failure.message()));
+            }
+        }
+    };
+}
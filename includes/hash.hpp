@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace hh_json::hash
+{
+    // XXH64: fast non-cryptographic 64-bit hash, for cache keys and change detection
+    uint64_t xxh64(const void *data, size_t size, uint64_t seed = 0);
+
+    inline uint64_t xxh64(std::string_view data, uint64_t seed = 0)
+    {
+        return xxh64(data.data(), data.size(), seed);
+    }
+
+    // Incremental XXH64; feeding the same bytes in any chunking yields xxh64() of their concatenation
+    class Xxh64
+    {
+    public:
+        explicit Xxh64(uint64_t seed = 0);
+
+        void update(const void *data, size_t size);
+        void update(std::string_view data)
+        {
+            update(data.data(), data.size());
+        }
+        uint64_t digest() const;
+
+    private:
+        uint64_t seed;
+        uint64_t acc[4];
+        unsigned char buffer[32];
+        size_t buffered = 0;
+        uint64_t total = 0;
+    };
+}
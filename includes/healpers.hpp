@@ -2,6 +2,9 @@
 
 #include <string>
 #include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "JsonObject.hpp"
@@ -12,9 +15,9 @@
 
 namespace hh_json::maker
 {
-    inline std::shared_ptr<hh_json::JsonObject> make_string(const std::string &value)
+    inline std::shared_ptr<hh_json::JsonObject> make_string(std::string value)
     {
-        return std::make_shared<hh_json::JsonString>(value);
+        return std::make_shared<hh_json::JsonString>(std::move(value));
     }
 
     inline std::shared_ptr<hh_json::JsonObject> make_number(double value)
@@ -27,43 +30,154 @@ namespace hh_json::maker
         return std::make_shared<hh_json::JsonBoolean>(value);
     }
 
+    inline std::shared_ptr<hh_json::JsonObject> make_array(std::vector<std::shared_ptr<hh_json::JsonObject>> elements = {})
+    {
+        return std::make_shared<hh_json::JsonArray>(std::move(elements));
+    }
+
+    inline std::shared_ptr<hh_json::JsonObject> make_object(std::unordered_map<std::string, std::shared_ptr<hh_json::JsonObject>> members = {})
+    {
+        return std::make_shared<hh_json::JsonObject>(std::move(members));
+    }
+
 }
 
 namespace hh_json::getter
 {
+    inline JsonType get_type(const std::shared_ptr<hh_json::JsonObject> &obj)
+    {
+        return obj ? obj->type() : JsonType::Null;
+    }
+
     inline bool get_boolean(const std::shared_ptr<hh_json::JsonObject> &obj)
     {
-        if (auto boolean = std::dynamic_pointer_cast<hh_json::JsonBoolean>(obj))
+        if (get_type(obj) == JsonType::Boolean)
         {
-            return boolean->value;
+            return static_cast<const hh_json::JsonBoolean &>(*obj).value;
         }
-        throw std::runtime_error("Not a boolean");
+        HH_JSON_THROW(std::runtime_error("Not a boolean"));
     }
 
     inline double get_number(const std::shared_ptr<hh_json::JsonObject> &obj)
     {
-        if (auto number = std::dynamic_pointer_cast<hh_json::JsonNumber>(obj))
+        if (get_type(obj) == JsonType::Number)
+        {
+            return static_cast<const hh_json::JsonNumber &>(*obj).number();
+        }
+        HH_JSON_THROW(std::runtime_error("Not a number"));
+    }
+
+    // Reference into the node; valid while the node is alive and unmodified
+    inline const std::string &get_string_ref(const std::shared_ptr<hh_json::JsonObject> &obj)
+    {
+        if (get_type(obj) == JsonType::String)
         {
-            return number->value;
+            return static_cast<const hh_json::JsonString &>(*obj).str();
         }
-        throw std::runtime_error("Not a number");
+        HH_JSON_THROW(std::runtime_error("Not a string"));
+    }
+
+    inline std::string_view get_string_view(const std::shared_ptr<hh_json::JsonObject> &obj)
+    {
+        if (get_type(obj) == JsonType::String)
+        {
+            return static_cast<const hh_json::JsonString &>(*obj).view();
+        }
+        HH_JSON_THROW(std::runtime_error("Not a string"));
     }
 
     inline std::string get_string(const std::shared_ptr<hh_json::JsonObject> &obj)
     {
-        if (auto str = std::dynamic_pointer_cast<hh_json::JsonString>(obj))
+        return std::string(get_string_view(obj));
+    }
+
+    // Reference to the elements; valid while the array is alive and unmodified
+    inline const std::vector<std::shared_ptr<hh_json::JsonObject>> &get_array_ref(const std::shared_ptr<hh_json::JsonObject> &obj)
+    {
+        if (get_type(obj) == JsonType::Array)
         {
-            return str->value;
+            return static_cast<const hh_json::JsonArray &>(*obj).elements;
         }
-        throw std::runtime_error("Not a string");
+        HH_JSON_THROW(std::runtime_error("Not an array"));
     }
 
     inline std::vector<std::shared_ptr<hh_json::JsonObject>> get_array(const std::shared_ptr<hh_json::JsonObject> &obj)
     {
-        if (auto array = std::dynamic_pointer_cast<hh_json::JsonArray>(obj))
+        return get_array_ref(obj);
+    }
+
+    inline const std::unordered_map<std::string, std::shared_ptr<hh_json::JsonObject>> &get_object(const std::shared_ptr<hh_json::JsonObject> &obj)
+    {
+        if (get_type(obj) == JsonType::Object)
         {
-            return array->elements;
+            return obj->get_data();
         }
-        throw std::runtime_error("Not an array");
+        HH_JSON_THROW(std::runtime_error("Not an object"));
     }
-}
\ No newline at end of file
+}
+
+namespace hh_json
+{
+    // Structural equality: objects compare key sets regardless of order, arrays element-wise
+    inline bool equals(const std::shared_ptr<JsonObject> &lhs, const std::shared_ptr<JsonObject> &rhs)
+    {
+        if (lhs == rhs)
+        {
+            return true;
+        }
+
+        auto type = getter::get_type(lhs);
+        if (type != getter::get_type(rhs))
+        {
+            return false;
+        }
+
+        switch (type)
+        {
+        case JsonType::Null:
+            return true;
+        case JsonType::Boolean:
+            return static_cast<const JsonBoolean &>(*lhs).value == static_cast<const JsonBoolean &>(*rhs).value;
+        case JsonType::Number:
+            return static_cast<const JsonNumber &>(*lhs).number() == static_cast<const JsonNumber &>(*rhs).number();
+        case JsonType::String:
+            return static_cast<const JsonString &>(*lhs).view() == static_cast<const JsonString &>(*rhs).view();
+        case JsonType::Array:
+        {
+            const auto &a = static_cast<const JsonArray &>(*lhs).elements;
+            const auto &b = static_cast<const JsonArray &>(*rhs).elements;
+            if (a.size() != b.size())
+            {
+                return false;
+            }
+            for (size_t i = 0; i < a.size(); ++i)
+            {
+                if (!equals(a[i], b[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case JsonType::Object:
+        {
+            const auto &a = lhs->get_data();
+            const auto &b = rhs->get_data();
+            if (a.size() != b.size())
+            {
+                return false;
+            }
+            for (const auto &[key, value] : a)
+            {
+                auto it = b.find(key);
+                if (it == b.end() || !equals(value, it->second))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "FrozenDocument.hpp"
+#include "JsonObject.hpp"
+
+// Batch export of many documents as newline-delimited JSON. Worker threads serialize runs of
+// documents into reused buffers with stringify_to; the calling thread hands finished buffers
+// to the sink several at a time, so output goes out in large writes without one string being
+// concatenated from all documents.
+namespace hh_json::ndjson
+{
+    // Destination of write(); receives whole lines only
+    class Sink
+    {
+    public:
+        virtual ~Sink() = default;
+        // Writes the pieces in order; false on an error, which ends write()
+        virtual bool write(const std::string_view *pieces, size_t count) = 0;
+    };
+
+    // Appends to a string
+    class StringSink : public Sink
+    {
+    public:
+        explicit StringSink(std::string &out) : out(out) {}
+        bool write(const std::string_view *pieces, size_t count) override;
+
+    private:
+        std::string &out;
+    };
+
+    class StreamSink : public Sink
+    {
+    public:
+        explicit StreamSink(std::ostream &out) : out(out) {}
+        bool write(const std::string_view *pieces, size_t count) override;
+
+    private:
+        std::ostream &out;
+    };
+
+#if defined(__unix__) || defined(__APPLE__)
+    // Writes to a file descriptor with writev, retrying partial writes; the descriptor stays open
+    class FdSink : public Sink
+    {
+    public:
+        explicit FdSink(int fd) : fd(fd) {}
+        bool write(const std::string_view *pieces, size_t count) override;
+
+    private:
+        int fd;
+    };
+#endif
+
+    struct WriteOptions
+    {
+        size_t threads = 0;         // serializing threads; 0 for one per hardware thread
+        size_t batch = 256;         // documents serialized per task
+        bool ordered = true;        // false: batches may be written in any order
+        size_t write_size = 1 << 20; // buffered bytes handed to the sink at once, at least
+    };
+
+    namespace detail
+    {
+        inline void append_line(const JsonObject &document, std::string &out)
+        {
+            document.stringify_to(out);
+        }
+
+        template <typename T>
+        void append_line(const std::shared_ptr<T> &document, std::string &out)
+        {
+            if (document)
+                document->stringify_to(out);
+            else
+                out += "null";
+        }
+
+        inline void append_line(const FrozenDocument &document, std::string &out)
+        {
+            document.root().stringify_to(out);
+        }
+
+        // Appends line index of the input, without its newline
+        using Serializer = std::function<void(size_t index, std::string &out)>;
+
+        size_t write(size_t count, const Serializer &serialize, Sink &sink, const WriteOptions &options);
+    }
+
+    /**
+     * Writes each document of a random-access range (vector, array, ...) of JsonObject,
+     * shared_ptr to one, or FrozenDocument as one line to sink. Null pointers become null.
+     * Returns the number of documents written, which is short of the range's size only if the
+     * sink failed. The documents must not change until write() returns.
+     */
+    template <typename Range>
+    size_t write(const Range &documents, Sink &sink, const WriteOptions &options = WriteOptions())
+    {
+        auto first = std::begin(documents);
+        auto count = static_cast<size_t>(std::distance(first, std::end(documents)));
+        return detail::write(
+            count, [first](size_t index, std::string &out)
+            { detail::append_line(first[static_cast<std::ptrdiff_t>(index)], out); },
+            sink, options);
+    }
+}
@@ -1,17 +1,185 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <memory>
+#include <cstddef>
+#include <limits>
+
+#include "error.hpp"
 
 namespace hh_json
 {
     class JsonObject;
+    class SchemaValidator;
+
+    namespace stats
+    {
+        struct Stats;
+    }
+
+    // Limits enforced while parsing, so hostile input fails in bounded time and memory.
+    // Exceeding one is reported like any other parse error.
+    struct ParseOptions
+    {
+        size_t max_depth = 1024;                                     // nested arrays/objects
+        size_t max_size = std::numeric_limits<size_t>::max();        // input bytes
+        size_t max_string_length = std::numeric_limits<size_t>::max(); // encoded length of one string or key
+        size_t max_elements = std::numeric_limits<size_t>::max();    // total values in the document
+
+        // String values keep a slice of a shared copy of the input and are decoded on first
+        // access (JsonString::view/str); untouched strings stringify by copying the slice.
+        // Object keys are always decoded eagerly.
+        bool lazy_strings = false;
 
+        // Number values keep their validated text and convert on first access
+        // (JsonNumber::number/to_int64); untouched numbers stringify as the original text.
+        // Text that might over- or underflow is still converted, and rejected, while parsing.
+        bool lazy_numbers = false;
+
+        // Receives the counters and phase timers of the parse (see stats.hpp); left zeroed
+        // unless the library is built with HH_JSON_STATS
+        stats::Stats *stats = nullptr;
+    };
+
+    // Parses a single value; returns nullptr on malformed input (indistinguishable from "null", see try_parse_value)
     std::shared_ptr<JsonObject> JsonValue(const std::string &valueString);
 
     // Main parsing function to parse a JSON string into a map of JSON objects
     std::unordered_map<std::string, std::shared_ptr<JsonObject>>
     parse(const std::string &jsonString);
+
+    std::unordered_map<std::string, std::shared_ptr<JsonObject>>
+    parse(const std::string &jsonString, const ParseOptions &options);
+
+    // Same as parse, validating every value against the compiled schema while it is parsed;
+    // throws std::runtime_error at the first violation
+    std::unordered_map<std::string, std::shared_ptr<JsonObject>>
+    parse(const std::string &jsonString, const SchemaValidator &validator);
+
+    // Non-throwing variants: malformed input yields a ParseError (code + offset) instead of an exception.
+    // The offset is a byte offset into jsonString as given, whitespace and comments included.
+    Result<std::unordered_map<std::string, std::shared_ptr<JsonObject>>>
+    try_parse(const std::string &jsonString);
+
+    Result<std::unordered_map<std::string, std::shared_ptr<JsonObject>>>
+    try_parse(const std::string &jsonString, const SchemaValidator &validator);
+
+    Result<std::unordered_map<std::string, std::shared_ptr<JsonObject>>>
+    try_parse(const std::string &jsonString, const ParseOptions &options);
+
+    Result<std::shared_ptr<JsonObject>> try_parse_value(const std::string &valueString);
+    Result<std::shared_ptr<JsonObject>> try_parse_value(const std::string &valueString, const ParseOptions &options);
+
+    /**
+     * Parser that keeps its working memory between documents, for a thread that parses many of
+     * them in a row.
+     *
+     * The preprocessing buffers, the container stack and the key buffer keep their capacity.
+     * Each parse first takes back the nodes of the previous result that the caller has let go
+     * of: objects with their member entries and buckets, arrays with their element storage and
+     * strings with their text buffers are emptied into pools, and the parse builds from those.
+     * Once warm, parsing documents of a similar shape allocates nothing as long as each result
+     * is released before the next parse. With lazy_strings or lazy_numbers set, each parse
+     * still allocates its shared copy of the input.
+     *
+     * Results are ordinary trees and may be kept for as long as needed; a Parser only reuses the
+     * nodes nobody else references. A Parser is not thread-safe: use one per thread.
+     */
+    class Parser
+    {
+    public:
+        explicit Parser(ParseOptions options = ParseOptions());
+        ~Parser();
+        Parser(Parser &&) noexcept;
+        Parser &operator=(Parser &&) noexcept;
+
+        // Same input and errors as try_parse, but returns the root object itself.
+        // Both parse functions start with reset().
+        Result<std::shared_ptr<JsonObject>> parse(const std::string &jsonString);
+        // Same as try_parse_value
+        Result<std::shared_ptr<JsonObject>> parse_value(const std::string &valueString);
+
+        // Takes back the nodes of the last result that the caller no longer references
+        void reset();
+
+        // Frees all retained buffers and pooled nodes
+        void release();
+
+        const ParseOptions &options() const;
+        void set_options(const ParseOptions &options);
+
+    private:
+        struct State;
+        std::unique_ptr<State> state;
+    };
+
+    // Work one IncrementalParser::step() may do. It is checked between values, so a step can
+    // run past it by one token, and every step parses at least one value.
+    struct StepBudget
+    {
+        size_t bytes = std::numeric_limits<size_t>::max();
+        std::chrono::microseconds time = std::chrono::microseconds::max();
+        // Polled along with the clock; once set, the parse fails with ParseErrc::Cancelled
+        const std::atomic<bool> *cancel = nullptr;
+    };
+
+    /**
+     * Parser for a document that arrives in pieces, e.g. a request body read from a socket.
+     *
+     * feed() parses as far as the input allows and keeps only the bytes of a token cut off at
+     * the end of the chunk, so a large body is never held whole. The result is the tree parse()
+     * builds, rooted at an object. Unlike parse(), the input must be plain JSON: // comments are
+     * not stripped. lazy_strings and lazy_numbers do not apply.
+     *
+     * To keep a latency-sensitive thread responsive, append() input and end_input() instead,
+     * then call step() with a budget until it stops returning NeedTime.
+     */
+    class IncrementalParser
+    {
+    public:
+        enum class Status
+        {
+            NeedInput,
+            NeedTime, // the step's budget ran out with input left to parse
+            Done,
+            Failed
+        };
+
+        explicit IncrementalParser(ParseOptions options = ParseOptions());
+        ~IncrementalParser();
+        IncrementalParser(IncrementalParser &&) noexcept;
+        IncrementalParser &operator=(IncrementalParser &&) noexcept;
+
+        // Parses what chunk completes. Input after the end of the document is ignored.
+        Status feed(std::string_view chunk);
+        // Marks the end of the input; an unfinished document fails
+        Status finish();
+
+        // Buffer input, or mark its end, without parsing; step() does the work
+        Status append(std::string_view chunk);
+        void end_input();
+        // Parses buffered input until it runs out or budget does
+        Status step(const StepBudget &budget);
+
+        Status status() const;
+
+        // The root object once Done, the error once Failed
+        Result<std::shared_ptr<JsonObject>> result() const;
+
+        size_t consumed() const; // input bytes parsed so far
+        size_t buffered() const; // bytes held for an unfinished token
+
+        // Starts over for the next document, reusing the nodes of the last result once the
+        // caller has released them
+        void reset();
+
+    private:
+        struct State;
+        std::unique_ptr<State> state;
+    };
 }
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <memory>
+
+namespace hh_json
+{
+    class JsonObject;
+}
+
+// In-place JSON Patch (RFC 6902) and JSON Merge Patch (RFC 7396) on the hh_json tree.
+// Paths are resolved with get/insert/erase along the pointer, so applying a patch costs
+// O(patch size x depth) regardless of the document size.
+namespace hh_json::patch
+{
+    // Applies an array of add/remove/replace/move/copy/test operations. The document variable
+    // is reassigned when an operation targets the root. If any operation fails (including a
+    // failed test) the operations already applied are rolled back and std::runtime_error is thrown.
+    void apply(std::shared_ptr<JsonObject> &document, const std::shared_ptr<JsonObject> &operations);
+    void apply(std::shared_ptr<JsonObject> &document, const std::string &patchJson);
+
+    // RFC 7396: objects are merged recursively, null members delete keys, anything else replaces
+    void merge(std::shared_ptr<JsonObject> &document, const std::shared_ptr<JsonObject> &mergePatch);
+    void merge(std::shared_ptr<JsonObject> &document, const std::string &mergePatchJson);
+
+    // Deep copy of a value, used so patched documents never share nodes with the patch
+    std::shared_ptr<JsonObject> clone(const std::shared_ptr<JsonObject> &value);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// JSON Pointer (RFC 6901) helpers shared by the path-based APIs
+namespace hh_json::pointer
+{
+    // Splits "/a/b~1c/0" into {"a", "b/c", "0"}; "" is the whole document. Throws on malformed pointers.
+    std::vector<std::string> parse(const std::string &pointer);
+
+    // Inverse of parse for a single reference token ("~" -> "~0", "/" -> "~1")
+    std::string escape(const std::string &token);
+
+    void append(std::string &pointer, const std::string &token);
+
+    // Array index token: digits without leading zeros. "-" (past the end) is reported as `size`.
+    // Throws if the token is not a valid index or is greater than size.
+    size_t array_index(const std::string &token, size_t size);
+
+    // Non-throwing forms of parse and array_index; return false where those would throw
+    bool try_parse(const std::string &pointer, std::vector<std::string> &tokens);
+    bool try_array_index(const std::string &token, size_t size, size_t &index);
+}
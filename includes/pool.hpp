@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "JsonObject.hpp"
+#include "parser.hpp"
+
+// Thread-local pools of parsers and scratch documents for server workloads. An item goes back
+// to the free list of the thread that releases it, so a thread-per-core server keeps each
+// core's working memory hot and never hands memory between threads on the fast path. When a
+// thread's list is full, or the thread exits, items move to a shared overflow list that other
+// threads draw from before allocating. Both lists are bounded.
+namespace hh_json::pool
+{
+    // Idle items kept of each kind: per thread, and in the shared overflow
+    struct Limits
+    {
+        size_t per_thread = 4;
+        size_t global = 64;
+    };
+
+    namespace detail
+    {
+        void give_back(std::unique_ptr<Parser> parser);
+        void give_back(std::unique_ptr<JsonObject> document);
+    }
+
+    // Pooled item for the current scope; returned to the pool when destroyed
+    template <typename T>
+    class Lease
+    {
+    public:
+        explicit Lease(std::unique_ptr<T> item) : item(std::move(item)) {}
+        Lease(Lease &&) noexcept = default;
+        Lease &operator=(Lease &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                item = std::move(other.item);
+            }
+            return *this;
+        }
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        ~Lease() { reset(); }
+
+        T &operator*() const { return *item; }
+        T *operator->() const { return item.get(); }
+        T *get() const { return item.get(); }
+
+        // Returns the item now; the lease is empty afterwards
+        void reset()
+        {
+            if (item)
+            {
+                detail::give_back(std::move(item));
+            }
+        }
+
+    private:
+        std::unique_ptr<T> item;
+    };
+
+    // Parser set to options; it still holds the buffers and node pools of its earlier uses
+    Lease<Parser> acquire(const ParseOptions &options = ParseOptions());
+
+    // Empty object to build a document in; its bucket array is kept between uses
+    Lease<JsonObject> acquire_document();
+
+    void set_limits(const Limits &limits);
+    Limits limits();
+
+    // Idle items in the calling thread's lists and in the shared overflow
+    struct Usage
+    {
+        size_t local_parsers = 0;
+        size_t local_documents = 0;
+        size_t global_parsers = 0;
+        size_t global_documents = 0;
+    };
+    Usage usage();
+
+    // Frees the idle items of the calling thread and of the shared overflow
+    void trim();
+}
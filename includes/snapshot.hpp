@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+#include "JsonObject.hpp"
+
+/**
+ * Relocatable, read-only binary image of a parsed document.
+ *
+ * Layout (native little-endian, every offset relative to the image start):
+ *   header | entries (16-byte value records) | members (32-byte key/value records) | string area
+ * Arrays point at a contiguous block of entries, objects at a contiguous block of members,
+ * sorted by key when the key index is enabled so lookups are a binary search. Keys are stored
+ * as their text (not the escaped form JsonObject keeps), so get() and key_at() use plain keys.
+ * write() throws std::runtime_error for a string, key, array or object of 2^32 or more.
+ *
+ * Because nothing in the image is a pointer, a file written with write_file() can be mapped
+ * with Image::open() and queried immediately, and the mapping is shared read-only between
+ * every process that opens the same file.
+ */
+namespace hh_json::snapshot
+{
+    struct Entry
+    {
+        uint32_t type;    // JsonType
+        uint32_t count;   // string length, array size or object member count
+        uint64_t payload; // boolean, double bits, string offset, entry index or member index
+    };
+
+    struct Member
+    {
+        uint64_t key_offset;
+        uint32_t key_length;
+        uint32_t reserved;
+        Entry value;
+    };
+
+    void write(const std::shared_ptr<JsonObject> &root, std::string &out, bool index_keys = true);
+    std::string write(const std::shared_ptr<JsonObject> &root, bool index_keys = true);
+    void write_file(const std::shared_ptr<JsonObject> &root, const std::string &path, bool index_keys = true);
+
+    class Image;
+
+    // Non-owning cursor into an Image; the Image must outlive every View taken from it
+    class View
+    {
+    public:
+        View() = default;
+
+        // False for the result of looking up a missing key or index (JSON null is a valid view)
+        explicit operator bool() const;
+
+        JsonType type() const;
+        size_t size() const;
+
+        View get(std::string_view key) const;
+        bool has_key(std::string_view key) const;
+        View at(size_t index) const;
+        std::string_view key_at(size_t index) const;
+
+        bool get_boolean() const;
+        double get_number() const;
+        std::string_view get_string() const;
+
+        std::string stringify() const;
+        std::shared_ptr<JsonObject> materialize() const;
+
+    private:
+        friend class Image;
+        View(const Image *image, const Entry *entry) : image(image), entry(entry) {}
+
+        const Image *image = nullptr;
+        const Entry *entry = nullptr;
+
+        void stringify_to(std::string &out) const;
+    };
+
+    class Image
+    {
+    public:
+        // Maps the file read-only (copies it into memory where mmap is unavailable)
+        static std::shared_ptr<const Image> open(const std::string &path);
+        static std::shared_ptr<const Image> from_buffer(std::string bytes);
+
+        ~Image();
+        Image(const Image &) = delete;
+        Image &operator=(const Image &) = delete;
+
+        View root() const;
+        size_t size() const;
+        bool mapped() const;
+
+    private:
+        friend class View;
+        Image() = default;
+
+        const unsigned char *base = nullptr;
+        size_t length = 0;
+        bool is_mapped = false;
+        bool sorted_keys = false;
+        std::vector<uint64_t> storage; // 8-byte aligned backing store when not mapped
+
+        const Entry *entries = nullptr;
+        uint64_t entry_count = 0;
+        const Member *members = nullptr;
+        uint64_t member_count = 0;
+        const char *strings = nullptr;
+        uint64_t strings_size = 0;
+        Entry root_entry{};
+
+        void load();
+        std::string_view string_at(uint64_t offset, uint64_t length) const;
+    };
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Optional instrumentation of parsing and serialization. It is compiled in only when
+// HH_JSON_STATS is defined to 1 (CMake option JSON_PARSER_STATS); otherwise every probe
+// expands to nothing and ParseOptions::stats only ever receives zeros.
+#ifndef HH_JSON_STATS
+#define HH_JSON_STATS 0
+#endif
+
+#if HH_JSON_STATS
+#define HH_JSON_STATS_ONLY(...) __VA_ARGS__
+#else
+#define HH_JSON_STATS_ONLY(...)
+#endif
+
+namespace hh_json::stats
+{
+    constexpr bool enabled = HH_JSON_STATS != 0;
+
+    enum class Operation : uint8_t
+    {
+        Parse,
+        Serialize
+    };
+
+    // Counters for one parse, or for one top-level stringify (serialize_ns and output_bytes only)
+    struct Stats
+    {
+        Operation operation = Operation::Parse;
+
+        // Phase timers, in nanoseconds. Scanning and tree building happen in the same pass:
+        // scan_ns is the time spent reading string, number and literal tokens (number_ns of
+        // it converting numbers) and build_ns the remainder of the pass.
+        uint64_t preprocess_ns = 0;
+        uint64_t scan_ns = 0;
+        uint64_t number_ns = 0;
+        uint64_t build_ns = 0;
+        uint64_t serialize_ns = 0;
+
+        // Nodes created, by type
+        uint64_t objects = 0;
+        uint64_t arrays = 0;
+        uint64_t strings = 0;
+        uint64_t numbers = 0;
+        uint64_t booleans = 0;
+        uint64_t nulls = 0;
+
+        uint64_t input_bytes = 0;  // after preprocessing
+        uint64_t output_bytes = 0; // stringify result
+        uint64_t bytes_copied = 0; // decoded string and key bytes
+        uint64_t allocations = 0;  // nodes plus string buffers beyond the small-string capacity
+        uint64_t escapes = 0;      // backslash escapes in strings and keys
+        uint64_t max_depth = 0;    // deepest container nesting
+    };
+
+    // Called on the thread that finished the operation, after every parse and every top-level
+    // stringify of any node. Pass an empty function to remove it.
+    using Hook = std::function<void(const Stats &)>;
+    void set_hook(Hook hook);
+
+    namespace detail
+    {
+        void report(const Stats &stats);
+
+        inline uint64_t now_ns()
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now().time_since_epoch())
+                                             .count());
+        }
+
+        // Adds the lifetime of the scope to a timer
+        class Timer
+        {
+        public:
+            explicit Timer(uint64_t &total) : total(total), start(now_ns()) {}
+            ~Timer() { total += now_ns() - start; }
+            Timer(const Timer &) = delete;
+            Timer &operator=(const Timer &) = delete;
+
+        private:
+            uint64_t &total;
+            uint64_t start;
+        };
+
+        // Times the outermost stringify on this thread; nested container calls only pass through
+        class SerializeScope
+        {
+        public:
+            SerializeScope();
+            ~SerializeScope();
+            SerializeScope(const SerializeScope &) = delete;
+            SerializeScope &operator=(const SerializeScope &) = delete;
+
+            void finish(const std::string &output);
+
+        private:
+            bool outermost;
+            uint64_t start = 0;
+        };
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// UTF-8 validation and encoding. Runs of ASCII are skipped 16 bytes at a time with SSE2 or
+// NEON where available, so validating mostly-ASCII text costs little more than reading it.
+namespace hh_json::utf8
+{
+    // Length of the leading run of bytes that are ASCII and neither '"', '\\' nor a control
+    // character, i.e. bytes a JSON string scanner can copy without looking at them individually
+    size_t plain_prefix(const char *data, size_t length);
+
+    // Length (1-4) of the well-formed UTF-8 sequence at data, or 0 if it is invalid or truncated.
+    // Overlong forms, surrogates and code points above U+10FFFF are invalid.
+    size_t sequence_length(const char *data, size_t length);
+
+    // True if the whole buffer is well-formed UTF-8; otherwise error_offset (if given) receives
+    // the offset of the first invalid sequence
+    bool validate(const char *data, size_t length, size_t *error_offset = nullptr);
+
+    inline bool validate(std::string_view text, size_t *error_offset = nullptr)
+    {
+        return validate(text.data(), text.size(), error_offset);
+    }
+
+    // Appends the UTF-8 encoding of a Unicode scalar value
+    void append(std::string &out, uint32_t code_point);
+}
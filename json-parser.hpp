@@ -7,4 +7,24 @@
 #include "includes/JsonArray.hpp"
 #include "includes/JsonString.hpp"
 #include "includes/JsonNumber.hpp"
-#include "includes/JsonBoolean.hpp"
\ No newline at end of file
+#include "includes/JsonBoolean.hpp"
+#include "includes/SchemaValidator.hpp"
+#include "includes/binary.hpp"
+#include "includes/snapshot.hpp"
+#include "includes/hash.hpp"
+#include "includes/ParseCache.hpp"
+#include "includes/pointer.hpp"
+#include "includes/PersistentDocument.hpp"
+#include "includes/patch.hpp"
+#include "includes/diff.hpp"
+#include "includes/error.hpp"
+#include "includes/utf8.hpp"
+#include "includes/stats.hpp"
+#include "includes/FrozenDocument.hpp"
+#include "includes/DocumentHandle.hpp"
+#include "includes/pool.hpp"
+#include "includes/ChunkedSerializer.hpp"
+#include "includes/async.hpp"
+#include "includes/compression.hpp"
+#include "includes/ndjson.hpp"
+#include "includes/canonical.hpp"
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <typeinfo>
+
+#include "../includes/ChunkedSerializer.hpp"
+#include "../includes/JsonArray.hpp"
+
+namespace hh_json
+{
+    ChunkedSerializer::ChunkedSerializer(std::shared_ptr<const JsonObject> root) : root(std::move(root)) {}
+
+    void ChunkedSerializer::write_value(const JsonObject &value, std::string &out)
+    {
+        const std::type_info &type = typeid(value);
+        if (type == typeid(JsonObject))
+        {
+            out += '{';
+            stack.push_back({&value, false, true, 0, value.get_data().begin()});
+        }
+        else if (type == typeid(JsonArray))
+        {
+            out += '[';
+            stack.push_back({&value, true, true, 0, {}});
+        }
+        else
+        {
+            value.stringify_to(out);
+        }
+    }
+
+    bool ChunkedSerializer::write_some(std::string &out, size_t max_bytes)
+    {
+        size_t limit = out.size() + max_bytes;
+        if (!started)
+        {
+            started = true;
+            if (!root)
+            {
+                out += "null";
+                return true;
+            }
+            write_value(*root, out);
+        }
+
+        // Same output as the stringify_to overrides of JsonObject and JsonArray
+        while (!stack.empty() && out.size() < limit)
+        {
+            Frame &top = stack.back();
+            const JsonObject *child;
+            if (top.is_array)
+            {
+                const auto &elements = static_cast<const JsonArray &>(*top.node).elements;
+                if (top.index == elements.size())
+                {
+                    out += ']';
+                    stack.pop_back();
+                    continue;
+                }
+                if (!top.first)
+                {
+                    out += ',';
+                }
+                top.first = false;
+                child = elements[top.index++].get();
+                if (!child)
+                {
+                    out += "null";
+                    continue;
+                }
+            }
+            else
+            {
+                if (top.member == top.node->get_data().end())
+                {
+                    out += '}';
+                    stack.pop_back();
+                    continue;
+                }
+                if (!top.first)
+                {
+                    out += ',';
+                }
+                top.first = false;
+                out += '\"';
+                out += top.member->first;
+                out += "\": ";
+                child = top.member->second.get();
+                ++top.member;
+                if (!child)
+                {
+                    out += "{}";
+                    continue;
+                }
+            }
+            write_value(*child, out); // may push; top is not used after this
+        }
+        return stack.empty();
+    }
+}
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <limits>
+
+#include "../includes/DocumentHandle.hpp"
+
+namespace hh_json
+{
+    namespace detail
+    {
+        // One reader thread's announcement. Padded to a cache line so readers on different
+        // threads never write to the same line.
+        struct alignas(64) ReaderSlot
+        {
+            std::atomic<uint64_t> epoch{0}; // epoch the owner entered read() in; 0 when outside
+            std::atomic<bool> claimed{false};
+            unsigned depth = 0; // nested guards; touched only by the owning thread
+        };
+
+        struct SlotBlock
+        {
+            static constexpr size_t size = 16;
+            ReaderSlot slots[size];
+            SlotBlock *next = nullptr;
+        };
+
+        // Reader slots of one handle: an append-only list of blocks, so a scan never races
+        // with a block being freed. Shared with the threads' slot caches so they can give
+        // their slots back on exit if the handle still exists.
+        struct ReaderRegistry
+        {
+            std::atomic<uint64_t> epoch{1};
+            std::atomic<SlotBlock *> blocks{nullptr};
+
+            ~ReaderRegistry()
+            {
+                SlotBlock *block = blocks.load();
+                while (block)
+                {
+                    delete std::exchange(block, block->next);
+                }
+            }
+
+            ReaderSlot &claim()
+            {
+                for (SlotBlock *block = blocks.load(std::memory_order_acquire); block; block = block->next)
+                {
+                    for (auto &slot : block->slots)
+                    {
+                        bool expected = false;
+                        if (!slot.claimed.load(std::memory_order_relaxed) &&
+                            slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                        {
+                            return slot;
+                        }
+                    }
+                }
+
+                // Every slot is taken: add a block with its first slot already ours
+                auto *block = new SlotBlock;
+                block->slots[0].claimed.store(true, std::memory_order_relaxed);
+                SlotBlock *head = blocks.load(std::memory_order_relaxed);
+                do
+                {
+                    block->next = head;
+                } while (!blocks.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+                return block->slots[0];
+            }
+
+            // Oldest epoch a reader is still inside, or max when there is none
+            uint64_t oldest_active() const
+            {
+                uint64_t oldest = std::numeric_limits<uint64_t>::max();
+                for (SlotBlock *block = blocks.load(std::memory_order_acquire); block; block = block->next)
+                {
+                    for (const auto &slot : block->slots)
+                    {
+                        uint64_t entered = slot.epoch.load();
+                        if (entered != 0 && entered < oldest)
+                        {
+                            oldest = entered;
+                        }
+                    }
+                }
+                return oldest;
+            }
+        };
+    }
+
+    namespace
+    {
+        std::atomic<uint64_t> next_handle_id{1};
+
+        struct CachedSlot
+        {
+            uint64_t handle;
+            detail::ReaderSlot *slot;
+            std::weak_ptr<detail::ReaderRegistry> registry;
+        };
+
+        // Slots this thread has claimed, one per handle it has read from
+        struct SlotCache
+        {
+            std::vector<CachedSlot> entries;
+
+            ~SlotCache()
+            {
+                for (auto &entry : entries)
+                {
+                    if (auto registry = entry.registry.lock())
+                    {
+                        entry.slot->claimed.store(false, std::memory_order_release);
+                    }
+                }
+            }
+        };
+
+        thread_local SlotCache slot_cache;
+    }
+
+    DocumentHandle::ReadGuard::~ReadGuard()
+    {
+        if (slot && --slot->depth == 0)
+        {
+            // Release: everything read through document happens before a writer sees 0 here
+            slot->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    DocumentHandle::DocumentHandle(FrozenDocument initial)
+        : id(next_handle_id.fetch_add(1, std::memory_order_relaxed)),
+          registry(std::make_shared<detail::ReaderRegistry>()),
+          current(new FrozenDocument(std::move(initial)))
+    {
+    }
+
+    DocumentHandle::~DocumentHandle()
+    {
+        delete current.load();
+    }
+
+    detail::ReaderSlot &DocumentHandle::local_slot() const
+    {
+        auto &entries = slot_cache.entries;
+        for (const auto &entry : entries)
+        {
+            if (entry.handle == id)
+            {
+                return *entry.slot;
+            }
+        }
+
+        // First read of this handle on this thread; drop entries of handles that are gone
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [](const CachedSlot &entry)
+                                     { return entry.registry.expired(); }),
+                      entries.end());
+        detail::ReaderSlot &slot = registry->claim();
+        entries.push_back({id, &slot, registry});
+        return slot;
+    }
+
+    DocumentHandle::ReadGuard DocumentHandle::read() const
+    {
+        detail::ReaderSlot &slot = local_slot();
+        if (slot.depth++ == 0)
+        {
+            // Announce the epoch before loading the pointer (both sequentially consistent): a
+            // writer that retires the version loaded below will then see this slot
+            slot.epoch.store(registry->epoch.load());
+        }
+        return ReadGuard(current.load(), &slot);
+    }
+
+    FrozenDocument DocumentHandle::snapshot() const
+    {
+        auto guard = read();
+        return *guard;
+    }
+
+    void DocumentHandle::publish(FrozenDocument next)
+    {
+        auto *replacement = new FrozenDocument(std::move(next));
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        const FrozenDocument *previous = current.exchange(replacement);
+        // Readers that entered before this increment may hold previous
+        uint64_t epoch = registry->epoch.fetch_add(1);
+        retired.push_back({epoch, std::unique_ptr<const FrozenDocument>(previous)});
+        published.fetch_add(1, std::memory_order_relaxed);
+        reclaim_locked();
+    }
+
+    size_t DocumentHandle::reclaim()
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        return reclaim_locked();
+    }
+
+    size_t DocumentHandle::reclaim_locked()
+    {
+        if (retired.empty())
+        {
+            return 0;
+        }
+        uint64_t oldest = registry->oldest_active();
+        retired.erase(std::remove_if(retired.begin(), retired.end(), [oldest](const Retired &entry)
+                                     { return entry.epoch < oldest; }),
+                      retired.end());
+        return retired.size();
+    }
+}
@@ -0,0 +1,214 @@
+#include <stdexcept>
+#include <utility>
+
+#include "../includes/FrozenDocument.hpp"
+#include "../includes/JsonArray.hpp"
+#include "../includes/JsonString.hpp"
+#include "../includes/JsonNumber.hpp"
+#include "../includes/JsonBoolean.hpp"
+#include "../includes/healpers.hpp"
+
+namespace hh_json
+{
+    namespace
+    {
+        // Decodes lazy strings and numbers in a tree this thread owns, so later reads never write
+        void materialize_lazy(const std::shared_ptr<JsonObject> &value)
+        {
+            switch (getter::get_type(value))
+            {
+            case JsonType::Number:
+                static_cast<const JsonNumber &>(*value).materialize();
+                break;
+            case JsonType::String:
+                static_cast<const JsonString &>(*value).materialize();
+                break;
+            case JsonType::Array:
+                for (const auto &element : static_cast<const JsonArray &>(*value).elements)
+                {
+                    materialize_lazy(element);
+                }
+                break;
+            case JsonType::Object:
+                for (const auto &member : value->get_data())
+                {
+                    materialize_lazy(member.second);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        // Like patch::clone, but lazy values are decoded in the copy and the source is left as is
+        std::shared_ptr<JsonObject> frozen_copy(const std::shared_ptr<JsonObject> &value)
+        {
+            switch (getter::get_type(value))
+            {
+            case JsonType::Null:
+                return nullptr;
+            case JsonType::Boolean:
+                return std::make_shared<JsonBoolean>(static_cast<const JsonBoolean &>(*value).value);
+            case JsonType::Number:
+            {
+                auto copy = std::make_shared<JsonNumber>(static_cast<const JsonNumber &>(*value));
+                copy->materialize();
+                return copy;
+            }
+            case JsonType::String:
+            {
+                auto copy = std::make_shared<JsonString>(static_cast<const JsonString &>(*value));
+                copy->materialize();
+                return copy;
+            }
+            case JsonType::Array:
+            {
+                auto array = std::make_shared<JsonArray>();
+                const auto &elements = static_cast<const JsonArray &>(*value).elements;
+                array->elements.reserve(elements.size());
+                for (const auto &element : elements)
+                {
+                    array->insert(frozen_copy(element));
+                }
+                return array;
+            }
+            case JsonType::Object:
+            {
+                auto object = std::make_shared<JsonObject>();
+                object->reserve(value->get_data().size());
+                for (const auto &[key, item] : value->get_data())
+                {
+                    object->insert(key, frozen_copy(item));
+                }
+                return object;
+            }
+            }
+            return nullptr;
+        }
+
+        // Stored keys keep their JSON escapes; plain keys are looked up as given
+        std::unordered_map<std::string, std::shared_ptr<JsonObject>>::const_iterator
+        find_member(const std::unordered_map<std::string, std::shared_ptr<JsonObject>> &data, const std::string &key)
+        {
+            return detail::needs_escaping(key) ? data.find(detail::escape_key(key)) : data.find(key);
+        }
+    }
+
+    JsonType FrozenValue::type() const
+    {
+        return node ? node->type() : JsonType::Null;
+    }
+
+    FrozenValue FrozenValue::operator[](const std::string &key) const
+    {
+        if (type() != JsonType::Object)
+        {
+            return FrozenValue();
+        }
+        const auto &data = node->get_data();
+        auto it = find_member(data, key);
+        return FrozenValue(it == data.end() ? nullptr : it->second.get());
+    }
+
+    FrozenValue FrozenValue::operator[](size_t index) const
+    {
+        if (type() != JsonType::Array)
+        {
+            return FrozenValue();
+        }
+        const auto &items = static_cast<const JsonArray &>(*node).elements;
+        return FrozenValue(index < items.size() ? items[index].get() : nullptr);
+    }
+
+    bool FrozenValue::contains(const std::string &key) const
+    {
+        return type() == JsonType::Object && find_member(node->get_data(), key) != node->get_data().end();
+    }
+
+    size_t FrozenValue::size() const
+    {
+        switch (type())
+        {
+        case JsonType::Object:
+            return node->get_data().size();
+        case JsonType::Array:
+            return static_cast<const JsonArray &>(*node).elements.size();
+        default:
+            return 0;
+        }
+    }
+
+    double FrozenValue::as_number() const
+    {
+        if (type() != JsonType::Number)
+        {
+            HH_JSON_THROW(std::runtime_error("Not a number"));
+        }
+        // Materialized when frozen, so this only reads
+        return static_cast<const JsonNumber &>(*node).value;
+    }
+
+    bool FrozenValue::as_boolean() const
+    {
+        if (type() != JsonType::Boolean)
+        {
+            HH_JSON_THROW(std::runtime_error("Not a boolean"));
+        }
+        return static_cast<const JsonBoolean &>(*node).value;
+    }
+
+    std::string_view FrozenValue::as_string() const
+    {
+        if (type() != JsonType::String)
+        {
+            HH_JSON_THROW(std::runtime_error("Not a string"));
+        }
+        // Materialized when frozen, so this only reads
+        return static_cast<const JsonString &>(*node).value;
+    }
+
+    FrozenMembers FrozenValue::members() const
+    {
+        if (type() != JsonType::Object)
+        {
+            HH_JSON_THROW(std::runtime_error("Not an object"));
+        }
+        return FrozenMembers(node->get_data());
+    }
+
+    FrozenElements FrozenValue::elements() const
+    {
+        if (type() != JsonType::Array)
+        {
+            HH_JSON_THROW(std::runtime_error("Not an array"));
+        }
+        return FrozenElements(static_cast<const JsonArray &>(*node).elements);
+    }
+
+    std::string FrozenValue::stringify() const
+    {
+        return node ? node->stringify() : "null";
+    }
+
+    void FrozenValue::stringify_to(std::string &out) const
+    {
+        if (node)
+            node->stringify_to(out);
+        else
+            out += "null";
+    }
+
+    FrozenDocument::FrozenDocument() : tree(std::make_shared<const JsonObject>()) {}
+
+    FrozenDocument freeze(std::unordered_map<std::string, std::shared_ptr<JsonObject>> &&members)
+    {
+        auto root = std::make_shared<JsonObject>(std::move(members));
+        materialize_lazy(root);
+        return FrozenDocument(std::move(root));
+    }
+
+    FrozenDocument freeze(const std::shared_ptr<JsonObject> &value)
+    {
+        return FrozenDocument(frozen_copy(value));
+    }
+}
@@ -1,56 +1,88 @@
-#include <iostream>
-
 #include "../includes/JsonObject.hpp"
 #include "../includes/parser.hpp"
+#include "../includes/stats.hpp"
 namespace hh_json
 {
 
     JsonObject::JsonObject() = default;
     JsonObject::~JsonObject() = default;
-    JsonObject::JsonObject(const std::unordered_map<std::string, std::shared_ptr<JsonObject>> &initial_data) : data(initial_data) {}
+    JsonObject::JsonObject(std::unordered_map<std::string, std::shared_ptr<JsonObject>> initial_data) : data(std::move(initial_data)) {}
 
     bool JsonObject::set_json_data(const std::string &jsonString)
     {
-        try
+        auto result = hh_json::try_parse(jsonString);
+        if (!result)
         {
-
-            data.clear();
-            data = hh_json::parse(jsonString);
-            return true;
-        }
-        catch (const std::exception &e)
-        {
-            std::cerr << "Error parsing JSON data: " << e.what() << std::endl;
-            // Re-throw as runtime_error for tests that expect exceptions
-            throw std::runtime_error("Failed to parse JSON data: " + std::string(e.what()));
+            HH_JSON_THROW(std::runtime_error("Failed to parse JSON data: " + result.error().message()));
         }
+        data = std::move(*result);
+        return true;
+    }
+
+    namespace
+    {
+        // Larger scratch buffers are released after use rather than kept per thread
+        constexpr size_t retained_scratch_capacity = 1 << 20;
     }
 
     std::string JsonObject::stringify() const
     {
-        std::string result = "{";
+        HH_JSON_STATS_ONLY(stats::detail::SerializeScope scope;)
+        thread_local std::string scratch;
+        thread_local bool scratch_in_use = false;
+
+        // Overrides that call stringify from stringify_to must not share the buffer
+        if (scratch_in_use)
+        {
+            std::string result;
+            stringify_to(result);
+            return result;
+        }
 
-        // Add key-value pairs to the JSON object
+        struct Release
+        {
+            ~Release()
+            {
+                scratch.clear();
+                if (scratch.capacity() > retained_scratch_capacity)
+                {
+                    scratch.shrink_to_fit();
+                }
+                scratch_in_use = false;
+            }
+        } release;
+        scratch_in_use = true;
+
+        stringify_to(scratch);
+        HH_JSON_STATS_ONLY(scope.finish(scratch);)
+        return scratch;
+    }
+
+    void JsonObject::stringify_to(std::string &out) const
+    {
+        out += '{';
+        bool first = true;
         for (const auto &pair : data)
         {
-            if (!pair.second)
+            if (!first)
             {
-                result += "\"" + pair.first + "\": " + "{}" + ",";
+                out += ',';
             }
+            first = false;
+            out += '\"';
+            out += pair.first;
+            out += "\": ";
+            if (pair.second)
+                pair.second->stringify_to(out);
             else
-                result += "\"" + pair.first + "\": " + pair.second->stringify() + ",";
-        }
-        if (!data.empty())
-        {
-            result.pop_back(); // Remove trailing comma
+                out += "{}";
         }
-        result += "}";
-        return result;
+        out += '}';
     }
 
-    void JsonObject::insert(const std::string &key, std::shared_ptr<JsonObject> value)
+    void JsonObject::insert(std::string key, std::shared_ptr<JsonObject> value)
     {
-        data[key] = value; // This will overwrite existing keys
+        data.insert_or_assign(std::move(key), std::move(value)); // This will overwrite existing keys
     }
 
     void JsonObject::erase(const std::string &key)
@@ -73,18 +105,54 @@ namespace hh_json
         data.clear();
     }
 
+    JsonType JsonObject::type() const
+    {
+        return JsonType::Object;
+    }
+
     const std::unordered_map<std::string, std::shared_ptr<JsonObject>> &JsonObject::get_data() const
     {
         return data;
     }
 
+    std::unordered_map<std::string, std::shared_ptr<JsonObject>> JsonObject::take_data()
+    {
+        return std::move(data);
+    }
+
+    void JsonObject::reserve(size_t count)
+    {
+        data.reserve(count);
+    }
+
+    std::unordered_map<std::string, std::shared_ptr<JsonObject>>::node_type JsonObject::extract_member()
+    {
+        if (data.empty())
+        {
+            return {};
+        }
+        return data.extract(data.begin());
+    }
+
+    std::unordered_map<std::string, std::shared_ptr<JsonObject>>::node_type
+    JsonObject::insert_member(std::unordered_map<std::string, std::shared_ptr<JsonObject>>::node_type member)
+    {
+        auto result = data.insert(std::move(member));
+        if (!result.inserted)
+        {
+            result.position->second = std::move(result.node.mapped());
+        }
+        return std::move(result.node);
+    }
+
     std::shared_ptr<JsonObject> &JsonObject::operator[](const std::string &key)
     {
-        if (data.find(key) == data.end())
+        auto [it, inserted] = data.try_emplace(key);
+        if (inserted)
         {
-            data[key] = std::make_shared<JsonObject>();
+            it->second = std::make_shared<JsonObject>();
         }
-        return data[key];
+        return it->second;
     }
 
     bool JsonObject::has_key(const std::string &key) const
@@ -0,0 +1,159 @@
+#include "../includes/ParseCache.hpp"
+#include "../includes/parser.hpp"
+#include "../includes/hash.hpp"
+#include "../includes/healpers.hpp"
+
+namespace hh_json
+{
+    namespace
+    {
+        // Rough per-allocation cost of shared_ptr control blocks and hash map nodes
+        constexpr size_t node_overhead = 32;
+
+        size_t tree_size(const JsonObject *value)
+        {
+            switch (value ? value->type() : JsonType::Null)
+            {
+            case JsonType::Null:
+                return 0;
+            case JsonType::Boolean:
+                return sizeof(JsonBoolean) + node_overhead;
+            case JsonType::Number:
+                return sizeof(JsonNumber) + node_overhead;
+            case JsonType::String:
+                return sizeof(JsonString) + node_overhead + static_cast<const JsonString &>(*value).value.capacity();
+            case JsonType::Array:
+            {
+                const auto &elements = static_cast<const JsonArray &>(*value).elements;
+                size_t size = sizeof(JsonArray) + node_overhead + elements.capacity() * sizeof(elements[0]);
+                for (const auto &element : elements)
+                {
+                    size += tree_size(element.get());
+                }
+                return size;
+            }
+            case JsonType::Object:
+            {
+                const auto &data = value->get_data();
+                size_t size = sizeof(JsonObject) + node_overhead + data.bucket_count() * sizeof(void *);
+                for (const auto &[key, item] : data)
+                {
+                    size += node_overhead + sizeof(std::pair<const std::string, std::shared_ptr<JsonObject>>) + key.capacity();
+                    size += tree_size(item.get());
+                }
+                return size;
+            }
+            }
+            return 0;
+        }
+    }
+
+    ParseCache::ParseCache(size_t max_bytes) : max_bytes(max_bytes) {}
+
+    uint64_t ParseCache::make_key(Kind kind, const std::string &input)
+    {
+        // Different seeds keep parse() and value() results of the same text apart
+        return hash::xxh64(input, static_cast<uint64_t>(kind));
+    }
+
+    size_t ParseCache::estimate_size(const std::shared_ptr<const JsonObject> &value)
+    {
+        return tree_size(value.get());
+    }
+
+    std::shared_ptr<const JsonObject> ParseCache::lookup(uint64_t key, const std::string &input)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end() || it->second->input != input)
+        {
+            ++counters.misses;
+            return nullptr;
+        }
+        ++counters.hits;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->document;
+    }
+
+    void ParseCache::store(uint64_t key, const std::string &input, const std::shared_ptr<const JsonObject> &document)
+    {
+        size_t bytes = input.capacity() + estimate_size(document) + sizeof(Entry) + node_overhead;
+        if (bytes > max_bytes)
+        {
+            return; // Would evict everything else and still not fit
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto existing = index.find(key);
+        if (existing != index.end())
+        {
+            // Another thread stored it first, or a colliding input is replaced
+            counters.bytes -= existing->second->bytes;
+            lru.erase(existing->second);
+            index.erase(existing);
+        }
+
+        while (!lru.empty() && counters.bytes + bytes > max_bytes)
+        {
+            counters.bytes -= lru.back().bytes;
+            index.erase(lru.back().key);
+            lru.pop_back();
+            ++counters.evictions;
+        }
+
+        lru.push_front(Entry{key, input, document, bytes});
+        index[key] = lru.begin();
+        counters.bytes += bytes;
+    }
+
+    std::shared_ptr<const JsonObject> ParseCache::parse(const std::string &jsonString)
+    {
+        uint64_t key = make_key(Kind::Document, jsonString);
+        if (auto cached = lookup(key, jsonString))
+        {
+            return cached;
+        }
+
+        // Throws on invalid input, nothing is cached in that case
+        std::shared_ptr<const JsonObject> document = std::make_shared<JsonObject>(hh_json::parse(jsonString));
+        store(key, jsonString, document);
+        return document;
+    }
+
+    std::shared_ptr<const JsonObject> ParseCache::value(const std::string &valueString)
+    {
+        uint64_t key = make_key(Kind::Value, valueString);
+        if (auto cached = lookup(key, valueString))
+        {
+            return cached;
+        }
+
+        std::shared_ptr<const JsonObject> document = JsonValue(valueString);
+        if (document)
+        {
+            store(key, valueString, document);
+        }
+        return document;
+    }
+
+    ParseCache::Stats ParseCache::stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats result = counters;
+        result.entries = lru.size();
+        return result;
+    }
+
+    size_t ParseCache::capacity() const
+    {
+        return max_bytes;
+    }
+
+    void ParseCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lru.clear();
+        index.clear();
+        counters.bytes = 0;
+    }
+}
@@ -0,0 +1,516 @@
+#include <stdexcept>
+#include <vector>
+
+#include "../includes/PersistentDocument.hpp"
+#include "../includes/JsonArray.hpp"
+#include "../includes/JsonString.hpp"
+#include "../includes/JsonNumber.hpp"
+#include "../includes/JsonBoolean.hpp"
+#include "../includes/healpers.hpp"
+#include "../includes/hash.hpp"
+#include "../includes/pointer.hpp"
+
+namespace hh_json
+{
+    namespace detail
+    {
+        struct HamtNode;
+        using HamtPtr = std::shared_ptr<const HamtNode>;
+        using NodePtr = std::shared_ptr<const PersistentNode>;
+
+        // A slot either points to a deeper trie node or holds one key/value pair
+        struct HamtEntry
+        {
+            HamtPtr child;
+            uint64_t hash = 0;
+            std::string key;
+            NodePtr value;
+        };
+
+        struct HamtNode
+        {
+            uint32_t bitmap = 0;
+            bool collision = false; // all 64 hash bits consumed: entries is a plain list
+            std::vector<HamtEntry> entries;
+        };
+
+        struct PersistentNode
+        {
+            JsonType type = JsonType::Null;
+            bool boolean = false;
+            double number = 0;
+            std::string string;
+            std::vector<NodePtr> elements;
+            HamtPtr members;
+            size_t member_count = 0;
+        };
+    }
+
+    namespace
+    {
+        using detail::HamtEntry;
+        using detail::HamtNode;
+        using detail::HamtPtr;
+        using detail::NodePtr;
+        using detail::PersistentNode;
+
+        constexpr unsigned hamt_bits = 5;
+
+        uint32_t popcount(uint32_t x)
+        {
+            uint32_t count = 0;
+            while (x)
+            {
+                x &= x - 1;
+                ++count;
+            }
+            return count;
+        }
+
+        uint64_t key_hash(const std::string &key)
+        {
+            return hash::xxh64(key);
+        }
+
+        const NodePtr *hamt_find(const HamtNode *node, uint64_t h, const std::string &key, unsigned shift)
+        {
+            while (node)
+            {
+                if (node->collision)
+                {
+                    for (const auto &entry : node->entries)
+                    {
+                        if (entry.key == key)
+                            return &entry.value;
+                    }
+                    return nullptr;
+                }
+                uint32_t bit = 1u << ((h >> shift) & 31);
+                if (!(node->bitmap & bit))
+                {
+                    return nullptr;
+                }
+                const HamtEntry &entry = node->entries[popcount(node->bitmap & (bit - 1))];
+                if (!entry.child)
+                {
+                    return entry.key == key ? &entry.value : nullptr;
+                }
+                node = entry.child.get();
+                shift += hamt_bits;
+            }
+            return nullptr;
+        }
+
+        HamtPtr hamt_assoc(const HamtNode *node, uint64_t h, const std::string &key, const NodePtr &value,
+                           unsigned shift, bool &added)
+        {
+            auto copy = node ? std::make_shared<HamtNode>(*node) : std::make_shared<HamtNode>();
+
+            if (shift >= 64)
+            {
+                copy->collision = true;
+                for (auto &entry : copy->entries)
+                {
+                    if (entry.key == key)
+                    {
+                        entry.value = value;
+                        return copy;
+                    }
+                }
+                copy->entries.push_back(HamtEntry{nullptr, h, key, value});
+                added = true;
+                return copy;
+            }
+
+            uint32_t bit = 1u << ((h >> shift) & 31);
+            size_t idx = popcount(copy->bitmap & (bit - 1));
+            if (!(copy->bitmap & bit))
+            {
+                copy->entries.insert(copy->entries.begin() + idx, HamtEntry{nullptr, h, key, value});
+                copy->bitmap |= bit;
+                added = true;
+                return copy;
+            }
+
+            HamtEntry &entry = copy->entries[idx];
+            if (entry.child)
+            {
+                entry.child = hamt_assoc(entry.child.get(), h, key, value, shift + hamt_bits, added);
+            }
+            else if (entry.key == key)
+            {
+                entry.value = value;
+            }
+            else
+            {
+                // Two keys share this slot: push both one level down
+                bool ignored = false;
+                auto sub = hamt_assoc(nullptr, entry.hash, entry.key, entry.value, shift + hamt_bits, ignored);
+                sub = hamt_assoc(sub.get(), h, key, value, shift + hamt_bits, added);
+                entry = HamtEntry{sub, 0, std::string(), nullptr};
+            }
+            return copy;
+        }
+
+        // Returns the new node (nullptr when it became empty); `removed` tells whether the key existed
+        HamtPtr hamt_dissoc(const HamtPtr &node, uint64_t h, const std::string &key, unsigned shift, bool &removed)
+        {
+            if (node->collision)
+            {
+                for (size_t i = 0; i < node->entries.size(); ++i)
+                {
+                    if (node->entries[i].key == key)
+                    {
+                        removed = true;
+                        if (node->entries.size() == 1)
+                            return nullptr;
+                        auto copy = std::make_shared<HamtNode>(*node);
+                        copy->entries.erase(copy->entries.begin() + i);
+                        return copy;
+                    }
+                }
+                return node;
+            }
+
+            uint32_t bit = 1u << ((h >> shift) & 31);
+            if (!(node->bitmap & bit))
+            {
+                return node;
+            }
+            size_t idx = popcount(node->bitmap & (bit - 1));
+            const HamtEntry &entry = node->entries[idx];
+
+            HamtPtr new_child;
+            if (entry.child)
+            {
+                new_child = hamt_dissoc(entry.child, h, key, shift + hamt_bits, removed);
+                if (!removed)
+                {
+                    return node;
+                }
+            }
+            else if (entry.key == key)
+            {
+                removed = true;
+            }
+            else
+            {
+                return node;
+            }
+
+            auto copy = std::make_shared<HamtNode>(*node);
+            if (new_child && !(new_child->entries.size() == 1 && !new_child->entries[0].child))
+            {
+                copy->entries[idx].child = new_child;
+            }
+            else if (new_child)
+            {
+                // Pull a lone pair back up so the trie stays as shallow as possible
+                copy->entries[idx] = new_child->entries[0];
+            }
+            else
+            {
+                copy->entries.erase(copy->entries.begin() + idx);
+                copy->bitmap &= ~bit;
+                if (copy->entries.empty())
+                    return nullptr;
+            }
+            return copy;
+        }
+
+        template <typename Fn>
+        void hamt_for_each(const HamtNode *node, Fn &&fn)
+        {
+            if (!node)
+            {
+                return;
+            }
+            for (const auto &entry : node->entries)
+            {
+                if (entry.child)
+                    hamt_for_each(entry.child.get(), fn);
+                else
+                    fn(entry.key, entry.value);
+            }
+        }
+
+        NodePtr from_dom(const std::shared_ptr<JsonObject> &value)
+        {
+            auto node = std::make_shared<PersistentNode>();
+            node->type = getter::get_type(value);
+            switch (node->type)
+            {
+            case JsonType::Null:
+                break;
+            case JsonType::Boolean:
+                node->boolean = static_cast<const JsonBoolean &>(*value).value;
+                break;
+            case JsonType::Number:
+                node->number = static_cast<const JsonNumber &>(*value).number();
+                break;
+            case JsonType::String:
+                node->string = static_cast<const JsonString &>(*value).str();
+                break;
+            case JsonType::Array:
+            {
+                const auto &elements = static_cast<const JsonArray &>(*value).elements;
+                node->elements.reserve(elements.size());
+                for (const auto &element : elements)
+                {
+                    node->elements.push_back(from_dom(element));
+                }
+                break;
+            }
+            case JsonType::Object:
+                for (const auto &[key, item] : value->get_data())
+                {
+                    bool added = false;
+                    node->members = hamt_assoc(node->members.get(), key_hash(key), key, from_dom(item), 0, added);
+                    node->member_count += added;
+                }
+                break;
+            }
+            return node;
+        }
+
+        std::shared_ptr<JsonObject> to_dom(const PersistentNode &node)
+        {
+            switch (node.type)
+            {
+            case JsonType::Null:
+                return nullptr;
+            case JsonType::Boolean:
+                return std::make_shared<JsonBoolean>(node.boolean);
+            case JsonType::Number:
+                return std::make_shared<JsonNumber>(node.number);
+            case JsonType::String:
+                return std::make_shared<JsonString>(node.string);
+            case JsonType::Array:
+            {
+                auto array = std::make_shared<JsonArray>();
+                array->elements.reserve(node.elements.size());
+                for (const auto &element : node.elements)
+                {
+                    array->insert(to_dom(*element));
+                }
+                return array;
+            }
+            case JsonType::Object:
+            {
+                auto object = std::make_shared<JsonObject>();
+                hamt_for_each(node.members.get(), [&](const std::string &key, const NodePtr &item)
+                              { object->insert(key, to_dom(*item)); });
+                return object;
+            }
+            }
+            return nullptr;
+        }
+
+        // Pointer tokens are plain text; object keys are stored escaped, as from_dom takes them from the DOM
+        std::string member_key(const std::string &token)
+        {
+            return detail::needs_escaping(token) ? detail::escape_key(token) : token;
+        }
+
+        const NodePtr *child_of(const PersistentNode &node, const std::string &token)
+        {
+            if (node.type == JsonType::Object)
+            {
+                std::string key = member_key(token);
+                return hamt_find(node.members.get(), key_hash(key), key, 0);
+            }
+            if (node.type == JsonType::Array)
+            {
+                size_t index = 0;
+                bool found = pointer::try_array_index(token, node.elements.size(), index);
+                return found && index < node.elements.size() ? &node.elements[index] : nullptr;
+            }
+            return nullptr;
+        }
+
+        const NodePtr *resolve(const NodePtr &root, const std::vector<std::string> &tokens)
+        {
+            const NodePtr *current = &root;
+            for (const auto &token : tokens)
+            {
+                current = child_of(**current, token);
+                if (!current)
+                {
+                    return nullptr;
+                }
+            }
+            return current;
+        }
+
+        // Path copying: rebuilds only the nodes from the root down to tokens[depth..]
+        NodePtr set_at(const NodePtr &node, const std::vector<std::string> &tokens, size_t depth, const NodePtr &value)
+        {
+            if (depth == tokens.size())
+            {
+                return value;
+            }
+
+            const std::string &token = tokens[depth];
+            bool last = depth + 1 == tokens.size();
+            auto copy = std::make_shared<PersistentNode>(*node);
+
+            if (node->type == JsonType::Object)
+            {
+                std::string key = member_key(token);
+                uint64_t h = key_hash(key);
+                const NodePtr *child = hamt_find(node->members.get(), h, key, 0);
+                if (!child && !last)
+                {
+                    HH_JSON_THROW(std::runtime_error("Path not found: " + token));
+                }
+                NodePtr updated = last ? value : set_at(*child, tokens, depth + 1, value);
+                bool added = false;
+                copy->members = hamt_assoc(node->members.get(), h, key, updated, 0, added);
+                copy->member_count += added;
+                return copy;
+            }
+            if (node->type == JsonType::Array)
+            {
+                size_t index = pointer::array_index(token, node->elements.size());
+                if (index == node->elements.size())
+                {
+                    if (!last)
+                    {
+                        HH_JSON_THROW(std::runtime_error("Path not found: " + token));
+                    }
+                    copy->elements.push_back(value);
+                }
+                else
+                {
+                    copy->elements[index] = last ? value : set_at(node->elements[index], tokens, depth + 1, value);
+                }
+                return copy;
+            }
+            HH_JSON_THROW(std::runtime_error("Cannot descend into a scalar at: " + token));
+        }
+
+        NodePtr remove_at(const NodePtr &node, const std::vector<std::string> &tokens, size_t depth)
+        {
+            const std::string &token = tokens[depth];
+            bool last = depth + 1 == tokens.size();
+            auto copy = std::make_shared<PersistentNode>(*node);
+
+            if (node->type == JsonType::Object)
+            {
+                std::string key = member_key(token);
+                uint64_t h = key_hash(key);
+                const NodePtr *child = hamt_find(node->members.get(), h, key, 0);
+                if (!child)
+                {
+                    HH_JSON_THROW(std::runtime_error("Path not found: " + token));
+                }
+                if (last)
+                {
+                    bool removed = false;
+                    copy->members = hamt_dissoc(node->members, h, key, 0, removed);
+                    copy->member_count -= removed;
+                }
+                else
+                {
+                    bool added = false;
+                    copy->members = hamt_assoc(node->members.get(), h, key, remove_at(*child, tokens, depth + 1), 0, added);
+                }
+                return copy;
+            }
+            if (node->type == JsonType::Array)
+            {
+                size_t index = pointer::array_index(token, node->elements.size());
+                if (index == node->elements.size())
+                {
+                    HH_JSON_THROW(std::runtime_error("Path not found: " + token));
+                }
+                if (last)
+                    copy->elements.erase(copy->elements.begin() + index);
+                else
+                    copy->elements[index] = remove_at(node->elements[index], tokens, depth + 1);
+                return copy;
+            }
+            HH_JSON_THROW(std::runtime_error("Cannot descend into a scalar at: " + token));
+        }
+    }
+
+    PersistentDocument::PersistentDocument() : root(from_dom(std::make_shared<JsonObject>())) {}
+
+    PersistentDocument::PersistentDocument(const std::shared_ptr<JsonObject> &root) : root(from_dom(root)) {}
+
+    PersistentDocument::PersistentDocument(std::shared_ptr<const detail::PersistentNode> root) : root(std::move(root)) {}
+
+    PersistentDocument PersistentDocument::with(const std::string &path, const std::shared_ptr<JsonObject> &value) const
+    {
+        return PersistentDocument(set_at(root, pointer::parse(path), 0, from_dom(value)));
+    }
+
+    PersistentDocument PersistentDocument::without(const std::string &path) const
+    {
+        auto tokens = pointer::parse(path);
+        if (tokens.empty())
+        {
+            HH_JSON_THROW(std::runtime_error("Cannot remove the document root"));
+        }
+        return PersistentDocument(remove_at(root, tokens, 0));
+    }
+
+    bool PersistentDocument::contains(const std::string &path) const
+    {
+        std::vector<std::string> tokens;
+        return pointer::try_parse(path, tokens) && resolve(root, tokens) != nullptr;
+    }
+
+    JsonType PersistentDocument::type(const std::string &path) const
+    {
+        const NodePtr *node = resolve(root, pointer::parse(path));
+        if (!node)
+        {
+            HH_JSON_THROW(std::runtime_error("Path not found: " + path));
+        }
+        return (*node)->type;
+    }
+
+    size_t PersistentDocument::size(const std::string &path) const
+    {
+        const NodePtr *node = resolve(root, pointer::parse(path));
+        if (!node)
+        {
+            HH_JSON_THROW(std::runtime_error("Path not found: " + path));
+        }
+        if ((*node)->type == JsonType::Array)
+            return (*node)->elements.size();
+        if ((*node)->type == JsonType::Object)
+            return (*node)->member_count;
+        return 0;
+    }
+
+    std::shared_ptr<JsonObject> PersistentDocument::get(const std::string &path) const
+    {
+        const NodePtr *node = resolve(root, pointer::parse(path));
+        if (!node)
+        {
+            HH_JSON_THROW(std::runtime_error("Path not found: " + path));
+        }
+        return to_dom(**node);
+    }
+
+    std::shared_ptr<JsonObject> PersistentDocument::to_object() const
+    {
+        return to_dom(*root);
+    }
+
+    std::string PersistentDocument::stringify() const
+    {
+        auto object = to_object();
+        return object ? object->stringify() : "null";
+    }
+
+    bool PersistentDocument::same_subtree(const PersistentDocument &other, const std::string &path) const
+    {
+        auto tokens = pointer::parse(path);
+        const NodePtr *mine = resolve(root, tokens);
+        const NodePtr *theirs = resolve(other.root, tokens);
+        return mine && theirs && *mine == *theirs;
+    }
+}
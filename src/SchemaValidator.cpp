@@ -0,0 +1,484 @@
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+#include "../includes/SchemaValidator.hpp"
+#include "../includes/parser.hpp"
+#include "../includes/JsonString.hpp"
+#include "../includes/healpers.hpp"
+#include "../includes/pointer.hpp"
+
+namespace hh_json
+{
+    namespace
+    {
+        constexpr uint32_t integer_bit = 1u << 6;
+        constexpr uint32_t any_type = 0x7F;
+
+        uint32_t type_bit(JsonType type)
+        {
+            return 1u << static_cast<uint32_t>(type);
+        }
+
+        uint32_t type_bit_from_name(const std::string &name)
+        {
+            if (name == "null")
+                return type_bit(JsonType::Null);
+            if (name == "object")
+                return type_bit(JsonType::Object);
+            if (name == "array")
+                return type_bit(JsonType::Array);
+            if (name == "string")
+                return type_bit(JsonType::String);
+            if (name == "number")
+                return type_bit(JsonType::Number);
+            if (name == "boolean")
+                return type_bit(JsonType::Boolean);
+            if (name == "integer")
+                return integer_bit;
+            HH_JSON_THROW(std::runtime_error("Unknown schema type: " + name));
+        }
+
+        const char *type_name(JsonType type)
+        {
+            switch (type)
+            {
+            case JsonType::Null:
+                return "null";
+            case JsonType::Object:
+                return "object";
+            case JsonType::Array:
+                return "array";
+            case JsonType::String:
+                return "string";
+            case JsonType::Number:
+                return "number";
+            case JsonType::Boolean:
+                return "boolean";
+            }
+            return "unknown";
+        }
+
+        double schema_number(const std::shared_ptr<JsonObject> &value, const char *keyword)
+        {
+            if (getter::get_type(value) != JsonType::Number)
+            {
+                HH_JSON_THROW(std::runtime_error(std::string("Schema keyword '") + keyword + "' must be a number"));
+            }
+            return static_cast<const JsonNumber &>(*value).number();
+        }
+
+        uint32_t schema_count(const std::shared_ptr<JsonObject> &value, const char *keyword)
+        {
+            double number = schema_number(value, keyword);
+            if (number < 0 || number != std::floor(number))
+            {
+                HH_JSON_THROW(std::runtime_error(std::string("Schema keyword '") + keyword + "' must be a non-negative integer"));
+            }
+            return static_cast<uint32_t>(number);
+        }
+
+        // Number of UTF-8 code points, which is what JSON Schema string lengths count
+        size_t code_points(const std::string &str)
+        {
+            size_t count = 0;
+            for (unsigned char c : str)
+            {
+                if ((c & 0xC0) != 0x80)
+                {
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+        bool fail(std::string *error, const std::string &message)
+        {
+            if (error)
+            {
+                *error = message;
+            }
+            return false;
+        }
+
+        std::string format_number(double value)
+        {
+            return JsonNumber(value).stringify();
+        }
+    }
+
+    SchemaValidator::SchemaValidator(const std::string &schemaJson)
+    {
+        size_t first = schemaJson.find_first_not_of(" \t\r\n");
+        auto schema = JsonValue(schemaJson);
+        // JsonValue reports failures as nullptr, which is also how it returns a literal null
+        if (!schema && (first == std::string::npos || schemaJson.compare(first, 4, "null") != 0))
+        {
+            HH_JSON_THROW(std::runtime_error("Invalid schema JSON"));
+        }
+        if (compile(schema) == unconstrained)
+        {
+            // Keep root() valid even for the empty schema
+            nodes.push_back(Node{any_type});
+        }
+    }
+
+    SchemaValidator::SchemaValidator(const std::shared_ptr<JsonObject> &schema)
+    {
+        if (compile(schema) == unconstrained)
+        {
+            nodes.push_back(Node{any_type});
+        }
+    }
+
+    uint32_t SchemaValidator::compile(const std::shared_ptr<JsonObject> &schema)
+    {
+        auto schema_type = getter::get_type(schema);
+        if (schema_type == JsonType::Boolean)
+        {
+            if (static_cast<const JsonBoolean &>(*schema).value)
+            {
+                return unconstrained;
+            }
+            // `false` accepts nothing
+            nodes.push_back(Node{0});
+            return static_cast<uint32_t>(nodes.size() - 1);
+        }
+        if (schema_type != JsonType::Object)
+        {
+            HH_JSON_THROW(std::runtime_error("Schema must be an object or a boolean"));
+        }
+
+        uint32_t index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{any_type});
+        nodes[index].first = static_cast<uint32_t>(program.size());
+
+        if (auto type = schema->get("type"))
+        {
+            uint32_t mask = 0;
+            if (auto names = std::dynamic_pointer_cast<JsonArray>(type))
+            {
+                for (const auto &name : names->elements)
+                {
+                    mask |= type_bit_from_name(getter::get_string(name));
+                }
+            }
+            else
+            {
+                mask = type_bit_from_name(getter::get_string(type));
+            }
+            nodes[index].type_mask = mask;
+            if ((mask & integer_bit) && !(mask & type_bit(JsonType::Number)))
+            {
+                program.push_back({SchemaOp::Integer});
+            }
+        }
+
+        const std::pair<const char *, SchemaOp> numeric_keywords[] = {
+            {"minimum", SchemaOp::Minimum},
+            {"maximum", SchemaOp::Maximum},
+            {"exclusiveMinimum", SchemaOp::ExclusiveMinimum},
+            {"exclusiveMaximum", SchemaOp::ExclusiveMaximum},
+        };
+        for (const auto &[keyword, op] : numeric_keywords)
+        {
+            if (auto value = schema->get(keyword))
+            {
+                program.push_back({op, 0, 0, schema_number(value, keyword)});
+            }
+        }
+
+        const std::pair<const char *, SchemaOp> count_keywords[] = {
+            {"minLength", SchemaOp::MinLength},
+            {"maxLength", SchemaOp::MaxLength},
+            {"minItems", SchemaOp::MinItems},
+            {"maxItems", SchemaOp::MaxItems},
+        };
+        for (const auto &[keyword, op] : count_keywords)
+        {
+            if (auto value = schema->get(keyword))
+            {
+                program.push_back({op, schema_count(value, keyword)});
+            }
+        }
+
+        if (auto pattern = schema->get("pattern"))
+        {
+            const auto &source = getter::get_string(pattern);
+#if HH_JSON_EXCEPTIONS
+            try
+            {
+                patterns.emplace_back(source, std::regex::ECMAScript | std::regex::optimize);
+            }
+            catch (const std::regex_error &e)
+            {
+                throw std::runtime_error("Invalid schema pattern '" + source + "': " + e.what());
+            }
+#else
+            // Without exceptions the standard library aborts on an invalid pattern
+            patterns.emplace_back(source, std::regex::ECMAScript | std::regex::optimize);
+#endif
+            pattern_sources.push_back(source);
+            program.push_back({SchemaOp::Pattern, static_cast<uint32_t>(patterns.size() - 1)});
+        }
+
+        if (auto values = schema->get("enum"))
+        {
+            enums.push_back(getter::get_array(values));
+            program.push_back({SchemaOp::Enum, static_cast<uint32_t>(enums.size() - 1)});
+        }
+
+        if (auto keys = schema->get("required"))
+        {
+            uint32_t begin = static_cast<uint32_t>(required.size());
+            for (const auto &key : getter::get_array_ref(keys))
+            {
+                // Object keys are stored escaped, so that is the form has_key() looks up
+                std::string name = getter::get_string(key);
+                std::string stored = detail::needs_escaping(name) ? detail::escape_key(name) : name;
+                required.emplace_back(std::move(stored), std::move(name));
+            }
+            program.push_back({SchemaOp::Required, begin, static_cast<uint32_t>(required.size()) - begin});
+        }
+
+        nodes[index].count = static_cast<uint32_t>(program.size()) - nodes[index].first;
+
+        // Children are compiled after this node's instructions so its program stays contiguous
+        std::vector<std::pair<std::string, uint32_t>> own_properties;
+        if (auto props = schema->get("properties"))
+        {
+            if (getter::get_type(props) != JsonType::Object)
+            {
+                HH_JSON_THROW(std::runtime_error("Schema keyword 'properties' must be an object"));
+            }
+            for (const auto &[key, subschema] : props->get_data())
+            {
+                own_properties.emplace_back(key, compile(subschema));
+            }
+            std::sort(own_properties.begin(), own_properties.end());
+        }
+
+        if (auto items = schema->get("items"))
+        {
+            uint32_t items_node = compile(items);
+            nodes[index].items = items_node;
+        }
+
+        nodes[index].properties_begin = static_cast<uint32_t>(properties.size());
+        for (auto &property : own_properties)
+        {
+            properties.push_back(std::move(property));
+        }
+        nodes[index].properties_end = static_cast<uint32_t>(properties.size());
+
+        return index;
+    }
+
+    uint32_t SchemaValidator::root() const
+    {
+        return 0;
+    }
+
+    uint32_t SchemaValidator::property_schema(uint32_t node, const std::string &key) const
+    {
+        if (node == unconstrained)
+        {
+            return unconstrained;
+        }
+        auto begin = properties.begin() + nodes[node].properties_begin;
+        auto end = properties.begin() + nodes[node].properties_end;
+        auto it = std::lower_bound(begin, end, key, [](const auto &entry, const std::string &k)
+                                   { return entry.first < k; });
+        if (it != end && it->first == key)
+        {
+            return it->second;
+        }
+        return unconstrained;
+    }
+
+    uint32_t SchemaValidator::items_schema(uint32_t node) const
+    {
+        return node == unconstrained ? unconstrained : nodes[node].items;
+    }
+
+    bool SchemaValidator::accepts_type(uint32_t node, JsonType type) const
+    {
+        if (node == unconstrained)
+        {
+            return true;
+        }
+        uint32_t mask = nodes[node].type_mask;
+        if (type == JsonType::Number)
+        {
+            return (mask & (type_bit(JsonType::Number) | integer_bit)) != 0;
+        }
+        return (mask & type_bit(type)) != 0;
+    }
+
+    bool SchemaValidator::check(uint32_t node, const std::shared_ptr<JsonObject> &value, std::string *error) const
+    {
+        if (node == unconstrained)
+        {
+            return true;
+        }
+
+        auto type = getter::get_type(value);
+        if (!accepts_type(node, type))
+        {
+            return fail(error, std::string("unexpected type ") + type_name(type));
+        }
+
+        const Node &n = nodes[node];
+        for (uint32_t i = n.first; i < n.first + n.count; ++i)
+        {
+            const SchemaInstruction &ins = program[i];
+            switch (ins.op)
+            {
+            case SchemaOp::Integer:
+            case SchemaOp::Minimum:
+            case SchemaOp::Maximum:
+            case SchemaOp::ExclusiveMinimum:
+            case SchemaOp::ExclusiveMaximum:
+            {
+                if (type != JsonType::Number)
+                {
+                    break;
+                }
+                double number = static_cast<const JsonNumber &>(*value).number();
+                if (ins.op == SchemaOp::Integer && number != std::floor(number))
+                    return fail(error, "expected an integer");
+                if (ins.op == SchemaOp::Minimum && !(number >= ins.operand))
+                    return fail(error, "value is less than minimum " + format_number(ins.operand));
+                if (ins.op == SchemaOp::Maximum && !(number <= ins.operand))
+                    return fail(error, "value is greater than maximum " + format_number(ins.operand));
+                if (ins.op == SchemaOp::ExclusiveMinimum && !(number > ins.operand))
+                    return fail(error, "value must be greater than " + format_number(ins.operand));
+                if (ins.op == SchemaOp::ExclusiveMaximum && !(number < ins.operand))
+                    return fail(error, "value must be less than " + format_number(ins.operand));
+                break;
+            }
+            case SchemaOp::MinLength:
+            case SchemaOp::MaxLength:
+            {
+                if (type != JsonType::String)
+                {
+                    break;
+                }
+                size_t length = code_points(static_cast<const JsonString &>(*value).str());
+                if (ins.op == SchemaOp::MinLength && length < ins.a)
+                    return fail(error, "string is shorter than " + std::to_string(ins.a));
+                if (ins.op == SchemaOp::MaxLength && length > ins.a)
+                    return fail(error, "string is longer than " + std::to_string(ins.a));
+                break;
+            }
+            case SchemaOp::MinItems:
+            case SchemaOp::MaxItems:
+            {
+                if (type != JsonType::Array)
+                {
+                    break;
+                }
+                size_t size = static_cast<const JsonArray &>(*value).elements.size();
+                if (ins.op == SchemaOp::MinItems && size < ins.a)
+                    return fail(error, "array has fewer than " + std::to_string(ins.a) + " items");
+                if (ins.op == SchemaOp::MaxItems && size > ins.a)
+                    return fail(error, "array has more than " + std::to_string(ins.a) + " items");
+                break;
+            }
+            case SchemaOp::Pattern:
+                if (type == JsonType::String &&
+                    !std::regex_search(static_cast<const JsonString &>(*value).str(), patterns[ins.a]))
+                {
+                    return fail(error, "string does not match pattern '" + pattern_sources[ins.a] + "'");
+                }
+                break;
+            case SchemaOp::Enum:
+            {
+                const auto &allowed = enums[ins.a];
+                if (std::none_of(allowed.begin(), allowed.end(), [&](const auto &candidate)
+                                 { return equals(candidate, value); }))
+                {
+                    return fail(error, "value is not one of the enumerated values");
+                }
+                break;
+            }
+            case SchemaOp::Required:
+                if (type != JsonType::Object)
+                {
+                    break;
+                }
+                for (uint32_t k = ins.a; k < ins.a + ins.b; ++k)
+                {
+                    if (!value->has_key(required[k].first))
+                    {
+                        return fail(error, "missing required property '" + required[k].second + "'");
+                    }
+                }
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool SchemaValidator::validate_node(uint32_t node, const std::shared_ptr<JsonObject> &value, std::string &path, std::string *error) const
+    {
+        if (node == unconstrained)
+        {
+            return true;
+        }
+
+        std::string reason;
+        if (!check(node, value, error ? &reason : nullptr))
+        {
+            return fail(error, (path.empty() ? "/" : path) + ": " + reason);
+        }
+
+        auto type = getter::get_type(value);
+        size_t path_length = path.size();
+        if (type == JsonType::Object)
+        {
+            for (const auto &[key, child] : value->get_data())
+            {
+                uint32_t child_node = property_schema(node, key);
+                if (child_node == unconstrained)
+                {
+                    continue;
+                }
+                pointer::append(path, key);
+                bool ok = validate_node(child_node, child, path, error);
+                path.resize(path_length);
+                if (!ok)
+                {
+                    return false;
+                }
+            }
+        }
+        else if (type == JsonType::Array && nodes[node].items != unconstrained)
+        {
+            const auto &elements = static_cast<const JsonArray &>(*value).elements;
+            for (size_t i = 0; i < elements.size(); ++i)
+            {
+                path += '/';
+                path += std::to_string(i);
+                bool ok = validate_node(nodes[node].items, elements[i], path, error);
+                path.resize(path_length);
+                if (!ok)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool SchemaValidator::validate(const std::shared_ptr<JsonObject> &value, std::string *error) const
+    {
+        std::string path;
+        return validate_node(root(), value, path, error);
+    }
+
+    size_t SchemaValidator::program_size() const
+    {
+        return program.size();
+    }
+}
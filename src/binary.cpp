@@ -0,0 +1,748 @@
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+#include "../includes/binary.hpp"
+#include "../includes/JsonObject.hpp"
+#include "../includes/JsonArray.hpp"
+#include "../includes/JsonString.hpp"
+#include "../includes/JsonNumber.hpp"
+#include "../includes/JsonBoolean.hpp"
+#include "../includes/healpers.hpp"
+
+namespace hh_json
+{
+    namespace
+    {
+        // Nesting limit for decoding untrusted binary input
+        constexpr size_t max_binary_depth = 1024;
+
+        // Keys go on the wire as their text, not in the escaped form the DOM stores them in
+        const std::string &wire_key(const std::string &stored, std::string &scratch)
+        {
+            if (stored.find('\\') == std::string::npos)
+                return stored;
+            scratch = detail::unescape_key(stored);
+            return scratch;
+        }
+
+        std::string stored_key(std::string text)
+        {
+            return detail::needs_escaping(text) ? detail::escape_key(text) : text;
+        }
+
+        void put_be(std::string &out, uint64_t value, int bytes)
+        {
+            for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+            {
+                out.push_back(static_cast<char>((value >> shift) & 0xFF));
+            }
+        }
+
+        uint64_t double_bits(double value)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        uint32_t float_bits(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        // Integral values that fit in a signed 64-bit integer are written as integers
+        bool encodes_as_integer(double value)
+        {
+            return value == std::floor(value) && value >= -9223372036854775808.0 && value < 9223372036854775808.0 &&
+                   !(value == 0 && std::signbit(value));
+        }
+
+        bool fits_float(double value)
+        {
+            return !std::isnan(value) && static_cast<double>(static_cast<float>(value)) == value;
+        }
+
+        // Shared bounds-checked big-endian reader
+        struct Reader
+        {
+            const unsigned char *data;
+            size_t size;
+            size_t pos = 0;
+
+            [[noreturn]] void error(const std::string &message) const
+            {
+                HH_JSON_THROW(std::runtime_error(message + " at offset " + std::to_string(pos)));
+            }
+
+            void need(size_t count) const
+            {
+                if (count > size - pos)
+                {
+                    HH_JSON_THROW(std::runtime_error("Unexpected end of binary input at offset " + std::to_string(pos)));
+                }
+            }
+
+            uint8_t byte()
+            {
+                need(1);
+                return data[pos++];
+            }
+
+            uint64_t be(int bytes)
+            {
+                need(static_cast<size_t>(bytes));
+                uint64_t value = 0;
+                for (int i = 0; i < bytes; ++i)
+                {
+                    value = (value << 8) | data[pos++];
+                }
+                return value;
+            }
+
+            double f32()
+            {
+                uint32_t bits = static_cast<uint32_t>(be(4));
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+
+            double f64()
+            {
+                uint64_t bits = be(8);
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+
+            // JSON has no NaN or infinity, so a float that is neither finite is unrepresentable
+            std::shared_ptr<JsonObject> number(double value) const
+            {
+                if (!std::isfinite(value))
+                {
+                    error("Non-finite number");
+                }
+                return std::make_shared<JsonNumber>(value);
+            }
+
+            std::string text(uint64_t length)
+            {
+                if (length > size - pos)
+                {
+                    error("String length exceeds input");
+                }
+                std::string value(reinterpret_cast<const char *>(data + pos), static_cast<size_t>(length));
+                pos += static_cast<size_t>(length);
+                return value;
+            }
+        };
+
+        // ---------------------------------------------------------------- CBOR
+
+        void cbor_head(std::string &out, uint8_t major, uint64_t argument)
+        {
+            uint8_t mt = static_cast<uint8_t>(major << 5);
+            if (argument < 24)
+            {
+                out.push_back(static_cast<char>(mt | argument));
+            }
+            else if (argument <= 0xFF)
+            {
+                out.push_back(static_cast<char>(mt | 24));
+                put_be(out, argument, 1);
+            }
+            else if (argument <= 0xFFFF)
+            {
+                out.push_back(static_cast<char>(mt | 25));
+                put_be(out, argument, 2);
+            }
+            else if (argument <= 0xFFFFFFFFull)
+            {
+                out.push_back(static_cast<char>(mt | 26));
+                put_be(out, argument, 4);
+            }
+            else
+            {
+                out.push_back(static_cast<char>(mt | 27));
+                put_be(out, argument, 8);
+            }
+        }
+
+        void cbor_encode(const std::shared_ptr<JsonObject> &value, std::string &out)
+        {
+            switch (getter::get_type(value))
+            {
+            case JsonType::Null:
+                out.push_back(static_cast<char>(0xF6));
+                break;
+            case JsonType::Boolean:
+                out.push_back(static_cast<char>(static_cast<const JsonBoolean &>(*value).value ? 0xF5 : 0xF4));
+                break;
+            case JsonType::Number:
+            {
+                double number = static_cast<const JsonNumber &>(*value).number();
+                if (encodes_as_integer(number))
+                {
+                    auto integer = static_cast<int64_t>(number);
+                    if (integer >= 0)
+                        cbor_head(out, 0, static_cast<uint64_t>(integer));
+                    else
+                        cbor_head(out, 1, static_cast<uint64_t>(-(integer + 1)));
+                }
+                else if (fits_float(number))
+                {
+                    out.push_back(static_cast<char>(0xFA));
+                    put_be(out, float_bits(static_cast<float>(number)), 4);
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(0xFB));
+                    put_be(out, double_bits(number), 8);
+                }
+                break;
+            }
+            case JsonType::String:
+            {
+                std::string_view str = static_cast<const JsonString &>(*value).view();
+                cbor_head(out, 3, str.size());
+                out.append(str);
+                break;
+            }
+            case JsonType::Array:
+            {
+                const auto &elements = static_cast<const JsonArray &>(*value).elements;
+                cbor_head(out, 4, elements.size());
+                for (const auto &element : elements)
+                {
+                    cbor_encode(element, out);
+                }
+                break;
+            }
+            case JsonType::Object:
+            {
+                const auto &data = value->get_data();
+                cbor_head(out, 5, data.size());
+                std::string scratch;
+                for (const auto &[stored, item] : data)
+                {
+                    const std::string &key = wire_key(stored, scratch);
+                    cbor_head(out, 3, key.size());
+                    out.append(key);
+                    cbor_encode(item, out);
+                }
+                break;
+            }
+            }
+        }
+
+        double half_to_double(uint16_t half)
+        {
+            int exponent = (half >> 10) & 0x1F;
+            int mantissa = half & 0x3FF;
+            double value;
+            if (exponent == 0)
+                value = std::ldexp(mantissa, -24);
+            else if (exponent != 31)
+                value = std::ldexp(mantissa + 1024, exponent - 25);
+            else
+                value = mantissa == 0 ? INFINITY : NAN;
+            return (half & 0x8000) ? -value : value;
+        }
+
+        struct CborDecoder : Reader
+        {
+            static constexpr uint64_t indefinite = ~0ull;
+
+            uint64_t argument(uint8_t info)
+            {
+                if (info < 24)
+                    return info;
+                if (info == 24)
+                    return be(1);
+                if (info == 25)
+                    return be(2);
+                if (info == 26)
+                    return be(4);
+                if (info == 27)
+                    return be(8);
+                if (info == 31)
+                    return indefinite;
+                error("Invalid CBOR additional information");
+            }
+
+            bool at_break()
+            {
+                need(1);
+                if (data[pos] == 0xFF)
+                {
+                    ++pos;
+                    return true;
+                }
+                return false;
+            }
+
+            std::string text_value(uint8_t major, uint64_t length)
+            {
+                if (length != indefinite)
+                {
+                    return text(length);
+                }
+                // Indefinite-length string: concatenation of definite chunks of the same major type
+                std::string value;
+                while (!at_break())
+                {
+                    uint8_t head = byte();
+                    uint64_t chunk = argument(head & 0x1F);
+                    if ((head >> 5) != major || chunk == indefinite)
+                    {
+                        error("Invalid CBOR string chunk");
+                    }
+                    value += text(chunk);
+                }
+                return value;
+            }
+
+            std::string key()
+            {
+                uint8_t head = byte();
+                if ((head >> 5) != 3)
+                {
+                    error("CBOR map keys must be text strings");
+                }
+                return stored_key(text_value(3, argument(head & 0x1F)));
+            }
+
+            std::shared_ptr<JsonObject> value(size_t depth)
+            {
+                if (depth > max_binary_depth)
+                {
+                    error("CBOR nesting too deep");
+                }
+
+                uint8_t head = byte();
+                uint8_t major = head >> 5;
+                uint8_t info = head & 0x1F;
+
+                switch (major)
+                {
+                case 0:
+                    return std::make_shared<JsonNumber>(static_cast<double>(argument(info)));
+                case 1:
+                {
+                    uint64_t n = argument(info);
+                    return std::make_shared<JsonNumber>(-1.0 - static_cast<double>(n));
+                }
+                case 3:
+                    return std::make_shared<JsonString>(text_value(3, argument(info)));
+                case 4:
+                {
+                    auto array = std::make_shared<JsonArray>();
+                    uint64_t count = argument(info);
+                    if (count == indefinite)
+                    {
+                        while (!at_break())
+                            array->insert(value(depth + 1));
+                    }
+                    else
+                    {
+                        if (count > size - pos)
+                            error("CBOR array length exceeds input");
+                        array->elements.reserve(static_cast<size_t>(count));
+                        for (uint64_t i = 0; i < count; ++i)
+                            array->insert(value(depth + 1));
+                    }
+                    return array;
+                }
+                case 5:
+                {
+                    auto object = std::make_shared<JsonObject>();
+                    uint64_t count = argument(info);
+                    if (count == indefinite)
+                    {
+                        while (!at_break())
+                        {
+                            auto name = key();
+                            object->insert(name, value(depth + 1));
+                        }
+                    }
+                    else
+                    {
+                        if (count > size - pos)
+                            error("CBOR map length exceeds input");
+                        for (uint64_t i = 0; i < count; ++i)
+                        {
+                            auto name = key();
+                            object->insert(name, value(depth + 1));
+                        }
+                    }
+                    return object;
+                }
+                case 6:
+                    // Tags carry no JSON meaning; decode the tagged item
+                    argument(info);
+                    return value(depth + 1);
+                case 7:
+                    switch (info)
+                    {
+                    case 20:
+                        return std::make_shared<JsonBoolean>(false);
+                    case 21:
+                        return std::make_shared<JsonBoolean>(true);
+                    case 22:
+                    case 23:
+                        return nullptr;
+                    case 25:
+                        return number(half_to_double(static_cast<uint16_t>(be(2))));
+                    case 26:
+                        return number(f32());
+                    case 27:
+                        return number(f64());
+                    default:
+                        break;
+                    }
+                    error("Unsupported CBOR simple value");
+                default:
+                    error("Unsupported CBOR major type " + std::to_string(major));
+                }
+            }
+        };
+
+        // ---------------------------------------------------------- MessagePack
+
+        void msgpack_string(std::string &out, std::string_view str)
+        {
+            size_t size = str.size();
+            if (size < 32)
+            {
+                out.push_back(static_cast<char>(0xA0 | size));
+            }
+            else if (size <= 0xFF)
+            {
+                out.push_back(static_cast<char>(0xD9));
+                put_be(out, size, 1);
+            }
+            else if (size <= 0xFFFF)
+            {
+                out.push_back(static_cast<char>(0xDA));
+                put_be(out, size, 2);
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xDB));
+                put_be(out, size, 4);
+            }
+            out.append(str);
+        }
+
+        void msgpack_container(std::string &out, size_t size, uint8_t fix, uint8_t marker16)
+        {
+            if (size < 16)
+            {
+                out.push_back(static_cast<char>(fix | size));
+            }
+            else if (size <= 0xFFFF)
+            {
+                out.push_back(static_cast<char>(marker16));
+                put_be(out, size, 2);
+            }
+            else
+            {
+                out.push_back(static_cast<char>(marker16 + 1));
+                put_be(out, size, 4);
+            }
+        }
+
+        void msgpack_integer(std::string &out, int64_t value)
+        {
+            if (value >= 0)
+            {
+                if (value < 128)
+                {
+                    out.push_back(static_cast<char>(value));
+                }
+                else if (value <= 0xFF)
+                {
+                    out.push_back(static_cast<char>(0xCC));
+                    put_be(out, static_cast<uint64_t>(value), 1);
+                }
+                else if (value <= 0xFFFF)
+                {
+                    out.push_back(static_cast<char>(0xCD));
+                    put_be(out, static_cast<uint64_t>(value), 2);
+                }
+                else if (value <= 0xFFFFFFFFll)
+                {
+                    out.push_back(static_cast<char>(0xCE));
+                    put_be(out, static_cast<uint64_t>(value), 4);
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(0xCF));
+                    put_be(out, static_cast<uint64_t>(value), 8);
+                }
+            }
+            else if (value >= -32)
+            {
+                out.push_back(static_cast<char>(value));
+            }
+            else if (value >= -128)
+            {
+                out.push_back(static_cast<char>(0xD0));
+                put_be(out, static_cast<uint64_t>(value), 1);
+            }
+            else if (value >= -32768)
+            {
+                out.push_back(static_cast<char>(0xD1));
+                put_be(out, static_cast<uint64_t>(value), 2);
+            }
+            else if (value >= -2147483648ll)
+            {
+                out.push_back(static_cast<char>(0xD2));
+                put_be(out, static_cast<uint64_t>(value), 4);
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xD3));
+                put_be(out, static_cast<uint64_t>(value), 8);
+            }
+        }
+
+        void msgpack_encode(const std::shared_ptr<JsonObject> &value, std::string &out)
+        {
+            switch (getter::get_type(value))
+            {
+            case JsonType::Null:
+                out.push_back(static_cast<char>(0xC0));
+                break;
+            case JsonType::Boolean:
+                out.push_back(static_cast<char>(static_cast<const JsonBoolean &>(*value).value ? 0xC3 : 0xC2));
+                break;
+            case JsonType::Number:
+            {
+                double number = static_cast<const JsonNumber &>(*value).number();
+                if (encodes_as_integer(number))
+                {
+                    msgpack_integer(out, static_cast<int64_t>(number));
+                }
+                else if (fits_float(number))
+                {
+                    out.push_back(static_cast<char>(0xCA));
+                    put_be(out, float_bits(static_cast<float>(number)), 4);
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(0xCB));
+                    put_be(out, double_bits(number), 8);
+                }
+                break;
+            }
+            case JsonType::String:
+                msgpack_string(out, static_cast<const JsonString &>(*value).view());
+                break;
+            case JsonType::Array:
+            {
+                const auto &elements = static_cast<const JsonArray &>(*value).elements;
+                msgpack_container(out, elements.size(), 0x90, 0xDC);
+                for (const auto &element : elements)
+                {
+                    msgpack_encode(element, out);
+                }
+                break;
+            }
+            case JsonType::Object:
+            {
+                const auto &data = value->get_data();
+                msgpack_container(out, data.size(), 0x80, 0xDE);
+                std::string scratch;
+                for (const auto &[key, item] : data)
+                {
+                    msgpack_string(out, wire_key(key, scratch));
+                    msgpack_encode(item, out);
+                }
+                break;
+            }
+            }
+        }
+
+        struct MsgpackDecoder : Reader
+        {
+            int64_t signed_be(int bytes)
+            {
+                uint64_t raw = be(bytes);
+                int shift = 64 - bytes * 8;
+                return static_cast<int64_t>(raw << shift) >> shift;
+            }
+
+            std::string key()
+            {
+                uint8_t head = byte();
+                if ((head & 0xE0) == 0xA0)
+                    return stored_key(text(head & 0x1F));
+                if (head == 0xD9)
+                    return stored_key(text(be(1)));
+                if (head == 0xDA)
+                    return stored_key(text(be(2)));
+                if (head == 0xDB)
+                    return stored_key(text(be(4)));
+                error("MessagePack map keys must be strings");
+            }
+
+            std::shared_ptr<JsonObject> array(uint64_t count, size_t depth)
+            {
+                if (count > size - pos)
+                    error("MessagePack array length exceeds input");
+                auto result = std::make_shared<JsonArray>();
+                result->elements.reserve(static_cast<size_t>(count));
+                for (uint64_t i = 0; i < count; ++i)
+                    result->insert(value(depth + 1));
+                return result;
+            }
+
+            std::shared_ptr<JsonObject> map(uint64_t count, size_t depth)
+            {
+                if (count > size - pos)
+                    error("MessagePack map length exceeds input");
+                auto result = std::make_shared<JsonObject>();
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    auto name = key();
+                    result->insert(name, value(depth + 1));
+                }
+                return result;
+            }
+
+            std::shared_ptr<JsonObject> value(size_t depth)
+            {
+                if (depth > max_binary_depth)
+                {
+                    error("MessagePack nesting too deep");
+                }
+
+                uint8_t head = byte();
+                if (head < 0x80)
+                    return std::make_shared<JsonNumber>(head);
+                if (head >= 0xE0)
+                    return std::make_shared<JsonNumber>(static_cast<int8_t>(head));
+                if ((head & 0xF0) == 0x80)
+                    return map(head & 0x0F, depth);
+                if ((head & 0xF0) == 0x90)
+                    return array(head & 0x0F, depth);
+                if ((head & 0xE0) == 0xA0)
+                    return std::make_shared<JsonString>(text(head & 0x1F));
+
+                switch (head)
+                {
+                case 0xC0:
+                    return nullptr;
+                case 0xC2:
+                    return std::make_shared<JsonBoolean>(false);
+                case 0xC3:
+                    return std::make_shared<JsonBoolean>(true);
+                case 0xCA:
+                    return number(f32());
+                case 0xCB:
+                    return number(f64());
+                case 0xCC:
+                    return std::make_shared<JsonNumber>(static_cast<double>(be(1)));
+                case 0xCD:
+                    return std::make_shared<JsonNumber>(static_cast<double>(be(2)));
+                case 0xCE:
+                    return std::make_shared<JsonNumber>(static_cast<double>(be(4)));
+                case 0xCF:
+                    return std::make_shared<JsonNumber>(static_cast<double>(be(8)));
+                case 0xD0:
+                    return std::make_shared<JsonNumber>(static_cast<double>(signed_be(1)));
+                case 0xD1:
+                    return std::make_shared<JsonNumber>(static_cast<double>(signed_be(2)));
+                case 0xD2:
+                    return std::make_shared<JsonNumber>(static_cast<double>(signed_be(4)));
+                case 0xD3:
+                    return std::make_shared<JsonNumber>(static_cast<double>(signed_be(8)));
+                case 0xD9:
+                    return std::make_shared<JsonString>(text(be(1)));
+                case 0xDA:
+                    return std::make_shared<JsonString>(text(be(2)));
+                case 0xDB:
+                    return std::make_shared<JsonString>(text(be(4)));
+                case 0xDC:
+                    return array(be(2), depth);
+                case 0xDD:
+                    return array(be(4), depth);
+                case 0xDE:
+                    return map(be(2), depth);
+                case 0xDF:
+                    return map(be(4), depth);
+                default:
+                    error("Unsupported MessagePack type");
+                }
+            }
+        };
+
+        template <typename Decoder>
+        std::shared_ptr<JsonObject> decode_all(const char *data, size_t size)
+        {
+            Decoder decoder{{reinterpret_cast<const unsigned char *>(data), size}};
+            auto result = decoder.value(0);
+            if (decoder.pos != size)
+            {
+                decoder.error("Trailing bytes after binary value");
+            }
+            return result;
+        }
+    }
+
+    namespace cbor
+    {
+        void encode(const std::shared_ptr<JsonObject> &value, std::string &out)
+        {
+            cbor_encode(value, out);
+        }
+
+        std::string encode(const std::shared_ptr<JsonObject> &value)
+        {
+            std::string out;
+            cbor_encode(value, out);
+            return out;
+        }
+
+        std::shared_ptr<JsonObject> decode(const char *data, size_t size)
+        {
+            return decode_all<CborDecoder>(data, size);
+        }
+
+        std::shared_ptr<JsonObject> decode(const std::string &data)
+        {
+            return decode_all<CborDecoder>(data.data(), data.size());
+        }
+    }
+
+    namespace msgpack
+    {
+        void encode(const std::shared_ptr<JsonObject> &value, std::string &out)
+        {
+            msgpack_encode(value, out);
+        }
+
+        std::string encode(const std::shared_ptr<JsonObject> &value)
+        {
+            std::string out;
+            msgpack_encode(value, out);
+            return out;
+        }
+
+        std::shared_ptr<JsonObject> decode(const char *data, size_t size)
+        {
+            return decode_all<MsgpackDecoder>(data, size);
+        }
+
+        std::shared_ptr<JsonObject> decode(const std::string &data)
+        {
+            return decode_all<MsgpackDecoder>(data.data(), data.size());
+        }
+    }
+}
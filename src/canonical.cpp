@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#include "../includes/canonical.hpp"
+#include "../includes/JsonArray.hpp"
+#include "../includes/JsonBoolean.hpp"
+#include "../includes/JsonNumber.hpp"
+#include "../includes/JsonString.hpp"
+#include "../includes/error.hpp"
+#include "../includes/hash.hpp"
+#include "../includes/utf8.hpp"
+
+namespace hh_json::canonical
+{
+    namespace
+    {
+        struct Member
+        {
+            std::string_view key; // decoded
+            const JsonObject *value;
+        };
+
+        // Buffered bytes handed to the hasher at a time
+        constexpr size_t hash_block = 4096;
+
+        // Code point starting at text[i]; a byte of invalid UTF-8 stands for itself
+        uint32_t decode(std::string_view text, size_t i)
+        {
+            auto byte = [&](size_t k)
+            { return static_cast<uint32_t>(static_cast<unsigned char>(text[i + k])); };
+            switch (utf8::sequence_length(text.data() + i, text.size() - i))
+            {
+            case 2:
+                return ((byte(0) & 0x1F) << 6) | (byte(1) & 0x3F);
+            case 3:
+                return ((byte(0) & 0x0F) << 12) | ((byte(1) & 0x3F) << 6) | (byte(2) & 0x3F);
+            case 4:
+                return ((byte(0) & 0x07) << 18) | ((byte(1) & 0x3F) << 12) | ((byte(2) & 0x3F) << 6) | (byte(3) & 0x3F);
+            default:
+                return byte(0);
+            }
+        }
+
+        // First UTF-16 code unit of a code point
+        uint32_t first_unit(uint32_t code_point)
+        {
+            return code_point < 0x10000 ? code_point : 0xD800 + ((code_point - 0x10000) >> 10);
+        }
+
+        // Key order of JCS: by UTF-16 code units. That is byte order of the UTF-8 except where
+        // a supplementary character meets one in U+E000..U+FFFF, so only the first differing
+        // code point needs decoding.
+        bool utf16_less(std::string_view a, std::string_view b)
+        {
+            size_t common = std::min(a.size(), b.size());
+            size_t i = 0;
+            while (i < common && a[i] == b[i])
+            {
+                ++i;
+            }
+            if (i == common)
+                return a.size() < b.size();
+            while (i > 0 && (static_cast<unsigned char>(a[i]) & 0xC0) == 0x80)
+            {
+                --i; // back to the start of the code point
+            }
+            uint32_t x = decode(a, i);
+            uint32_t y = decode(b, i);
+            if (first_unit(x) != first_unit(y))
+                return first_unit(x) < first_unit(y);
+            return x < y;
+        }
+
+        void append_string(std::string_view text, std::string &out)
+        {
+            static const char hex[] = "0123456789abcdef";
+            out += '"';
+            size_t run = 0; // start of the bytes not yet copied
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                auto c = static_cast<unsigned char>(text[i]);
+                if (c >= 0x20 && c != '"' && c != '\\')
+                    continue;
+                out.append(text.data() + run, i - run);
+                run = i + 1;
+                out += '\\';
+                switch (c)
+                {
+                case '"':
+                    out += '"';
+                    break;
+                case '\\':
+                    out += '\\';
+                    break;
+                case '\b':
+                    out += 'b';
+                    break;
+                case '\f':
+                    out += 'f';
+                    break;
+                case '\n':
+                    out += 'n';
+                    break;
+                case '\r':
+                    out += 'r';
+                    break;
+                case '\t':
+                    out += 't';
+                    break;
+                default:
+                    out += "u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+                }
+            }
+            out.append(text.data() + run, text.size() - run);
+            out += '"';
+        }
+
+        // Writes canonical text to out, or, with a hasher, streams it through out in blocks
+        class Writer
+        {
+        public:
+            Writer(std::string &out, hash::Xxh64 *hasher) : out(out), hasher(hasher) {}
+
+            void value(const JsonObject *node)
+            {
+                if (!node)
+                {
+                    out += "null";
+                    return;
+                }
+                switch (node->type())
+                {
+                case JsonType::Null:
+                    out += "null";
+                    break;
+                case JsonType::Boolean:
+                    out += static_cast<const JsonBoolean &>(*node).value ? "true" : "false";
+                    break;
+                case JsonType::Number:
+                    append_number(static_cast<const JsonNumber &>(*node).number(), out);
+                    break;
+                case JsonType::String:
+                    append_string(static_cast<const JsonString &>(*node).view(), out);
+                    break;
+                case JsonType::Array:
+                {
+                    out += '[';
+                    bool first = true;
+                    for (const auto &element : static_cast<const JsonArray &>(*node).elements)
+                    {
+                        if (!first)
+                            out += ',';
+                        first = false;
+                        value(element.get());
+                    }
+                    out += ']';
+                    break;
+                }
+                default:
+                    object(node->get_data());
+                }
+                flush();
+            }
+
+            void finish()
+            {
+                if (hasher)
+                {
+                    hasher->update(out);
+                    out.clear();
+                }
+            }
+
+        private:
+            void object(const std::unordered_map<std::string, std::shared_ptr<JsonObject>> &members)
+            {
+                // One scratch list per nesting level, reused by every object at that level
+                if (depth == scratch.size())
+                    scratch.emplace_back();
+                std::vector<Member> &sorted = scratch[depth];
+                sorted.clear();
+                size_t own_keys = decoded_keys.size(); // decoded keys of this object go after this
+                for (const auto &[key, item] : members)
+                {
+                    if (key.find('\\') == std::string::npos)
+                    {
+                        sorted.push_back({key, item.get()});
+                    }
+                    else
+                    {
+                        decoded_keys.push_back(detail::unescape_key(key));
+                        sorted.push_back({decoded_keys.back(), item.get()});
+                    }
+                }
+                std::sort(sorted.begin(), sorted.end(), [](const Member &a, const Member &b)
+                          { return utf16_less(a.key, b.key); });
+
+                out += '{';
+                ++depth;
+                for (size_t i = 0; i < sorted.size(); ++i)
+                {
+                    if (i)
+                        out += ',';
+                    append_string(sorted[i].key, out);
+                    out += ':';
+                    value(sorted[i].value);
+                }
+                --depth;
+                out += '}';
+                // Only the objects still open need their keys, so the storage follows the depth
+                decoded_keys.resize(own_keys);
+            }
+
+            void flush()
+            {
+                if (hasher && out.size() >= hash_block)
+                {
+                    hasher->update(out);
+                    out.clear();
+                }
+            }
+
+            std::string &out;
+            hash::Xxh64 *hasher;
+            std::deque<std::vector<Member>> scratch; // a deque so deeper levels can be added while in use
+            size_t depth = 0; // objects open around the current value
+            std::deque<std::string> decoded_keys; // escaped keys of the open objects; a deque keeps the views valid
+        };
+    }
+
+    void append_number(double number, std::string &out)
+    {
+        if (!std::isfinite(number))
+            HH_JSON_THROW(std::runtime_error("Number is not finite"));
+        if (number == 0)
+        {
+            out += '0'; // also -0
+            return;
+        }
+
+        // Shortest round-trip digits d.ddd and exponent; then laid out the ECMAScript way
+        char buffer[32];
+        auto printed = std::to_chars(buffer, buffer + sizeof(buffer), number, std::chars_format::scientific);
+        const char *p = buffer;
+        if (*p == '-')
+        {
+            out += '-';
+            ++p;
+        }
+        char digits[20];
+        int count = 0;
+        for (; *p != 'e'; ++p)
+        {
+            if (*p != '.')
+                digits[count++] = *p;
+        }
+        ++p;
+        bool negative_exponent = *p++ == '-';
+        int exponent = 0;
+        std::from_chars(p, printed.ptr, exponent);
+        int n = (negative_exponent ? -exponent : exponent) + 1; // value = 0.digits * 10^n
+
+        if (count <= n && n <= 21)
+        {
+            out.append(digits, static_cast<size_t>(count));
+            out.append(static_cast<size_t>(n - count), '0');
+        }
+        else if (0 < n && n <= 21)
+        {
+            out.append(digits, static_cast<size_t>(n));
+            out += '.';
+            out.append(digits + n, static_cast<size_t>(count - n));
+        }
+        else if (-6 < n && n <= 0)
+        {
+            out += "0.";
+            out.append(static_cast<size_t>(-n), '0');
+            out.append(digits, static_cast<size_t>(count));
+        }
+        else
+        {
+            out += digits[0];
+            if (count > 1)
+            {
+                out += '.';
+                out.append(digits + 1, static_cast<size_t>(count - 1));
+            }
+            out += n - 1 < 0 ? "e-" : "e+";
+            out += std::to_string(std::abs(n - 1));
+        }
+    }
+
+    void write(const std::shared_ptr<JsonObject> &value, std::string &out)
+    {
+        Writer(out, nullptr).value(value.get());
+    }
+
+    void write(const JsonObject &value, std::string &out)
+    {
+        Writer(out, nullptr).value(&value);
+    }
+
+    std::string stringify(const std::shared_ptr<JsonObject> &value)
+    {
+        std::string out;
+        write(value, out);
+        return out;
+    }
+
+    std::string stringify(const JsonObject &value)
+    {
+        std::string out;
+        write(value, out);
+        return out;
+    }
+
+    namespace
+    {
+        uint64_t hash_node(const JsonObject *node, uint64_t seed)
+        {
+            hash::Xxh64 hasher(seed);
+            std::string buffer;
+            buffer.reserve(hash_block + 256);
+            Writer writer(buffer, &hasher);
+            writer.value(node);
+            writer.finish();
+            return hasher.digest();
+        }
+    }
+
+    uint64_t hash(const std::shared_ptr<JsonObject> &value, uint64_t seed)
+    {
+        return hash_node(value.get(), seed);
+    }
+
+    uint64_t hash(const JsonObject &value, uint64_t seed)
+    {
+        return hash_node(&value, seed);
+    }
+}
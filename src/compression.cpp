@@ -0,0 +1,533 @@
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if HH_JSON_ZLIB
+#include <zlib.h>
+#endif
+#if HH_JSON_ZSTD
+#include <zstd.h>
+#endif
+
+#include "../includes/compression.hpp"
+
+namespace hh_json::compression
+{
+    namespace
+    {
+        // Decompressed bytes produced per library call
+        constexpr size_t window_size = 64 * 1024;
+
+#if HH_JSON_ZLIB
+        constexpr bool has_zlib = true;
+#else
+        constexpr bool has_zlib = false;
+#endif
+#if HH_JSON_ZSTD
+        constexpr bool has_zstd = true;
+#else
+        constexpr bool has_zstd = false;
+#endif
+
+        const char *name(Format format)
+        {
+            switch (format)
+            {
+            case Format::Gzip:
+                return "gzip";
+            case Format::Zstd:
+                return "zstd";
+            default:
+                return "plain";
+            }
+        }
+    }
+
+    bool available(Format format)
+    {
+        switch (format)
+        {
+        case Format::Gzip:
+            return has_zlib;
+        case Format::Zstd:
+            return has_zstd;
+        default:
+            return true;
+        }
+    }
+
+    Format detect(std::string_view head)
+    {
+        auto byte = [&](size_t i)
+        { return static_cast<unsigned char>(head[i]); };
+
+        if (head.size() >= 2 && byte(0) == 0x1f && byte(1) == 0x8b)
+        {
+            return Format::Gzip;
+        }
+        if (head.size() >= 4 && byte(0) == 0x28 && byte(1) == 0xb5 && byte(2) == 0x2f && byte(3) == 0xfd)
+        {
+            return Format::Zstd;
+        }
+        // zlib header: deflate method with a check value; no JSON text starts like this
+        if (head.size() >= 2 && (byte(0) & 0x0f) == 8 && ((byte(0) << 8) | byte(1)) % 31 == 0)
+        {
+            return Format::Gzip;
+        }
+        return Format::Plain;
+    }
+
+    struct Decompressor::State
+    {
+        Format format;
+        std::string error;
+        std::vector<char> window;
+        bool boundary = true;
+#if HH_JSON_ZLIB
+        z_stream zlib{};
+        bool ended = false; // the current gzip member is complete
+#endif
+#if HH_JSON_ZSTD
+        ZSTD_DStream *zstd = nullptr;
+#endif
+
+        explicit State(Format format) : format(format)
+        {
+            if (format == Format::Auto)
+            {
+                HH_JSON_THROW(std::runtime_error("Decompressor: the format must be known"));
+            }
+            if (!available(format))
+            {
+                HH_JSON_THROW(std::runtime_error(std::string("Decompressor: ") + name(format) + " support is not built in"));
+            }
+            if (format != Format::Plain)
+            {
+                window.resize(window_size);
+            }
+#if HH_JSON_ZLIB
+            // 15 + 32: largest window, gzip or zlib header detected automatically
+            if (format == Format::Gzip && inflateInit2(&zlib, 15 + 32) != Z_OK)
+            {
+                HH_JSON_THROW(std::runtime_error("Decompressor: zlib initialization failed"));
+            }
+#endif
+#if HH_JSON_ZSTD
+            if (format == Format::Zstd)
+            {
+                zstd = ZSTD_createDStream();
+                if (!zstd || ZSTD_isError(ZSTD_initDStream(zstd)))
+                {
+                    ZSTD_freeDStream(zstd);
+                    HH_JSON_THROW(std::runtime_error("Decompressor: zstd initialization failed"));
+                }
+            }
+#endif
+        }
+
+        ~State()
+        {
+#if HH_JSON_ZLIB
+            if (format == Format::Gzip)
+            {
+                inflateEnd(&zlib);
+            }
+#endif
+#if HH_JSON_ZSTD
+            ZSTD_freeDStream(zstd);
+#endif
+        }
+
+        State(const State &) = delete;
+        State &operator=(const State &) = delete;
+
+        bool fail(const char *reason)
+        {
+            error = reason ? reason : "corrupt data";
+            return false;
+        }
+
+#if HH_JSON_ZLIB
+        bool inflate_into(std::string_view input, std::string &out)
+        {
+            while (!input.empty())
+            {
+                if (ended)
+                {
+                    // Another gzip member follows the one that ended
+                    inflateReset(&zlib);
+                    ended = false;
+                }
+                auto piece = static_cast<uInt>(std::min<size_t>(input.size(), 1u << 30));
+                zlib.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+                zlib.avail_in = piece;
+                int code = Z_OK;
+                // A full window may leave output pending inside zlib even with no input left
+                while (code == Z_OK && (zlib.avail_in > 0 || zlib.avail_out == 0))
+                {
+                    zlib.next_out = reinterpret_cast<Bytef *>(window.data());
+                    zlib.avail_out = static_cast<uInt>(window.size());
+                    code = inflate(&zlib, Z_NO_FLUSH);
+                    out.append(window.data(), window.size() - zlib.avail_out);
+                }
+                if (code != Z_OK && code != Z_STREAM_END && code != Z_BUF_ERROR)
+                {
+                    return fail(zlib.msg);
+                }
+                ended = code == Z_STREAM_END;
+                boundary = ended;
+                input.remove_prefix(piece - zlib.avail_in);
+                if (!ended && zlib.avail_in > 0)
+                {
+                    return fail("inflate made no progress");
+                }
+            }
+            return true;
+        }
+#endif
+
+#if HH_JSON_ZSTD
+        bool decompress_into(std::string_view input, std::string &out)
+        {
+            ZSTD_inBuffer in{input.data(), input.size(), 0};
+            ZSTD_outBuffer window_out{window.data(), window.size(), 0};
+            do
+            {
+                window_out.pos = 0;
+                size_t code = ZSTD_decompressStream(zstd, &window_out, &in);
+                if (ZSTD_isError(code))
+                {
+                    return fail(ZSTD_getErrorName(code));
+                }
+                out.append(window.data(), window_out.pos);
+                // 0 means a frame was completed and fully flushed
+                boundary = code == 0;
+            } while (in.pos < in.size || window_out.pos == window_out.size);
+            return true;
+        }
+#endif
+    };
+
+    Decompressor::Decompressor(Format format) : state(std::make_unique<State>(format)) {}
+    Decompressor::~Decompressor() = default;
+    Decompressor::Decompressor(Decompressor &&) noexcept = default;
+    Decompressor &Decompressor::operator=(Decompressor &&) noexcept = default;
+
+    bool Decompressor::write(std::string_view input, std::string &out)
+    {
+        if (!state->error.empty())
+        {
+            return false;
+        }
+        switch (state->format)
+        {
+#if HH_JSON_ZLIB
+        case Format::Gzip:
+            return state->inflate_into(input, out);
+#endif
+#if HH_JSON_ZSTD
+        case Format::Zstd:
+            return state->decompress_into(input, out);
+#endif
+        default:
+            out.append(input);
+            return true;
+        }
+    }
+
+    bool Decompressor::at_boundary() const
+    {
+        return state->boundary;
+    }
+
+    const std::string &Decompressor::error() const
+    {
+        return state->error;
+    }
+
+    namespace
+    {
+        // Takes one decompressed block; false stops reading
+        using BlockSink = std::function<bool(std::string &block)>;
+
+        // Reads in block by block and hands each non-empty decompressed block to sink, which may
+        // swap the string for another buffer. Returns the error that ended the input, if any;
+        // a decompression error carries the offset of the compressed block it was found in.
+        ParseError pump(std::istream &in, const PipelineOptions &pipeline, const BlockSink &sink)
+        {
+            // At least enough for the magic bytes
+            std::string input(std::max<size_t>(pipeline.block_size, 16), '\0');
+            std::string out;
+            std::optional<Decompressor> decompressor;
+            size_t offset = 0;
+            while (in)
+            {
+                in.read(&input[0], static_cast<std::streamsize>(input.size()));
+                auto got = static_cast<size_t>(in.gcount());
+                if (in.bad())
+                {
+                    return ParseError{ParseErrc::ReadFailed, offset, {}};
+                }
+                if (got == 0)
+                {
+                    break;
+                }
+
+                std::string_view block(input.data(), got);
+                if (!decompressor)
+                {
+                    Format format = pipeline.format == Format::Auto ? detect(block) : pipeline.format;
+                    if (!available(format))
+                    {
+                        return ParseError{ParseErrc::DecompressionFailed, 0, std::string(name(format)) + " support is not built in"};
+                    }
+                    decompressor.emplace(format);
+                }
+                bool intact = decompressor->write(block, out);
+                // What came out before any damage is still handed on
+                if (!out.empty())
+                {
+                    if (!sink(out))
+                    {
+                        return ParseError{};
+                    }
+                    out.clear();
+                }
+                if (!intact)
+                {
+                    return ParseError{ParseErrc::DecompressionFailed, offset, decompressor->error()};
+                }
+                offset += got;
+            }
+            if (decompressor && !decompressor->at_boundary())
+            {
+                return ParseError{ParseErrc::DecompressionFailed, offset, "truncated input"};
+            }
+            return ParseError{};
+        }
+
+        // Decompressed blocks on their way from the reader thread to the parser. Both directions
+        // block: the reader when depth blocks are waiting, the parser when none are. Consumed
+        // strings come back as spares, so a steady stream reuses the same few buffers.
+        class BlockQueue
+        {
+        public:
+            explicit BlockQueue(size_t depth) : depth(std::max<size_t>(depth, 1)) {}
+
+            // Reader side: queues block and leaves a spare buffer in its place
+            bool push(std::string &block)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                space.wait(lock, [this]
+                           { return blocks.size() < depth || cancelled; });
+                if (cancelled)
+                {
+                    return false;
+                }
+                blocks.push_back(std::move(block));
+                block.clear();
+                if (!spares.empty())
+                {
+                    block = std::move(spares.back());
+                    spares.pop_back();
+                }
+                ready.notify_one();
+                return true;
+            }
+
+            // Reader side: no more blocks; error says why, if the input did not end cleanly
+            void close(ParseError error)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                failure = std::move(error);
+                closed = true;
+                ready.notify_one();
+            }
+
+            // Parser side: the next block, or false once the reader is done and all are taken
+            bool pop(std::string &block)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this]
+                           { return !blocks.empty() || closed; });
+                if (blocks.empty())
+                {
+                    return false;
+                }
+                if (block.capacity() != 0)
+                {
+                    block.clear();
+                    spares.push_back(std::move(block));
+                }
+                block = std::move(blocks.front());
+                blocks.pop_front();
+                space.notify_one();
+                return true;
+            }
+
+            // Parser side: stop the reader at its next block
+            void cancel()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                cancelled = true;
+                space.notify_one();
+            }
+
+            ParseError error()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return failure;
+            }
+
+        private:
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::condition_variable space;
+            std::deque<std::string> blocks;
+            std::vector<std::string> spares;
+            size_t depth;
+            bool closed = false;
+            bool cancelled = false;
+            ParseError failure;
+        };
+
+        // Runs the input through consume, block by block, with decompression on a reader thread
+        // unless pipeline.threaded is off. consume returns false once it wants no more.
+        ParseError drive(std::istream &in, const PipelineOptions &pipeline, const std::function<bool(std::string_view)> &consume)
+        {
+            if (!pipeline.threaded)
+            {
+                return pump(in, pipeline, [&consume](std::string &block)
+                            { return consume(block); });
+            }
+
+            BlockQueue queue(pipeline.queue_depth);
+            std::thread reader([&]
+                               { queue.close(pump(in, pipeline, [&queue](std::string &block)
+                                                  { return queue.push(block); })); });
+            // The reader must be stopped and joined however consume returns
+            struct Join
+            {
+                BlockQueue &queue;
+                std::thread &reader;
+                ~Join()
+                {
+                    queue.cancel();
+                    reader.join();
+                }
+            } join{queue, reader};
+
+            std::string block;
+            while (queue.pop(block))
+            {
+                if (!consume(block))
+                {
+                    return ParseError{};
+                }
+            }
+            return queue.error();
+        }
+
+        bool blank(std::string_view line)
+        {
+            return line.find_first_not_of(" \t\r") == std::string_view::npos;
+        }
+    }
+
+    Result<std::shared_ptr<JsonObject>> parse(std::istream &in, const ParseOptions &options, const PipelineOptions &pipeline)
+    {
+        IncrementalParser parser(options);
+        ParseError error = drive(in, pipeline, [&parser](std::string_view block)
+                                 { return parser.feed(block) == IncrementalParser::Status::NeedInput; });
+        if (parser.status() == IncrementalParser::Status::NeedInput)
+        {
+            if (error)
+            {
+                return error;
+            }
+            parser.finish();
+        }
+        return parser.result();
+    }
+
+    Result<size_t> read_ndjson(std::istream &in, const RecordHandler &on_record, const ParseOptions &options, const PipelineOptions &pipeline)
+    {
+        Parser parser(options);
+        std::string pending; // start of a line cut off by the end of a block
+        std::string line;
+        bool oversized = false; // pending outgrew options.max_size and stopped growing
+        size_t line_number = 0;
+        size_t records = 0;
+        bool stopped = false;
+
+        auto deliver = [&](std::string_view text)
+        {
+            ++line_number;
+            if (oversized)
+            {
+                oversized = false;
+                ++records;
+                return on_record(line_number, ParseError{ParseErrc::DocumentTooLarge, options.max_size, {}});
+            }
+            if (blank(text))
+            {
+                return true;
+            }
+            line.assign(text.data(), text.size());
+            ++records;
+            return on_record(line_number, parser.parse(line));
+        };
+
+        auto consume = [&](std::string_view block)
+        {
+            size_t start = 0;
+            for (size_t end = block.find('\n'); end != std::string_view::npos; end = block.find('\n', start))
+            {
+                bool more;
+                if (pending.empty() && !oversized)
+                {
+                    more = deliver(block.substr(start, end - start));
+                }
+                else
+                {
+                    pending.append(block.substr(start, end - start));
+                    more = deliver(pending);
+                    pending.clear();
+                }
+                start = end + 1;
+                if (!more)
+                {
+                    stopped = true;
+                    return false;
+                }
+            }
+            if (!oversized)
+            {
+                pending.append(block.substr(start));
+                if (pending.size() > options.max_size)
+                {
+                    // The line fails anyway; keep memory bounded until it ends
+                    oversized = true;
+                    pending.clear();
+                }
+            }
+            return true;
+        };
+
+        ParseError error = drive(in, pipeline, consume);
+        if (!stopped && (!pending.empty() || oversized))
+        {
+            deliver(pending); // last line without a newline
+        }
+        if (error)
+        {
+            return error;
+        }
+        return records;
+    }
+}
@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../includes/diff.hpp"
+#include "../includes/hash.hpp"
+#include "../includes/pointer.hpp"
+#include "../includes/healpers.hpp"
+
+namespace hh_json::patch
+{
+    namespace
+    {
+        // Largest LCS table built for an array; bigger changes fall back to positional diffs
+        constexpr size_t max_lcs_cells = size_t(1) << 22;
+
+        uint64_t mix(uint64_t x)
+        {
+            x ^= x >> 33;
+            x *= 0xFF51AFD7ED558CCDULL;
+            x ^= x >> 33;
+            x *= 0xC4CEB9FE1A85EC53ULL;
+            x ^= x >> 33;
+            return x;
+        }
+
+        std::shared_ptr<JsonObject> make_op(const char *op, const std::string &path)
+        {
+            auto operation = std::make_shared<JsonObject>();
+            operation->insert("op", maker::make_string(op));
+            operation->insert("path", maker::make_string(path));
+            return operation;
+        }
+
+        using NodePair = std::pair<const JsonObject *, const JsonObject *>;
+
+        struct NodePairHash
+        {
+            size_t operator()(const NodePair &pair) const
+            {
+                return static_cast<size_t>(mix(reinterpret_cast<uintptr_t>(pair.first) * 31 + reinterpret_cast<uintptr_t>(pair.second)));
+            }
+        };
+
+        class Differ
+        {
+        public:
+            Differ(SubtreeHasher &hasher) : hasher(hasher), ops(std::make_shared<JsonArray>()) {}
+
+            SubtreeHasher &hasher;
+            std::shared_ptr<JsonArray> ops;
+
+            void add(const std::string &path, const std::shared_ptr<JsonObject> &value)
+            {
+                auto op = make_op("add", path);
+                op->insert("value", value);
+                ops->insert(op);
+            }
+
+            void replace(const std::string &path, const std::shared_ptr<JsonObject> &value)
+            {
+                auto op = make_op("replace", path);
+                op->insert("value", value);
+                ops->insert(op);
+            }
+
+            void remove(const std::string &path)
+            {
+                ops->insert(make_op("remove", path));
+            }
+
+            void value(const std::shared_ptr<JsonObject> &from, const std::shared_ptr<JsonObject> &to, std::string &path)
+            {
+                if (same(from, to))
+                {
+                    return;
+                }
+
+                auto type = getter::get_type(from);
+                if (type != getter::get_type(to))
+                {
+                    replace(path, to);
+                }
+                else if (type == JsonType::Object)
+                {
+                    object(from, to, path);
+                }
+                else if (type == JsonType::Array)
+                {
+                    array(static_cast<const JsonArray &>(*from).elements, static_cast<const JsonArray &>(*to).elements, path);
+                }
+                else
+                {
+                    replace(path, to);
+                }
+            }
+
+        private:
+            // Different hashes prove a difference; equal ones are confirmed, since they can collide.
+            // Each pair is confirmed once: both trees outlive the diff, so their addresses stay put.
+            bool same(const std::shared_ptr<JsonObject> &a, const std::shared_ptr<JsonObject> &b)
+            {
+                if (a == b)
+                    return true;
+                if (hasher.hash(a) != hasher.hash(b))
+                    return false;
+                NodePair pair(a.get(), b.get());
+                if (confirmed.count(pair))
+                    return true;
+                if (!equals(a, b))
+                    return false;
+                confirmed.insert(pair);
+                return true;
+            }
+
+            std::unordered_set<NodePair, NodePairHash> confirmed; // hash matches already checked with equals()
+
+            void object(const std::shared_ptr<JsonObject> &from, const std::shared_ptr<JsonObject> &to, std::string &path)
+            {
+                const auto &a = from->get_data();
+                const auto &b = to->get_data();
+                size_t length = path.size();
+
+                // Sorted keys keep the emitted patch independent of hash map iteration order
+                std::vector<const std::string *> keys;
+                keys.reserve(a.size() + b.size());
+                for (const auto &entry : a)
+                    keys.push_back(&entry.first);
+                for (const auto &entry : b)
+                {
+                    if (!a.count(entry.first))
+                        keys.push_back(&entry.first);
+                }
+                std::sort(keys.begin(), keys.end(), [](const std::string *x, const std::string *y)
+                          { return *x < *y; });
+
+                for (const std::string *key : keys)
+                {
+                    // Pointers name the key's text, not the escaped form it is stored in
+                    pointer::append(path, key->find('\\') == std::string::npos ? *key : detail::unescape_key(*key));
+                    auto old_it = a.find(*key);
+                    auto new_it = b.find(*key);
+                    if (new_it == b.end())
+                        remove(path);
+                    else if (old_it == a.end())
+                        add(path, new_it->second);
+                    else
+                        value(old_it->second, new_it->second, path);
+                    path.resize(length);
+                }
+            }
+
+            void array(const std::vector<std::shared_ptr<JsonObject>> &a, const std::vector<std::shared_ptr<JsonObject>> &b,
+                       std::string &path)
+            {
+                // Trim the common prefix and suffix; only the middle needs aligning
+                size_t prefix = 0;
+                while (prefix < a.size() && prefix < b.size() && same(a[prefix], b[prefix]))
+                    ++prefix;
+                size_t suffix = 0;
+                while (suffix < a.size() - prefix && suffix < b.size() - prefix &&
+                       same(a[a.size() - 1 - suffix], b[b.size() - 1 - suffix]))
+                    ++suffix;
+
+                size_t m = a.size() - prefix - suffix;
+                size_t n = b.size() - prefix - suffix;
+                size_t length = path.size();
+                size_t k = prefix; // index in the array as patched so far
+
+                auto at = [&](size_t index) -> std::string &
+                {
+                    path.resize(length);
+                    pointer::append(path, std::to_string(index));
+                    return path;
+                };
+
+                if (m && n && (m + 1) * (n + 1) <= max_lcs_cells)
+                {
+                    std::vector<uint64_t> ha(m), hb(n);
+                    for (size_t i = 0; i < m; ++i)
+                        ha[i] = hasher.hash(a[prefix + i]);
+                    for (size_t j = 0; j < n; ++j)
+                        hb[j] = hasher.hash(b[prefix + j]);
+
+                    // lcs[i][j] = LCS length of ha[i..] and hb[j..]
+                    std::vector<uint32_t> lcs((m + 1) * (n + 1), 0);
+                    auto cell = [&](size_t i, size_t j) -> uint32_t &
+                    { return lcs[i * (n + 1) + j]; };
+                    for (size_t i = m; i-- > 0;)
+                    {
+                        for (size_t j = n; j-- > 0;)
+                        {
+                            cell(i, j) = ha[i] == hb[j] ? cell(i + 1, j + 1) + 1 : std::max(cell(i + 1, j), cell(i, j + 1));
+                        }
+                    }
+
+                    size_t i = 0, j = 0;
+                    while (i < m || j < n)
+                    {
+                        if (i < m && j < n && ha[i] == hb[j])
+                        {
+                            // Aligned by hash; value() confirms they are equal and diffs them if not
+                            value(a[prefix + i], b[prefix + j], at(k));
+                            ++i, ++j, ++k;
+                        }
+                        else if (i < m && j < n && cell(i + 1, j + 1) == cell(i, j))
+                        {
+                            // Neither element is part of the LCS: edit in place
+                            value(a[prefix + i], b[prefix + j], at(k));
+                            ++i, ++j, ++k;
+                        }
+                        else if (j == n || (i < m && cell(i + 1, j) >= cell(i, j + 1)))
+                        {
+                            remove(at(k));
+                            ++i;
+                        }
+                        else
+                        {
+                            add(at(k), b[prefix + j]);
+                            ++j, ++k;
+                        }
+                    }
+                }
+                else
+                {
+                    size_t common = std::min(m, n);
+                    for (size_t i = 0; i < common; ++i)
+                    {
+                        value(a[prefix + i], b[prefix + i], at(k++));
+                    }
+                    for (size_t i = common; i < m; ++i)
+                    {
+                        remove(at(k));
+                    }
+                    for (size_t j = common; j < n; ++j)
+                    {
+                        add(at(k++), b[prefix + j]);
+                    }
+                }
+                path.resize(length);
+            }
+        };
+    }
+
+    uint64_t SubtreeHasher::hash(const std::shared_ptr<JsonObject> &value)
+    {
+        auto type = getter::get_type(value);
+        uint64_t seed = static_cast<uint64_t>(type) + 1;
+        switch (type)
+        {
+        case JsonType::Null:
+            return mix(seed);
+        case JsonType::Boolean:
+            return mix(seed * 31 + static_cast<const JsonBoolean &>(*value).value);
+        case JsonType::Number:
+        {
+            double number = static_cast<const JsonNumber &>(*value).number();
+            if (number == 0)
+                number = 0; // -0 == 0
+            uint64_t bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            return mix(seed * 31 + bits);
+        }
+        case JsonType::String:
+            return hash::xxh64(static_cast<const JsonString &>(*value).view(), seed);
+        default:
+            break;
+        }
+
+        // A dead entry belonged to a freed node whose address has been reused
+        auto cached_it = cache.find(value.get());
+        if (cached_it != cache.end() && !cached_it->second.node.expired())
+        {
+            return cached_it->second.hash;
+        }
+
+        uint64_t result;
+        if (type == JsonType::Array)
+        {
+            hash::Xxh64 h(seed);
+            for (const auto &element : static_cast<const JsonArray &>(*value).elements)
+            {
+                uint64_t child = this->hash(element);
+                h.update(&child, sizeof(child));
+            }
+            result = h.digest();
+        }
+        else
+        {
+            // Commutative combination so member order does not matter
+            uint64_t sum = 0;
+            for (const auto &[key, item] : value->get_data())
+            {
+                sum += mix(hash::xxh64(key) ^ (this->hash(item) * 0x9E3779B97F4A7C15ULL));
+            }
+            result = mix(sum ^ (seed << 56) ^ value->get_data().size());
+        }
+        cache[value.get()] = Cached{value, result};
+        return result;
+    }
+
+    void SubtreeHasher::clear()
+    {
+        cache.clear();
+    }
+
+    size_t SubtreeHasher::cached() const
+    {
+        return cache.size();
+    }
+
+    std::shared_ptr<JsonArray> diff(const std::shared_ptr<JsonObject> &from, const std::shared_ptr<JsonObject> &to,
+                                    SubtreeHasher &hasher)
+    {
+        Differ differ(hasher);
+        std::string path;
+        differ.value(from, to, path);
+        return differ.ops;
+    }
+
+    std::shared_ptr<JsonArray> diff(const std::shared_ptr<JsonObject> &from, const std::shared_ptr<JsonObject> &to)
+    {
+        SubtreeHasher hasher;
+        return diff(from, to, hasher);
+    }
+
+    std::shared_ptr<JsonArray> diff(const snapshot::View &from, const snapshot::View &to)
+    {
+        return diff(from.materialize(), to.materialize());
+    }
+}
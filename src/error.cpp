@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include "../includes/error.hpp"
+
+namespace hh_json
+{
+    namespace detail
+    {
+        void fail(const char *message)
+        {
+            std::fprintf(stderr, "hh_json: %s\n", message);
+            std::abort();
+        }
+    }
+
+    const char *describe(ParseErrc code)
+    {
+        switch (code)
+        {
+        case ParseErrc::None:
+            return "No error";
+        case ParseErrc::UnexpectedEnd:
+            return "Unexpected end of input";
+        case ParseErrc::UnexpectedCharacter:
+            return "Unexpected character";
+        case ParseErrc::UnterminatedString:
+            return "Unterminated string";
+        case ParseErrc::InvalidNumber:
+            return "Invalid number format";
+        case ParseErrc::InvalidLiteral:
+            return "Expected 'true', 'false' or 'null'";
+        case ParseErrc::ExpectedKey:
+            return "Expected string key";
+        case ParseErrc::ExpectedColon:
+            return "Expected ':'";
+        case ParseErrc::ExpectedCommaOrBracket:
+            return "Expected ',' or ']'";
+        case ParseErrc::ExpectedCommaOrBrace:
+            return "Expected ',' or '}'";
+        case ParseErrc::UnterminatedArray:
+            return "Unterminated array";
+        case ParseErrc::UnterminatedObject:
+            return "Unterminated object";
+        case ParseErrc::RootNotObject:
+            return "JSON must start with an object";
+        case ParseErrc::SchemaViolation:
+            return "Schema violation";
+        case ParseErrc::DepthLimitExceeded:
+            return "Maximum nesting depth exceeded";
+        case ParseErrc::DocumentTooLarge:
+            return "Document exceeds the maximum size";
+        case ParseErrc::StringTooLong:
+            return "String exceeds the maximum length";
+        case ParseErrc::TooManyElements:
+            return "Document exceeds the maximum number of values";
+        case ParseErrc::InvalidEscape:
+            return "Invalid escape sequence";
+        case ParseErrc::InvalidUtf8:
+            return "Invalid UTF-8";
+        case ParseErrc::ControlCharacter:
+            return "Unescaped control character in string";
+        case ParseErrc::Cancelled:
+            return "Parse cancelled";
+        case ParseErrc::DecompressionFailed:
+            return "Compressed input is corrupt or truncated";
+        case ParseErrc::ReadFailed:
+            return "Reading the input failed";
+        }
+        return "Unknown error";
+    }
+
+    std::string ParseError::message() const
+    {
+        std::string result = describe(code);
+        if (code == ParseErrc::None)
+        {
+            return result;
+        }
+        result += " at position " + std::to_string(offset);
+        if (!detail.empty())
+        {
+            result += ": " + detail;
+        }
+        return result;
+    }
+}
@@ -0,0 +1,150 @@
+#include <cstring>
+
+#include "../includes/hash.hpp"
+
+namespace hh_json::hash
+{
+    namespace
+    {
+        constexpr uint64_t prime1 = 11400714785074694791ULL;
+        constexpr uint64_t prime2 = 14029467366897019727ULL;
+        constexpr uint64_t prime3 = 1609587929392839161ULL;
+        constexpr uint64_t prime4 = 9650029242287828579ULL;
+        constexpr uint64_t prime5 = 2870177450012600261ULL;
+
+        inline uint64_t rotl(uint64_t x, int r)
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        // Unaligned little-endian reads
+        inline uint64_t read64(const unsigned char *p)
+        {
+            uint64_t v = 0;
+            for (int i = 7; i >= 0; --i)
+                v = (v << 8) | p[i];
+            return v;
+        }
+
+        inline uint32_t read32(const unsigned char *p)
+        {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        inline uint64_t round(uint64_t acc, uint64_t input)
+        {
+            acc += input * prime2;
+            acc = rotl(acc, 31);
+            return acc * prime1;
+        }
+
+        inline uint64_t merge_round(uint64_t acc, uint64_t value)
+        {
+            acc ^= round(0, value);
+            return acc * prime1 + prime4;
+        }
+
+        // Consumes whole 32-byte stripes, returns the number of bytes consumed
+        size_t consume_stripes(uint64_t acc[4], const unsigned char *p, size_t size)
+        {
+            size_t consumed = 0;
+            while (size - consumed >= 32)
+            {
+                acc[0] = round(acc[0], read64(p + consumed));
+                acc[1] = round(acc[1], read64(p + consumed + 8));
+                acc[2] = round(acc[2], read64(p + consumed + 16));
+                acc[3] = round(acc[3], read64(p + consumed + 24));
+                consumed += 32;
+            }
+            return consumed;
+        }
+
+        uint64_t finalize(const uint64_t acc[4], uint64_t seed, uint64_t total, const unsigned char *tail, size_t size)
+        {
+            uint64_t h;
+            if (total >= 32)
+            {
+                h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+                h = merge_round(h, acc[0]);
+                h = merge_round(h, acc[1]);
+                h = merge_round(h, acc[2]);
+                h = merge_round(h, acc[3]);
+            }
+            else
+            {
+                h = seed + prime5;
+            }
+            h += total;
+
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8)
+            {
+                h ^= round(0, read64(tail + i));
+                h = rotl(h, 27) * prime1 + prime4;
+            }
+            if (i + 4 <= size)
+            {
+                h ^= static_cast<uint64_t>(read32(tail + i)) * prime1;
+                h = rotl(h, 23) * prime2 + prime3;
+                i += 4;
+            }
+            for (; i < size; ++i)
+            {
+                h ^= tail[i] * prime5;
+                h = rotl(h, 11) * prime1;
+            }
+
+            h ^= h >> 33;
+            h *= prime2;
+            h ^= h >> 29;
+            h *= prime3;
+            h ^= h >> 32;
+            return h;
+        }
+    }
+
+    uint64_t xxh64(const void *data, size_t size, uint64_t seed)
+    {
+        const auto *p = static_cast<const unsigned char *>(data);
+        uint64_t acc[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+        size_t consumed = consume_stripes(acc, p, size);
+        return finalize(acc, seed, size, p + consumed, size - consumed);
+    }
+
+    Xxh64::Xxh64(uint64_t seed) : seed(seed), acc{seed + prime1 + prime2, seed + prime2, seed, seed - prime1}
+    {
+    }
+
+    void Xxh64::update(const void *data, size_t size)
+    {
+        const auto *p = static_cast<const unsigned char *>(data);
+        total += size;
+
+        if (buffered + size < 32)
+        {
+            std::memcpy(buffer + buffered, p, size);
+            buffered += size;
+            return;
+        }
+
+        if (buffered)
+        {
+            size_t fill = 32 - buffered;
+            std::memcpy(buffer + buffered, p, fill);
+            consume_stripes(acc, buffer, 32);
+            p += fill;
+            size -= fill;
+            buffered = 0;
+        }
+
+        size_t consumed = consume_stripes(acc, p, size);
+        buffered = size - consumed;
+        std::memcpy(buffer, p + consumed, buffered);
+    }
+
+    uint64_t Xxh64::digest() const
+    {
+        return finalize(acc, seed, total, buffer, buffered);
+    }
+}
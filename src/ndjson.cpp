@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "../includes/ndjson.hpp"
+
+namespace hh_json::ndjson
+{
+    bool StringSink::write(const std::string_view *pieces, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            out.append(pieces[i].data(), pieces[i].size());
+        }
+        return true;
+    }
+
+    bool StreamSink::write(const std::string_view *pieces, size_t count)
+    {
+        for (size_t i = 0; i < count && out; ++i)
+        {
+            out.write(pieces[i].data(), static_cast<std::streamsize>(pieces[i].size()));
+        }
+        return static_cast<bool>(out);
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    bool FdSink::write(const std::string_view *pieces, size_t count)
+    {
+#ifdef IOV_MAX
+        constexpr size_t max_vectors = IOV_MAX < 1024 ? IOV_MAX : 1024;
+#else
+        constexpr size_t max_vectors = 16;
+#endif
+        iovec vectors[max_vectors];
+        size_t next = 0;   // first piece not yet in vectors
+        size_t offset = 0; // bytes of pieces[next] already written
+        while (next < count)
+        {
+            size_t used = 0;
+            for (size_t i = next; i < count && used < max_vectors; ++i)
+            {
+                size_t skip = i == next ? offset : 0;
+                vectors[used].iov_base = const_cast<char *>(pieces[i].data() + skip);
+                vectors[used].iov_len = pieces[i].size() - skip;
+                ++used;
+            }
+            ssize_t written = ::writev(fd, vectors, static_cast<int>(used));
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            // Skip what went out; a partial write resumes inside a piece
+            auto left = static_cast<size_t>(written);
+            while (next < count && left >= pieces[next].size() - offset)
+            {
+                left -= pieces[next].size() - offset;
+                offset = 0;
+                ++next;
+            }
+            offset += left;
+        }
+        return true;
+    }
+#endif
+
+    namespace detail
+    {
+        namespace
+        {
+            // Serializes documents [first, last) into out, one line each
+            void serialize_lines(const Serializer &serialize, size_t first, size_t last, std::string &out)
+            {
+                for (size_t i = first; i < last; ++i)
+                {
+                    serialize(i, out);
+                    out += '\n';
+                }
+            }
+
+            size_t write_serial(size_t count, const Serializer &serialize, Sink &sink, const WriteOptions &options)
+            {
+                std::string buffer;
+                size_t flushed = 0;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    serialize(i, buffer);
+                    buffer += '\n';
+                    if (buffer.size() >= options.write_size || i + 1 == count)
+                    {
+                        std::string_view piece(buffer);
+                        if (!sink.write(&piece, 1))
+                            return flushed;
+                        flushed = i + 1;
+                        buffer.clear();
+                    }
+                }
+                return flushed;
+            }
+
+            // Batches handed from the serializing threads to the writing (calling) thread
+            class Exchange
+            {
+            public:
+                Exchange(size_t count, const Serializer &serialize, const WriteOptions &options, size_t window)
+                    : count(count), serialize(serialize), options(options), window(window),
+                      batches((count + options.batch - 1) / options.batch) {}
+
+                void serialize_batches()
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while (!stopped && claimed < batches)
+                    {
+                        if (claimed - written >= window)
+                        {
+                            space.wait(lock);
+                            continue;
+                        }
+                        size_t index = claimed++;
+                        std::string buffer;
+                        if (!spares.empty())
+                        {
+                            buffer = std::move(spares.back());
+                            spares.pop_back();
+                        }
+                        lock.unlock();
+
+                        size_t first = index * options.batch;
+                        serialize_lines(serialize, first, std::min(count, first + options.batch), buffer);
+
+                        lock.lock();
+                        ready_bytes += buffer.size();
+                        ready.emplace(index, std::move(buffer));
+                        done.notify_one();
+                    }
+                }
+
+                size_t write_batches(Sink &sink)
+                {
+                    std::vector<std::string> out;
+                    std::vector<std::string_view> pieces;
+                    size_t documents = 0;
+                    size_t out_documents = 0;
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while (written < batches)
+                    {
+                        // Wait for a large write's worth, unless nothing else is being serialized
+                        size_t in_flight = claimed - written;
+                        bool all_ready = ready.size() == in_flight && (claimed == batches || in_flight == window);
+                        if (ready.empty() || (ready_bytes < options.write_size && !all_ready))
+                        {
+                            done.wait(lock);
+                            continue;
+                        }
+
+                        for (auto it = ready.begin(); it != ready.end();)
+                        {
+                            if (options.ordered && it->first != written + out.size())
+                                break;
+                            ready_bytes -= it->second.size();
+                            out_documents += std::min(options.batch, count - it->first * options.batch);
+                            out.push_back(std::move(it->second));
+                            it = ready.erase(it);
+                        }
+                        if (out.empty())
+                        {
+                            done.wait(lock);
+                            continue;
+                        }
+                        lock.unlock();
+
+                        pieces.assign(out.begin(), out.end());
+                        bool ok = sink.write(pieces.data(), pieces.size());
+                        for (auto &buffer : out)
+                        {
+                            buffer.clear();
+                        }
+
+                        lock.lock();
+                        if (!ok)
+                            break;
+                        written += out.size();
+                        documents += out_documents;
+                        out_documents = 0;
+                        for (auto &buffer : out)
+                        {
+                            spares.push_back(std::move(buffer));
+                        }
+                        out.clear();
+                        space.notify_all();
+                    }
+                    stopped = true;
+                    space.notify_all();
+                    return documents;
+                }
+
+            private:
+                const size_t count;
+                const Serializer &serialize;
+                const WriteOptions &options;
+                const size_t window;
+                const size_t batches;
+
+                std::mutex mutex;
+                std::condition_variable done;  // a batch was serialized
+                std::condition_variable space; // a batch was written, or writing stopped
+                std::map<size_t, std::string> ready;
+                std::vector<std::string> spares;
+                size_t ready_bytes = 0;
+                size_t claimed = 0;
+                size_t written = 0;
+                bool stopped = false;
+            };
+        }
+
+        size_t write(size_t count, const Serializer &serialize, Sink &sink, const WriteOptions &options)
+        {
+            WriteOptions effective = options;
+            effective.batch = std::max<size_t>(effective.batch, 1);
+            size_t threads = effective.threads ? effective.threads : std::max(1u, std::thread::hardware_concurrency());
+            threads = std::min(threads, (count + effective.batch - 1) / effective.batch);
+            if (threads <= 1)
+                return write_serial(count, serialize, sink, effective);
+
+            // A few batches per thread keep everyone busy while one batch waits for its turn
+            Exchange exchange(count, serialize, effective, threads * 4);
+            std::vector<std::thread> workers;
+            workers.reserve(threads);
+            for (size_t i = 0; i < threads; ++i)
+            {
+                workers.emplace_back([&exchange]
+                                     { exchange.serialize_batches(); });
+            }
+            size_t documents = exchange.write_batches(sink);
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+            return documents;
+        }
+    }
+}
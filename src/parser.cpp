@@ -1,8 +1,12 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <typeinfo>
 #include <vector>
-#include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "../includes/parser.hpp"
@@ -11,6 +15,10 @@
 #include "../includes/JsonString.hpp"
 #include "../includes/JsonNumber.hpp"
 #include "../includes/JsonBoolean.hpp"
+#include "../includes/SchemaValidator.hpp"
+#include "../includes/error.hpp"
+#include "../includes/utf8.hpp"
+#include "../includes/stats.hpp"
 
 namespace hh_json
 {
@@ -24,453 +32,1604 @@ namespace hh_json
                   str.end());
     }
 
+    namespace
+    {
+        // Writes str without the whitespace outside string literals to result. origin, when
+        // given, gets the offset in str of each character written.
+        void remove_spaces_into(const std::string &str, std::string &result, std::vector<size_t> *origin = nullptr)
+        {
+            bool in_string = false;
+            result.clear();
+            result.reserve(str.length()); // Pre-allocate memory for efficiency
+
+            for (size_t i = 0; i < str.length(); ++i)
+            {
+                if (str[i] == '\"' && (i == 0 || str[i - 1] != '\\'))
+                {
+                    in_string = !in_string;
+                    result.push_back(str[i]);
+                }
+                else if (!in_string && std::isspace(static_cast<unsigned char>(str[i])))
+                {
+                    continue;
+                }
+                else
+                {
+                    result.push_back(str[i]);
+                }
+                if (origin)
+                    origin->push_back(i);
+            }
+        }
+
+        // Writes str with each // comment replaced by a space to result. origin, when given,
+        // gets the offset in str of each character written (a comment's '/' for its space).
+        void erase_comments_into(const std::string &str, std::string &result, std::vector<size_t> *origin = nullptr)
+        {
+            result.clear();
+            result.reserve(str.length()); // Pre-allocate for efficiency
+            bool in_string = false;
+
+            for (size_t i = 0; i < str.length(); ++i)
+            {
+                if (origin)
+                    origin->push_back(i);
+                if (str[i] == '\"' && (i == 0 || str[i - 1] != '\\'))
+                {
+                    in_string = !in_string;
+                    result.push_back(str[i]);
+                }
+                else if (!in_string && str[i] == '/' && i + 1 < str.length() && str[i + 1] == '/')
+                {
+                    // Skip the comment to end of line
+                    while (i < str.length() && str[i] != '\n')
+                    {
+                        ++i;
+                    }
+                    // Add a space in place of the comment
+                    result.push_back(' ');
+                }
+                else
+                {
+                    result.push_back(str[i]);
+                }
+            }
+        }
+
+        // Leaves input trimmed, without whitespace and comments, in text. scratch holds the
+        // intermediate pass; both keep their capacity for the next call.
+        void preprocess(const std::string &input, std::string &text, std::string &scratch)
+        {
+            text.assign(input);
+            trim(text);
+            remove_spaces_into(text, scratch);
+            erase_comments_into(scratch, text);
+        }
+
+        // Maps an offset in the text preprocess() makes of input back to the offset in input.
+        // Only errors need this, so the passes are redone here instead of tracked on every parse.
+        size_t input_offset(const std::string &input, size_t offset)
+        {
+            size_t lead = 0;
+            while (lead < input.size() && std::isspace(static_cast<unsigned char>(input[lead])))
+            {
+                ++lead;
+            }
+            std::string trimmed = input;
+            trim(trimmed);
+
+            std::string spaced, text;
+            std::vector<size_t> kept, uncommented;
+            remove_spaces_into(trimmed, spaced, &kept);
+            erase_comments_into(spaced, text, &uncommented);
+            if (offset >= text.size())
+            {
+                return lead + trimmed.size(); // the end of the document
+            }
+            return lead + kept[uncommented[offset]];
+        }
+    }
+
     // favor space over time, as we parse in O of N time, and O of N space (take copy of the string)
     void remove_spaces_not_in_string_literals(std::string &str)
     {
-        bool in_string = false;
         std::string result;
-        result.reserve(str.length()); // Pre-allocate memory for efficiency
+        remove_spaces_into(str, result);
+        str = std::move(result); // Use move for efficiency
+    }
+
+    // favor space over time, as we parse in O of N time, and O of N space (take copy of the string)
+    void erase_comments(std::string &str)
+    {
+        std::string result;
+        erase_comments_into(str, result);
+        str = std::move(result); // Use move for efficiency
+    }
+
+    namespace
+    {
+        // Open array or object on the explicit parse stack
+        struct Frame
+        {
+            std::shared_ptr<JsonObject> value;
+            bool is_array;
+            uint32_t node;  // schema node of the container
+            size_t start;   // offset of its opening bracket in the whole input
+        };
+
+        // Where the parse loop stands between tokens
+        enum class Phase : uint8_t
+        {
+            Value,  // a value starts next
+            Open,   // just after '{' or '['
+            Member, // a key (objects) or element (arrays) starts next
+            Close,  // a value is complete; ',' or closing brackets follow
+            Done
+        };
+
+        enum class Step : uint8_t
+        {
+            Done,
+            Failed,
+            NeedInput, // stopped before a token cut off by the end of the input
+            NeedTime   // stopped at a value boundary when the step budget ran out
+        };
+
+        using Member = std::unordered_map<std::string, std::shared_ptr<JsonObject>>::node_type;
+
+        // Nodes and member entries of finished documents, handed out again by later parses.
+        // Everything in here is exclusively owned and empty, with its capacity kept.
+        struct NodePool
+        {
+            std::vector<std::shared_ptr<JsonObject>> objects;
+            std::vector<std::shared_ptr<JsonArray>> arrays;
+            std::vector<std::shared_ptr<JsonString>> strings;
+            std::vector<std::shared_ptr<JsonNumber>> numbers;
+            std::vector<std::shared_ptr<JsonBoolean>> booleans;
+            std::vector<Member> members;
+            std::vector<std::shared_ptr<JsonObject>> work; // traversal stack of recycle()
+        };
+
+        // Buffers one parse works in. The free functions use a fresh one per call; a Parser
+        // keeps its own so their capacity carries over to the next parse.
+        struct Workspace
+        {
+            std::string text;    // preprocessed input
+            std::string scratch; // intermediate preprocessing pass
+            std::vector<Frame> stack;
+            std::string key;
+            NodePool *pool = nullptr; // null allocates every node
+        };
+
+        // Input and position of one parse. Errors are recorded here instead of thrown so the
+        // try_* entry points never unwind; the message is only formatted if someone asks.
+        struct ParseContext
+        {
+            const std::string &str;
+            const ParseOptions &options;
+            // The optional validator checks each value against a compiled schema as soon as it is built
+            const SchemaValidator *validator;
+            // Shared copy of str when options.lazy_strings or lazy_numbers is set; lazy nodes point into it
+            std::shared_ptr<const std::string> source;
+            size_t pos = 0;
+            size_t values = 0;
+            std::vector<Frame> &stack;
+            std::string &key; // key of the member being parsed
+            NodePool *pool;
+            ParseError error;
+            HH_JSON_STATS_ONLY(stats::Stats *stats = nullptr;)
+
+            // Resumable state of the parse loop; the result is built under root
+            Phase phase = Phase::Value;
+            uint32_t node = SchemaValidator::unconstrained;
+            std::shared_ptr<JsonObject> root;
+
+            // Incremental parsing: str holds the input from offset base on, and unless final
+            // more may follow. A token cut off by the end of str then sets need_input and fails
+            // softly. scanned is how far the search for the end of a pending string got.
+            bool final = true;
+            bool need_input = false;
+            size_t base = 0;
+            size_t scanned = 0;
+
+            // Budget of an IncrementalParser step: stop before a value once pos reaches
+            // budget_end or, checked every few values, the deadline passes or cancel is set
+            bool budgeted = false;
+            bool timed = false;
+            size_t budget_end = 0;
+            unsigned ticks = 0;
+            std::chrono::steady_clock::time_point deadline;
+            const std::atomic<bool> *cancel = nullptr;
+
+            ParseContext(const std::string &str, const ParseOptions &options, const SchemaValidator *validator, Workspace &work)
+                : str(str), options(options), validator(validator), stack(work.stack), key(work.key), pool(work.pool) {}
+
+            // offset is in str
+            bool fail(ParseErrc code, size_t offset)
+            {
+                return fail_at(code, base + offset);
+            }
+
+            // position is in the whole input
+            bool fail_at(ParseErrc code, size_t position)
+            {
+                error.code = code;
+                error.offset = position;
+                return false;
+            }
+
+            Step stop(ParseErrc code, size_t offset)
+            {
+                fail(code, offset);
+                return Step::Failed;
+            }
+
+            bool wait()
+            {
+                need_input = true;
+                return false;
+            }
+        };
+
+        // Nesting deeper than this is rare; the stack grows past it on demand
+        constexpr size_t preallocated_depth = 64;
+
+        // Values parsed between looks at the clock and the cancel flag
+        constexpr unsigned budget_check_interval = 32;
+
+        // Whether the step should stop before the next value. Cancellation also sets the error.
+        bool out_of_budget(ParseContext &ctx)
+        {
+            // The first value is always parsed, so every step makes progress
+            if (++ctx.ticks == 1)
+            {
+                return false;
+            }
+            // A byte budget that reaches the end of the buffer is not spent there: what follows
+            // is more input, so running out of it is NeedInput rather than NeedTime
+            if (ctx.pos >= ctx.budget_end && ctx.budget_end < ctx.str.size())
+            {
+                return true;
+            }
+            if (ctx.ticks % budget_check_interval != 0)
+            {
+                return false;
+            }
+            if (ctx.cancel && ctx.cancel->load(std::memory_order_relaxed))
+            {
+                return !ctx.fail(ParseErrc::Cancelled, ctx.pos);
+            }
+            return ctx.timed && std::chrono::steady_clock::now() >= ctx.deadline;
+        }
+
+        // Bounds on what a pool keeps, so one outsized document does not pin its memory
+        constexpr size_t max_pooled_nodes = 1 << 16; // of each kind
+        constexpr size_t max_pooled_capacity = 4096; // string bytes, array elements, object buckets
+
+        // A node from the pool when it has one, otherwise a new one
+        template <typename T>
+        std::shared_ptr<T> make_node(ParseContext &ctx, std::vector<std::shared_ptr<T>> NodePool::*list)
+        {
+            if (ctx.pool && !(ctx.pool->*list).empty())
+            {
+                std::shared_ptr<T> node = std::move((ctx.pool->*list).back());
+                (ctx.pool->*list).pop_back();
+                return node;
+            }
+            HH_JSON_STATS_ONLY(++ctx.stats->allocations;)
+            return std::make_shared<T>();
+        }
+
+        template <typename T>
+        void keep(std::vector<std::shared_ptr<T>> &list, const std::shared_ptr<JsonObject> &node)
+        {
+            if (list.size() < max_pooled_nodes)
+            {
+                list.push_back(std::static_pointer_cast<T>(node));
+            }
+        }
+
+        // Empties the nodes of a tree into the pool. Subtrees still referenced from outside
+        // the tree are left to their other owners, as are node types the parser never makes.
+        void recycle(NodePool &pool, std::shared_ptr<JsonObject> root)
+        {
+            auto &work = pool.work;
+            work.push_back(std::move(root));
+            while (!work.empty())
+            {
+                std::shared_ptr<JsonObject> node = std::move(work.back());
+                work.pop_back();
+                if (!node || node.use_count() != 1)
+                {
+                    continue;
+                }
+
+                const std::type_info &type = typeid(*node);
+                if (type == typeid(JsonObject))
+                {
+                    while (Member member = node->extract_member())
+                    {
+                        work.push_back(std::move(member.mapped()));
+                        if (pool.members.size() < max_pooled_nodes)
+                        {
+                            member.key().clear();
+                            pool.members.push_back(std::move(member));
+                        }
+                    }
+                    if (node->get_data().bucket_count() > max_pooled_capacity)
+                    {
+                        node->reserve(0);
+                    }
+                    keep(pool.objects, node);
+                }
+                else if (type == typeid(JsonArray))
+                {
+                    auto &elements = static_cast<JsonArray &>(*node).elements;
+                    for (auto &element : elements)
+                    {
+                        work.push_back(std::move(element));
+                    }
+                    elements.clear();
+                    if (elements.capacity() > max_pooled_capacity)
+                    {
+                        elements.shrink_to_fit();
+                    }
+                    keep(pool.arrays, node);
+                }
+                else if (type == typeid(JsonString))
+                {
+                    auto &string = static_cast<JsonString &>(*node);
+                    string.clear();
+                    if (string.value.capacity() > max_pooled_capacity)
+                    {
+                        string.value.shrink_to_fit();
+                    }
+                    keep(pool.strings, node);
+                }
+                else if (type == typeid(JsonNumber))
+                {
+                    static_cast<JsonNumber &>(*node).clear();
+                    keep(pool.numbers, node);
+                }
+                else if (type == typeid(JsonBoolean))
+                {
+                    keep(pool.booleans, node);
+                }
+            }
+        }
+
+#if HH_JSON_STATS
+        // Finishes the stats of one parse and hands them out
+        void publish(stats::Stats &stats, const ParseOptions &options)
+        {
+            // build_ns was timed around the whole pass, scanning included
+            stats.build_ns -= std::min(stats.build_ns, stats.scan_ns);
+            if (options.stats)
+            {
+                *options.stats = stats;
+            }
+            stats::detail::report(stats);
+        }
+
+        // Publishes when the parse returns, failed or not
+        struct StatsPublisher
+        {
+            stats::Stats stats;
+            const ParseOptions &options;
+
+            explicit StatsPublisher(const ParseOptions &options) : options(options) {}
+            ~StatsPublisher()
+            {
+                publish(stats, options);
+            }
+        };
+
+#endif
+
+        // Skip whitespace
+        void skip_whitespace(const std::string &str, size_t &pos)
+        {
+            while (pos < str.length() && std::isspace(static_cast<unsigned char>(str[pos])))
+            {
+                ++pos;
+            }
+        }
+
+        // Four hex digits at pos, or -1
+        int32_t read_hex4(const char *data, size_t length, size_t pos)
+        {
+            if (pos + 4 > length)
+            {
+                return -1;
+            }
+            int32_t value = 0;
+            for (size_t i = pos; i < pos + 4; ++i)
+            {
+                char c = data[i];
+                value <<= 4;
+                if (c >= '0' && c <= '9')
+                    value |= c - '0';
+                else if (c >= 'a' && c <= 'f')
+                    value |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F')
+                    value |= c - 'A' + 10;
+                else
+                    return -1;
+            }
+            return value;
+        }
+
+        // Scans a string body from pos (just past the opening quote) up to its closing quote,
+        // validating escapes and raw UTF-8 and rejecting unescaped control characters. Decoded text is appended to out unless it is null.
+        // On success pos is at the closing quote; on failure error_at is where the problem is.
+        ParseErrc scan_string(const char *data, size_t length, size_t &pos, std::string *out, size_t &escapes, size_t &error_at)
+        {
+            while (pos < length)
+            {
+                // Copy the run of plain ASCII in one go; the scan is vectorized
+                size_t run = utf8::plain_prefix(data + pos, length - pos);
+                if (out)
+                {
+                    out->append(data + pos, run);
+                }
+                pos += run;
+                if (pos >= length)
+                {
+                    break;
+                }
+
+                char c = data[pos];
+                if (c == '\"')
+                {
+                    return ParseErrc::None;
+                }
+                // RFC 8259 section 7: control characters must be escaped
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    error_at = pos;
+                    return ParseErrc::ControlCharacter;
+                }
+
+                if (c != '\\')
+                {
+                    size_t n = utf8::sequence_length(data + pos, length - pos);
+                    if (n == 0)
+                    {
+                        error_at = pos;
+                        return ParseErrc::InvalidUtf8;
+                    }
+                    if (out)
+                    {
+                        out->append(data + pos, n);
+                    }
+                    pos += n;
+                    continue;
+                }
+
+                // Handle escape sequences
+                ++escapes;
+                error_at = pos;
+                if (++pos >= length)
+                {
+                    break;
+                }
+                char next = data[pos++];
+                char decoded;
+                switch (next)
+                {
+                case '\"':
+                    decoded = '\"';
+                    break;
+                case '\\':
+                    decoded = '\\';
+                    break;
+                case '/':
+                    decoded = '/';
+                    break;
+                case 'b':
+                    decoded = '\b';
+                    break;
+                case 'f':
+                    decoded = '\f';
+                    break;
+                case 'n':
+                    decoded = '\n';
+                    break;
+                case 'r':
+                    decoded = '\r';
+                    break;
+                case 't':
+                    decoded = '\t';
+                    break;
+                case 'u':
+                {
+                    int32_t unit = read_hex4(data, length, pos);
+                    if (unit < 0 || (unit >= 0xDC00 && unit <= 0xDFFF))
+                    {
+                        return ParseErrc::InvalidEscape;
+                    }
+                    pos += 4;
+                    uint32_t code_point = static_cast<uint32_t>(unit);
+                    if (unit >= 0xD800 && unit <= 0xDBFF)
+                    {
+                        // A high surrogate must be followed by an escaped low surrogate
+                        int32_t low = pos + 1 < length && data[pos] == '\\' && data[pos + 1] == 'u' ? read_hex4(data, length, pos + 2) : -1;
+                        if (low < 0xDC00 || low > 0xDFFF)
+                        {
+                            return ParseErrc::InvalidEscape;
+                        }
+                        pos += 6;
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + static_cast<uint32_t>(low - 0xDC00);
+                    }
+                    if (out)
+                    {
+                        utf8::append(*out, code_point);
+                    }
+                    continue;
+                }
+                default:
+                    return ParseErrc::InvalidEscape;
+                }
+                if (out)
+                {
+                    *out += decoded;
+                }
+            }
+
+            error_at = pos;
+            return ParseErrc::UnterminatedString;
+        }
+
+        // Incremental parsing: whether the string at pos is closed within the input so far.
+        // The search resumes where it stopped, so a long string arriving in many chunks is
+        // searched once. A pending string longer than max_string_length fails right away.
+        bool string_available(ParseContext &ctx)
+        {
+            const std::string &str = ctx.str;
+            size_t i = std::max(ctx.scanned, ctx.pos + 1);
+            while ((i = str.find_first_of("\"\\", i)) != std::string::npos)
+            {
+                if (str[i] == '\"')
+                {
+                    ctx.scanned = 0;
+                    return true;
+                }
+                if (i + 1 >= str.length())
+                {
+                    break; // the escaped character is still to come
+                }
+                i += 2;
+            }
+            ctx.scanned = std::min(i, str.length());
+            if (ctx.scanned - ctx.pos - 1 > ctx.options.max_string_length)
+            {
+                return ctx.fail(ParseErrc::StringTooLong, ctx.pos);
+            }
+            return ctx.wait();
+        }
+
+        // Parse a JSON string. With out set, escapes are decoded to UTF-8 into it; with out null
+        // the body is only validated. body receives the offset of the first byte after the quote.
+        bool parse_string(ParseContext &ctx, std::string *out, size_t &body, bool &escaped)
+        {
+            const std::string &str = ctx.str;
+            size_t &pos = ctx.pos;
+            if (str[pos] != '\"')
+            {
+                return ctx.fail(ParseErrc::UnexpectedCharacter, pos);
+            }
+            if (!ctx.final && !string_available(ctx))
+            {
+                return false;
+            }
+
+            size_t start = pos;
+            body = ++pos; // Skip opening quote
+            size_t error_at = pos;
+            size_t escapes = 0;
+            HH_JSON_STATS_ONLY(size_t capacity = out ? out->capacity() : 0;)
+            ParseErrc code = scan_string(str.data(), str.length(), pos, out, escapes, error_at);
+            if (code != ParseErrc::None)
+            {
+                return ctx.fail(code, error_at);
+            }
+            escaped = escapes != 0;
+            HH_JSON_STATS_ONLY(
+                ctx.stats->escapes += escapes;
+                if (out) {
+                    ctx.stats->bytes_copied += out->size();
+                    ctx.stats->allocations += out->capacity() != capacity;
+                })
+
+            // End of string; the encoded length bounds the decoded one
+            ++pos;
+            if (pos - start - 2 > ctx.options.max_string_length)
+            {
+                return ctx.fail(ParseErrc::StringTooLong, start);
+            }
+            return true;
+        }
+
+        bool parse_string(ParseContext &ctx, std::string &value)
+        {
+            size_t body;
+            bool escaped = false;
+            return parse_string(ctx, &value, body, escaped);
+        }
+
+        // Whether number text of this shape converts without error: strtod wants a digit in
+        // the mantissa and in an exponent, and cannot over- or underflow while the digit count
+        // plus the exponent stays well within a double's range
+        bool converts_cleanly(size_t mantissa_digits, bool has_exponent, std::string_view exponent_digits)
+        {
+            if (mantissa_digits == 0 || (has_exponent && exponent_digits.empty()) || exponent_digits.size() > 3)
+            {
+                return false;
+            }
+            size_t exponent = 0;
+            for (char digit : exponent_digits)
+            {
+                exponent = exponent * 10 + static_cast<size_t>(digit - '0');
+            }
+            return mantissa_digits + exponent < 290;
+        }
+
+        // Parse a JSON number
+        bool parse_number(ParseContext &ctx, std::shared_ptr<JsonObject> &out)
+        {
+            const std::string &str = ctx.str;
+            size_t &pos = ctx.pos;
+            size_t start = pos;
+
+            // Handle negative sign
+            if (pos < str.length() && str[pos] == '-')
+            {
+                ++pos;
+            }
+
+            // Parse digits before decimal point
+            size_t digits = pos;
+            while (pos < str.length() && std::isdigit(static_cast<unsigned char>(str[pos])))
+            {
+                ++pos;
+            }
+            size_t mantissa_digits = pos - digits;
+            // RFC 8259: at least one integer digit, and no leading zero before another digit
+            bool well_formed = mantissa_digits > 0 && !(str[digits] == '0' && mantissa_digits > 1);
+
+            // Parse decimal point and following digits
+            if (pos < str.length() && str[pos] == '.')
+            {
+                ++pos;
+                digits = pos;
+                while (pos < str.length() && std::isdigit(static_cast<unsigned char>(str[pos])))
+                {
+                    ++pos;
+                }
+                mantissa_digits += pos - digits;
+                well_formed = well_formed && pos > digits; // a fraction needs digits
+            }
+
+            // Parse exponent
+            bool has_exponent = false;
+            digits = pos;
+            if (pos < str.length() && (str[pos] == 'e' || str[pos] == 'E'))
+            {
+                has_exponent = true;
+                ++pos;
+
+                if (pos < str.length() && (str[pos] == '+' || str[pos] == '-'))
+                {
+                    ++pos;
+                }
+
+                digits = pos;
+                while (pos < str.length() && std::isdigit(static_cast<unsigned char>(str[pos])))
+                {
+                    ++pos;
+                }
+                well_formed = well_formed && pos > digits; // so does an exponent
+            }
+
+            if (pos >= str.length() && !ctx.final)
+            {
+                return ctx.wait(); // more digits may follow
+            }
+            // strtod takes forms JSON does not (01, 1., .5, 1.e5), so the grammar is checked here
+            if (!well_formed)
+            {
+                return ctx.fail(ParseErrc::InvalidNumber, start);
+            }
+
+            auto result = make_node(ctx, &NodePool::numbers);
+            size_t length = pos - start;
+
+            // Lazy numbers keep the slice when it is known to convert; anything that might be
+            // rejected is converted now, so errors are reported as without the option
+            if (ctx.options.lazy_numbers && ctx.source &&
+                converts_cleanly(mantissa_digits, has_exponent, std::string_view(str).substr(digits, pos - digits)))
+            {
+                result->assign_lazy(ctx.source, start, length);
+                out = std::move(result);
+                return true;
+            }
+
+            // Convert the number text to double, from a copy on the stack unless it is very long
+            bool converted;
+            {
+                HH_JSON_STATS_ONLY(stats::detail::Timer timer(ctx.stats->number_ns);)
+                converted = JsonNumber::convert(std::string_view(str).substr(start, length), result->value);
+            }
+            if (!converted)
+            {
+                return ctx.fail(ParseErrc::InvalidNumber, start);
+            }
+
+            out = std::move(result);
+            return true;
+        }
+
+        // Parse true, false or null
+        bool parse_literal(ParseContext &ctx, std::shared_ptr<JsonObject> &out)
+        {
+            const std::string &str = ctx.str;
+            size_t &pos = ctx.pos;
+            const char *literal = str[pos] == 't' ? "true" : str[pos] == 'f' ? "false" : "null";
+            size_t length = std::strlen(literal);
+            if (str.compare(pos, length, literal) != 0)
+            {
+                size_t available = str.length() - pos;
+                if (!ctx.final && available < length && str.compare(pos, available, literal, available) == 0)
+                {
+                    return ctx.wait();
+                }
+                return ctx.fail(ParseErrc::InvalidLiteral, pos);
+            }
+
+            pos += length;
+            if (literal[0] == 'n')
+            {
+                out = nullptr; // nullptr for null values
+                return true;
+            }
+            auto value = make_node(ctx, &NodePool::booleans);
+            value->value = literal[0] == 't';
+            out = std::move(value);
+            return true;
+        }
+
+        // Type of the value starting with c, used to reject schema type mismatches before descending
+        JsonType peek_type(char c)
+        {
+            switch (c)
+            {
+            case '{':
+                return JsonType::Object;
+            case '[':
+                return JsonType::Array;
+            case '\"':
+                return JsonType::String;
+            case 't':
+            case 'f':
+                return JsonType::Boolean;
+            case 'n':
+                return JsonType::Null;
+            default:
+                return JsonType::Number;
+            }
+        }
+
+        // Stores a finished value in the innermost open container, or as the result at top level
+        void attach(ParseContext &ctx, std::shared_ptr<JsonObject> &out, std::string &key, std::shared_ptr<JsonObject> value)
+        {
+            if (ctx.stack.empty())
+            {
+                out = std::move(value);
+            }
+            else if (ctx.stack.back().is_array)
+            {
+                static_cast<JsonArray &>(*ctx.stack.back().value).insert(std::move(value));
+            }
+            else if (ctx.pool && !ctx.pool->members.empty())
+            {
+                Member member = std::move(ctx.pool->members.back());
+                ctx.pool->members.pop_back();
+                // The entry's old key buffer comes back in key, for the next member
+                member.key().swap(key);
+                member.mapped() = std::move(value);
+                if (Member unused = ctx.stack.back().value->insert_member(std::move(member)))
+                {
+                    unused.key().clear();
+                    ctx.pool->members.push_back(std::move(unused));
+                }
+            }
+            else
+            {
+                ctx.stack.back().value->insert(std::move(key), std::move(value));
+            }
+        }
+
+        // Positions the parser at the next member value of the innermost container: reads
+        // "key": for objects. Sets node to the schema of that value.
+        bool begin_member(ParseContext &ctx, std::string &key, uint32_t &node)
+        {
+            const std::string &str = ctx.str;
+            size_t &pos = ctx.pos;
+            const Frame &top = ctx.stack.back();
+
+            if (pos >= str.length() && !ctx.final)
+            {
+                return ctx.wait();
+            }
+
+            if (top.is_array)
+            {
+                if (pos >= str.length())
+                {
+                    return ctx.fail(ParseErrc::UnterminatedArray, pos);
+                }
+                node = ctx.validator ? ctx.validator->items_schema(top.node) : top.node;
+                return true;
+            }
+
+            if (pos >= str.length())
+            {
+                return ctx.fail(ParseErrc::UnterminatedObject, pos);
+            }
+            // Parse key (must be a string)
+            if (str[pos] != '\"')
+            {
+                return ctx.fail(ParseErrc::ExpectedKey, pos);
+            }
+
+            key.clear();
+            HH_JSON_STATS_ONLY(uint64_t scan_start = stats::detail::now_ns();)
+            if (!parse_string(ctx, key))
+            {
+                return false;
+            }
+            HH_JSON_STATS_ONLY(ctx.stats->scan_ns += stats::detail::now_ns() - scan_start;)
+            // Keys are stored in their escaped form; most need no escaping and are kept as decoded
+            if (detail::needs_escaping(key))
+            {
+                std::string escaped;
+                detail::append_escaped(escaped, key);
+                key = std::move(escaped);
+            }
+
+            skip_whitespace(str, pos);
+            if (pos >= str.length() && !ctx.final)
+            {
+                return ctx.wait();
+            }
+
+            // Parse colon
+            if (pos >= str.length() || str[pos] != ':')
+            {
+                return ctx.fail(ParseErrc::ExpectedColon, pos);
+            }
+            ++pos; // Skip ':'
+
+            node = ctx.validator ? ctx.validator->property_schema(top.node, key) : top.node;
+            return true;
+        }
+
+        // Rewinds to the start of a token cut off by the end of the input
+        Step suspend(ParseContext &ctx, size_t token_start)
+        {
+            ctx.pos = token_start;
+            ctx.need_input = false;
+            return Step::NeedInput;
+        }
+
+#if HH_JSON_STATS
+        void count_scalar(stats::Stats &stats, const std::shared_ptr<JsonObject> &value)
+        {
+            switch (value ? value->type() : JsonType::Null)
+            {
+            case JsonType::String:
+                ++stats.strings;
+                break;
+            case JsonType::Number:
+                ++stats.numbers;
+                break;
+            case JsonType::Boolean:
+                ++stats.booleans;
+                break;
+            default:
+                ++stats.nulls;
+                break;
+            }
+        }
+#endif
+
+        // Parses JSON values (object, array, string, number, boolean or null) from ctx.phase on.
+        // Containers are tracked on ctx.stack rather than the call stack, so nesting depth is
+        // bounded by options.max_depth instead of by the thread's stack size. Between tokens
+        // all state is in ctx, so when the input runs out before the end of the document and
+        // more may follow, the loop stops at the start of the unfinished token and a later
+        // call carries on from there.
+        Step run(ParseContext &ctx)
+        {
+            const std::string &str = ctx.str;
+            size_t &pos = ctx.pos;
+            const SchemaValidator *validator = ctx.validator;
+            auto &stack = ctx.stack;
+            std::string &key = ctx.key;
+            uint32_t &node = ctx.node;
+
+            while (true)
+            {
+                switch (ctx.phase)
+                {
+                case Phase::Value:
+                {
+                    if (ctx.budgeted && out_of_budget(ctx))
+                    {
+                        return ctx.error ? Step::Failed : Step::NeedTime;
+                    }
+
+                    // A value starts here; node is its schema
+                    skip_whitespace(str, pos);
+
+                    if (pos >= str.length())
+                    {
+                        return ctx.final ? ctx.stop(ParseErrc::UnexpectedEnd, pos) : Step::NeedInput;
+                    }
+                    if (++ctx.values > ctx.options.max_elements)
+                    {
+                        return ctx.stop(ParseErrc::TooManyElements, pos);
+                    }
+
+                    char c = str[pos];
+                    size_t start = pos;
+                    bool validated = validator && node != SchemaValidator::unconstrained;
+
+                    if (validated && !validator->accepts_type(node, peek_type(c)))
+                    {
+                        ctx.error.detail = "unexpected type";
+                        return ctx.stop(ParseErrc::SchemaViolation, start);
+                    }
+
+                    if (c == '{' || c == '[')
+                    {
+                        if (stack.size() >= ctx.options.max_depth)
+                        {
+                            return ctx.stop(ParseErrc::DepthLimitExceeded, pos);
+                        }
+                        bool is_array = c == '[';
+                        std::shared_ptr<JsonObject> container;
+                        if (is_array)
+                            container = make_node(ctx, &NodePool::arrays);
+                        else
+                            container = make_node(ctx, &NodePool::objects);
+                        attach(ctx, ctx.root, key, container);
+                        stack.push_back({std::move(container), is_array, node, ctx.base + start});
+                        HH_JSON_STATS_ONLY(
+                            ++(is_array ? ctx.stats->arrays : ctx.stats->objects);
+                            ctx.stats->max_depth = std::max<uint64_t>(ctx.stats->max_depth, stack.size());)
+
+                        ++pos; // Skip '{' or '['
+                        ctx.phase = Phase::Open;
+                        continue;
+                    }
+
+                    std::shared_ptr<JsonObject> value;
+                    bool ok;
+                    HH_JSON_STATS_ONLY(uint64_t scan_start = stats::detail::now_ns();)
+                    if (c == '\"' && ctx.source && ctx.options.lazy_strings)
+                    {
+                        // Keep only the slice; decoding waits for the first access
+                        size_t body;
+                        bool escaped = false;
+                        ok = parse_string(ctx, nullptr, body, escaped);
+                        if (ok)
+                        {
+                            value = std::make_shared<JsonString>(ctx.source, body, pos - body - 1, escaped);
+                            HH_JSON_STATS_ONLY(++ctx.stats->allocations;)
+                        }
+                    }
+                    else if (c == '\"')
+                    {
+                        auto text = make_node(ctx, &NodePool::strings);
+                        ok = parse_string(ctx, text->value);
+                        value = std::move(text);
+                    }
+                    else if (c == '-' || std::isdigit(static_cast<unsigned char>(c)))
+                    {
+                        ok = parse_number(ctx, value);
+                    }
+                    else if (c == 't' || c == 'f' || c == 'n')
+                    {
+                        ok = parse_literal(ctx, value);
+                    }
+                    else
+                    {
+                        return ctx.stop(ParseErrc::UnexpectedCharacter, pos);
+                    }
+                    HH_JSON_STATS_ONLY(ctx.stats->scan_ns += stats::detail::now_ns() - scan_start;)
+
+                    if (!ok)
+                    {
+                        if (ctx.need_input)
+                        {
+                            --ctx.values;
+                            return suspend(ctx, start);
+                        }
+                        return Step::Failed;
+                    }
+                    HH_JSON_STATS_ONLY(count_scalar(*ctx.stats, value);)
+                    if (validated && !validator->check(node, value, &ctx.error.detail))
+                    {
+                        return ctx.stop(ParseErrc::SchemaViolation, start);
+                    }
+                    attach(ctx, ctx.root, key, std::move(value));
+                    ctx.phase = Phase::Close;
+                    continue;
+                }
+
+                case Phase::Open:
+                {
+                    skip_whitespace(str, pos);
+                    if (pos >= str.length() && !ctx.final)
+                    {
+                        return Step::NeedInput;
+                    }
+                    // An empty container is closed right away
+                    bool empty = pos < str.length() && str[pos] == (stack.back().is_array ? ']' : '}');
+                    ctx.phase = empty ? Phase::Close : Phase::Member;
+                    continue;
+                }
+
+                case Phase::Member:
+                {
+                    skip_whitespace(str, pos);
+                    size_t start = pos;
+                    if (!begin_member(ctx, key, node))
+                    {
+                        return ctx.need_input ? suspend(ctx, start) : Step::Failed;
+                    }
+                    ctx.phase = Phase::Value;
+                    continue;
+                }
+
+                case Phase::Close:
+                {
+                    // Close finished containers until another member follows
+                    if (stack.empty())
+                    {
+                        ctx.phase = Phase::Done;
+                        return Step::Done;
+                    }
+
+                    const Frame &top = stack.back();
+                    skip_whitespace(str, pos);
+                    if (pos >= str.length() && !ctx.final)
+                    {
+                        return Step::NeedInput;
+                    }
+
+                    if (pos < str.length() && str[pos] == (top.is_array ? ']' : '}'))
+                    {
+                        ++pos; // Skip ']' or '}'
+                        if (validator && top.node != SchemaValidator::unconstrained &&
+                            !validator->check(top.node, top.value, &ctx.error.detail))
+                        {
+                            ctx.fail_at(ParseErrc::SchemaViolation, top.start);
+                            return Step::Failed;
+                        }
+                        stack.pop_back();
+                        continue;
+                    }
+
+                    if (pos < str.length() && str[pos] == ',')
+                    {
+                        ++pos; // Skip ','
+                        ctx.phase = Phase::Member;
+                        continue;
+                    }
+
+                    if (top.is_array)
+                    {
+                        return ctx.stop(pos < str.length() ? ParseErrc::ExpectedCommaOrBracket : ParseErrc::UnterminatedArray, pos);
+                    }
+                    return ctx.stop(pos < str.length() ? ParseErrc::ExpectedCommaOrBrace : ParseErrc::UnterminatedObject, pos);
+                }
+
+                case Phase::Done:
+                    return Step::Done;
+                }
+            }
+        }
+
+        // Parses one complete value from ctx.pos into out
+        bool parse_value(ParseContext &ctx, std::shared_ptr<JsonObject> &out, uint32_t node)
+        {
+            ctx.stack.clear();
+            ctx.stack.reserve(std::min(ctx.options.max_depth, preallocated_depth));
+            ctx.phase = Phase::Value;
+            ctx.node = node;
+            bool ok = run(ctx) == Step::Done;
+            out = std::move(ctx.root);
+            return ok;
+        }
 
-        for (size_t i = 0; i < str.length(); ++i)
+        // Stats are only gathered in HH_JSON_STATS builds; elsewhere the caller just gets zeros
+        void clear_stats(const ParseOptions &options)
         {
-            if (str[i] == '\"' && (i == 0 || str[i - 1] != '\\'))
+            if (options.stats)
             {
-                in_string = !in_string;
-                result.push_back(str[i]);
+                *options.stats = stats::Stats{};
             }
-            else if (!in_string && std::isspace(str[i]))
+        }
+
+        // Parses a document whose root must be an object and returns that object. On failure
+        // the partial tree goes back to the workspace's pool, if it has one.
+        Result<std::shared_ptr<JsonObject>>
+        parse_document(const std::string &jsonString, const SchemaValidator *validator, const ParseOptions &options, Workspace &work)
+        {
+            clear_stats(options);
+            HH_JSON_STATS_ONLY(StatsPublisher publisher(options);)
+            if (jsonString.size() > options.max_size)
             {
-                continue;
+                return ParseError{ParseErrc::DocumentTooLarge, options.max_size, {}};
             }
-            else
+
             {
-                result.push_back(str[i]);
+                HH_JSON_STATS_ONLY(stats::detail::Timer timer(publisher.stats.preprocess_ns);)
+                preprocess(jsonString, work.text, work.scratch);
             }
-        }
-        str = std::move(result); // Use move for efficiency
-    }
 
-    // favor space over time, as we parse in O of N time, and O of N space (take copy of the string)
-    void erase_comments(std::string &str)
-    {
-        std::string result;
-        result.reserve(str.length()); // Pre-allocate for efficiency
-        bool in_string = false;
+            // Lazy strings and numbers keep slices of the preprocessed text, so it moves to shared storage
+            std::shared_ptr<const std::string> source;
+            if (options.lazy_strings || options.lazy_numbers)
+            {
+                source = std::make_shared<const std::string>(std::move(work.text));
+            }
+            const std::string &text = source ? *source : work.text;
 
-        for (size_t i = 0; i < str.length(); ++i)
-        {
-            if (str[i] == '\"' && (i == 0 || str[i - 1] != '\\'))
+            ParseContext ctx{text, options, validator, work};
+            ctx.source = std::move(source);
+            HH_JSON_STATS_ONLY(ctx.stats = &publisher.stats; publisher.stats.input_bytes = text.size();)
+            skip_whitespace(text, ctx.pos);
+
+            if (ctx.pos >= text.length() || text[ctx.pos] != '{')
             {
-                in_string = !in_string;
-                result.push_back(str[i]);
+                ctx.fail(ParseErrc::RootNotObject, ctx.pos);
+                ctx.error.offset = input_offset(jsonString, ctx.error.offset);
+                return std::move(ctx.error);
             }
-            else if (!in_string && str[i] == '/' && i + 1 < str.length() && str[i + 1] == '/')
+
+            std::shared_ptr<JsonObject> root_obj;
+            bool ok;
             {
-                // Skip the comment to end of line
-                while (i < str.length() && str[i] != '\n')
-                {
-                    ++i;
-                }
-                // Add a space in place of the comment
-                result.push_back(' ');
+                HH_JSON_STATS_ONLY(stats::detail::Timer timer(publisher.stats.build_ns);)
+                ok = parse_value(ctx, root_obj, validator ? validator->root() : SchemaValidator::unconstrained);
             }
-            else
+            if (!ok)
             {
-                result.push_back(str[i]);
+                work.stack.clear();
+                if (work.pool)
+                {
+                    recycle(*work.pool, std::move(root_obj));
+                }
+                // Errors are found in the preprocessed text; report where they are in the input
+                ctx.error.offset = input_offset(jsonString, ctx.error.offset);
+                return std::move(ctx.error);
             }
+            return root_obj;
         }
-        str = std::move(result); // Use move for efficiency
-    }
-
-    // Forward declarations of parsing functions
-    std::shared_ptr<JsonObject> parse_value(const std::string &str, size_t &pos);
-    std::shared_ptr<JsonObject> parse_object(const std::string &str, size_t &pos);
-    std::shared_ptr<JsonArray> parse_array(const std::string &str, size_t &pos);
-    std::shared_ptr<JsonString> parse_string(const std::string &str, size_t &pos);
-    std::shared_ptr<JsonNumber> parse_number(const std::string &str, size_t &pos);
-    std::shared_ptr<JsonBoolean> parse_boolean(const std::string &str, size_t &pos);
-    std::shared_ptr<JsonObject> parse_null(const std::string &str, size_t &pos);
-
-    // Skip whitespace
-    void skip_whitespace(const std::string &str, size_t &pos)
-    {
-        while (pos < str.length() && std::isspace(str[pos]))
-        {
-            ++pos;
-        }
-    }
 
-    // Parse a JSON string value
-    std::shared_ptr<JsonString> parse_string(const std::string &str, size_t &pos)
-    {
-        if (str[pos] != '\"')
+        // Parses a single value of any type, without preprocessing
+        Result<std::shared_ptr<JsonObject>> parse_single(const std::string &valueString, const ParseOptions &options, Workspace &work)
         {
-            throw std::runtime_error("Expected '\"' at position " + std::to_string(pos));
-        }
+            clear_stats(options);
+            if (valueString.empty())
+            {
+                return std::shared_ptr<JsonObject>(std::make_shared<JsonObject>());
+            }
+            HH_JSON_STATS_ONLY(StatsPublisher publisher(options);)
+            if (valueString.size() > options.max_size)
+            {
+                return ParseError{ParseErrc::DocumentTooLarge, options.max_size, {}};
+            }
 
-        std::string value;
-        ++pos; // Skip opening quote
+            std::shared_ptr<const std::string> source;
+            if (options.lazy_strings || options.lazy_numbers)
+            {
+                source = std::make_shared<const std::string>(valueString);
+            }
 
-        while (pos < str.length())
-        {
-            char c = str[pos++];
-            if (c == '\"')
+            ParseContext ctx{source ? *source : valueString, options, nullptr, work};
+            ctx.source = std::move(source);
+            HH_JSON_STATS_ONLY(ctx.stats = &publisher.stats; publisher.stats.input_bytes = valueString.size();)
+            std::shared_ptr<JsonObject> value;
+            bool ok;
             {
-                // End of string
-                return std::make_shared<JsonString>(value);
+                HH_JSON_STATS_ONLY(stats::detail::Timer timer(publisher.stats.build_ns);)
+                ok = parse_value(ctx, value, SchemaValidator::unconstrained);
             }
-            else if (c == '\\' && pos < str.length())
+            if (!ok)
             {
-                // Handle escape sequences
-                char next = str[pos++];
-                switch (next)
+                work.stack.clear();
+                if (work.pool)
                 {
-                case '\"':
-                    value += '\"';
-                    break;
-                case '\\':
-                    value += '\\';
-                    break;
-                case '/':
-                    value += '/';
-                    break;
-                case 'b':
-                    value += '\b';
-                    break;
-                case 'f':
-                    value += '\f';
-                    break;
-                case 'n':
-                    value += '\n';
-                    break;
-                case 'r':
-                    value += '\r';
-                    break;
-                case 't':
-                    value += '\t';
-                    break;
-                case 'u':
-                    // Handle Unicode escape - simplified version
-                    if (pos + 4 <= str.length())
-                    {
-                        // Just add the Unicode escape sequence as is for now
-                        value += "\\u";
-                        for (int i = 0; i < 4; ++i)
-                        {
-                            value += str[pos++];
-                        }
-                    }
-                    break;
-                default:
-                    value += next;
-                    break;
+                    recycle(*work.pool, std::move(value));
                 }
+                return std::move(ctx.error);
             }
-            else
+            return value;
+        }
+
+        Result<std::unordered_map<std::string, std::shared_ptr<JsonObject>>>
+        parse_members(const std::string &jsonString, const SchemaValidator *validator, const ParseOptions &options)
+        {
+            Workspace work;
+            auto root = parse_document(jsonString, validator, options, work);
+            if (!root)
             {
-                value += c;
+                return root.error();
             }
+            return (*root)->take_data();
         }
-
-        throw std::runtime_error("Unterminated string at position " + std::to_string(pos));
     }
 
-    // Parse a JSON number
-    std::shared_ptr<JsonNumber> parse_number(const std::string &str, size_t &pos)
+    namespace detail
     {
-        size_t start = pos;
-        [[maybe_unused]] bool has_decimal = false;
-        [[maybe_unused]] bool has_exponent = false;
-
-        // Handle negative sign
-        if (pos < str.length() && str[pos] == '-')
+        void unescape(std::string_view raw, std::string &out)
         {
-            ++pos;
+            out.reserve(out.size() + raw.size());
+            size_t pos = 0;
+            size_t escapes = 0;
+            size_t error_at = 0;
+            // raw has no closing quote, so a complete scan ends as "unterminated"
+            scan_string(raw.data(), raw.size(), pos, &out, escapes, error_at);
         }
+    }
 
-        // Parse digits before decimal point
-        while (pos < str.length() && std::isdigit(str[pos]))
-        {
-            ++pos;
-        }
+    Result<std::unordered_map<std::string, std::shared_ptr<JsonObject>>>
+    try_parse(const std::string &jsonString)
+    {
+        return parse_members(jsonString, nullptr, ParseOptions{});
+    }
 
-        // Parse decimal point and following digits
-        if (pos < str.length() && str[pos] == '.')
-        {
-            has_decimal = true;
-            ++pos;
-            while (pos < str.length() && std::isdigit(str[pos]))
-            {
-                ++pos;
-            }
-        }
+    Result<std::unordered_map<std::string, std::shared_ptr<JsonObject>>>
+    try_parse(const std::string &jsonString, const SchemaValidator &validator)
+    {
+        return parse_members(jsonString, &validator, ParseOptions{});
+    }
 
-        // Parse exponent
-        if (pos < str.length() && (str[pos] == 'e' || str[pos] == 'E'))
-        {
-            has_exponent = true;
-            ++pos;
+    Result<std::unordered_map<std::string, std::shared_ptr<JsonObject>>>
+    try_parse(const std::string &jsonString, const ParseOptions &options)
+    {
+        return parse_members(jsonString, nullptr, options);
+    }
 
-            if (pos < str.length() && (str[pos] == '+' || str[pos] == '-'))
-            {
-                ++pos;
-            }
+    Result<std::shared_ptr<JsonObject>> try_parse_value(const std::string &valueString, const ParseOptions &options)
+    {
+        Workspace work;
+        return parse_single(valueString, options, work);
+    }
 
-            while (pos < str.length() && std::isdigit(str[pos]))
-            {
-                ++pos;
-            }
-        }
+    Result<std::shared_ptr<JsonObject>> try_parse_value(const std::string &valueString)
+    {
+        return try_parse_value(valueString, ParseOptions{});
+    }
 
-        // Extract the number string and convert to double
-        std::string number_str = str.substr(start, pos - start);
-        auto result = std::make_shared<JsonNumber>();
-        if (!result->set_json_data(number_str))
-        {
-            throw std::runtime_error("Invalid number format at position " + std::to_string(start));
-        }
+    std::unordered_map<std::string, std::shared_ptr<JsonObject>>
+    parse(const std::string &jsonString)
+    {
+        return try_parse(jsonString).value();
+    }
 
-        return result;
+    std::unordered_map<std::string, std::shared_ptr<JsonObject>>
+    parse(const std::string &jsonString, const SchemaValidator &validator)
+    {
+        return try_parse(jsonString, validator).value();
     }
 
-    // Parse a JSON boolean value
-    std::shared_ptr<JsonBoolean> parse_boolean(const std::string &str, size_t &pos)
+    std::unordered_map<std::string, std::shared_ptr<JsonObject>>
+    parse(const std::string &jsonString, const ParseOptions &options)
     {
-        if (pos + 4 <= str.length() && str.substr(pos, 4) == "true")
-        {
-            pos += 4;
-            return std::make_shared<JsonBoolean>(true);
-        }
-        else if (pos + 5 <= str.length() && str.substr(pos, 5) == "false")
-        {
-            pos += 5;
-            return std::make_shared<JsonBoolean>(false);
-        }
+        return try_parse(jsonString, options).value();
+    }
+
+    std::shared_ptr<JsonObject> JsonValue(const std::string &valueString)
+    {
+        auto result = try_parse_value(valueString);
+        return result ? std::move(*result) : nullptr;
+    }
 
-        throw std::runtime_error("Expected 'true' or 'false' at position " + std::to_string(pos));
+    struct Parser::State
+    {
+        ParseOptions options;
+        Workspace work;
+        NodePool pool;
+        std::shared_ptr<JsonObject> last; // result of the previous parse
+    };
+
+    Parser::Parser(ParseOptions options) : state(std::make_unique<State>())
+    {
+        state->options = options;
+        state->work.pool = &state->pool;
+    }
+
+    Parser::~Parser() = default;
+    Parser::Parser(Parser &&) noexcept = default;
+    Parser &Parser::operator=(Parser &&) noexcept = default;
+
+    const ParseOptions &Parser::options() const
+    {
+        return state->options;
+    }
+
+    void Parser::set_options(const ParseOptions &options)
+    {
+        state->options = options;
     }
 
-    // Parse a JSON null value
-    std::shared_ptr<JsonObject> parse_null(const std::string &str, size_t &pos)
+    Result<std::shared_ptr<JsonObject>> Parser::parse(const std::string &jsonString)
     {
-        if (pos + 4 <= str.length() && str.substr(pos, 4) == "null")
+        reset();
+        auto result = parse_document(jsonString, nullptr, state->options, state->work);
+        if (result)
         {
-            pos += 4;
-            return nullptr; // Return nullptr for null values
+            state->last = *result;
         }
+        return result;
+    }
 
-        throw std::runtime_error("Expected 'null' at position " + std::to_string(pos));
+    Result<std::shared_ptr<JsonObject>> Parser::parse_value(const std::string &valueString)
+    {
+        reset();
+        auto result = parse_single(valueString, state->options, state->work);
+        if (result)
+        {
+            state->last = *result;
+        }
+        return result;
     }
 
-    // Parse a JSON array
-    std::shared_ptr<JsonArray> parse_array(const std::string &str, size_t &pos)
+    void Parser::reset()
     {
-        if (str[pos] != '[')
+        if (state->last)
         {
-            throw std::runtime_error("Expected '[' at position " + std::to_string(pos));
+            recycle(state->pool, std::move(state->last));
+            state->last = nullptr;
         }
+    }
 
-        ++pos; // Skip '['
-        skip_whitespace(str, pos);
+    void Parser::release()
+    {
+        auto options = state->options;
+        state = std::make_unique<State>();
+        state->options = options;
+        state->work.pool = &state->pool;
+    }
 
-        auto array = std::make_shared<JsonArray>();
+    struct IncrementalParser::State
+    {
+        ParseOptions options;
+        std::string buffer; // input from ctx.base on
+        NodePool pool;
+        Workspace work;
+        ParseContext ctx;
+        Status status = Status::NeedInput;
+        bool started = false; // the root's opening brace has been seen
+        std::shared_ptr<JsonObject> result;
+        HH_JSON_STATS_ONLY(stats::Stats stats;)
 
-        // Check for empty array
-        if (pos < str.length() && str[pos] == ']')
+        explicit State(const ParseOptions &options) : options(options), ctx(buffer, this->options, nullptr, work)
         {
-            ++pos; // Skip ']'
-            return array;
+            work.pool = &pool;
+            ctx.pool = &pool;
+            start();
         }
 
-        while (pos < str.length())
+        void start()
         {
-            // Parse array element
-            auto element = parse_value(str, pos);
-            array->insert(element);
+            buffer.clear();
+            work.stack.clear();
+            ctx.pos = 0;
+            ctx.values = 0;
+            ctx.error = ParseError{};
+            ctx.phase = Phase::Value;
+            ctx.node = SchemaValidator::unconstrained;
+            ctx.root = nullptr;
+            ctx.final = false;
+            ctx.need_input = false;
+            ctx.base = 0;
+            ctx.scanned = 0;
+            ctx.budgeted = false;
+            status = Status::NeedInput;
+            started = false;
+            clear_stats(options);
+            HH_JSON_STATS_ONLY(stats = stats::Stats{}; ctx.stats = &stats;)
+        }
 
-            skip_whitespace(str, pos);
+        Status fail(ParseErrc code, size_t position)
+        {
+            ctx.fail_at(code, position);
+            return finish(Step::Failed);
+        }
 
-            // Check for end of array or next element
-            if (pos < str.length() && str[pos] == ']')
-            {
-                ++pos; // Skip ']'
-                return array;
-            }
+        bool open() const
+        {
+            return status == Status::NeedInput || status == Status::NeedTime;
+        }
 
-            if (pos < str.length() && str[pos] == ',')
+        // Applies budget to the next advance(); nullptr lifts it
+        void limit(const StepBudget *budget)
+        {
+            ctx.budgeted = budget != nullptr;
+            if (!budget)
             {
-                ++pos; // Skip ','
-                skip_whitespace(str, pos);
+                return;
             }
-            else
+            ctx.budget_end = budget->bytes > buffer.size() - ctx.pos ? buffer.size() : ctx.pos + budget->bytes;
+            ctx.timed = budget->time != std::chrono::microseconds::max();
+            if (ctx.timed)
             {
-                throw std::runtime_error("Expected ',' or ']' at position " + std::to_string(pos));
+                ctx.deadline = std::chrono::steady_clock::now() + budget->time;
             }
+            ctx.cancel = budget->cancel;
+            ctx.ticks = 0;
         }
 
-        throw std::runtime_error("Unterminated array at position " + std::to_string(pos));
-    }
-
-    // Parse a JSON object
-    std::shared_ptr<JsonObject> parse_object(const std::string &str, size_t &pos)
-    {
-        if (str[pos] != '{')
-        {
-            throw std::runtime_error("Expected '{' at position " + std::to_string(pos));
-        }
-
-        ++pos; // Skip '{'
-        skip_whitespace(str, pos);
-
-        std::unordered_map<std::string, std::shared_ptr<JsonObject>> properties;
-
-        // Check for empty object
-        if (pos < str.length() && str[pos] == '}')
+        Status finish(Step step)
         {
-            ++pos; // Skip '}'
-            auto result = std::make_shared<JsonObject>();
-            for (const auto &[key, value] : properties)
+            HH_JSON_STATS_ONLY(stats.input_bytes = ctx.base + ctx.pos; publish(stats, options);)
+            work.stack.clear();
+            if (step == Step::Done)
+            {
+                result = std::move(ctx.root);
+                status = Status::Done;
+            }
+            else
             {
-                result->insert(key, value);
+                recycle(pool, std::move(ctx.root));
+                status = Status::Failed;
             }
-            return result;
+            buffer.clear();
+            return status;
         }
 
-        while (pos < str.length())
+        // Parses what the buffer holds, then drops the bytes that are done with
+        Status advance()
         {
-            // Parse key (must be a string)
-            if (str[pos] != '\"')
+            Step step;
             {
-                throw std::runtime_error("Expected string key at position " + std::to_string(pos));
+                HH_JSON_STATS_ONLY(stats::detail::Timer timer(stats.build_ns);)
+                step = started ? run(ctx) : begin();
             }
-
-            auto key_obj = parse_string(str, pos);
-            std::string key = key_obj->stringify();
-            // Remove the quotes from the key
-            key = key.substr(1, key.length() - 2);
-
-            skip_whitespace(str, pos);
-
-            // Parse colon
-            if (pos >= str.length() || str[pos] != ':')
+            if (step != Step::NeedInput && step != Step::NeedTime)
             {
-                throw std::runtime_error("Expected ':' at position " + std::to_string(pos));
+                return finish(step);
             }
 
-            ++pos; // Skip ':'
-            skip_whitespace(str, pos);
-
-            // Parse value
-            auto value = parse_value(str, pos);
-            properties[key] = value;
-
-            skip_whitespace(str, pos);
-
-            // Check for end of object or next property
-            if (pos < str.length() && str[pos] == '}')
+            // Out of input, only an unfinished token is left. Out of time, the rest may be a
+            // large buffer; compacting once the parsed prefix outweighs it keeps many small
+            // steps from moving each byte more than a few times.
+            if (step == Step::NeedInput || ctx.pos >= buffer.size() - ctx.pos)
             {
-                ++pos; // Skip '}'
-                auto result = std::make_shared<JsonObject>();
-                for (const auto &[key, value] : properties)
-                {
-                    result->insert(key, value);
-                }
-                return result;
+                buffer.erase(0, ctx.pos);
+                ctx.base += ctx.pos;
+                ctx.scanned -= std::min(ctx.scanned, ctx.pos);
+                ctx.pos = 0;
             }
+            status = step == Step::NeedTime ? Status::NeedTime : Status::NeedInput;
+            return status;
+        }
 
-            if (pos < str.length() && str[pos] == ',')
+        // Checks that the root is an object, as parse() does, then starts the loop
+        Step begin()
+        {
+            skip_whitespace(buffer, ctx.pos);
+            if (ctx.pos >= buffer.size() && !ctx.final)
             {
-                ++pos; // Skip ','
-                skip_whitespace(str, pos);
+                return Step::NeedInput;
             }
-            else
+            if (ctx.pos >= buffer.size() || buffer[ctx.pos] != '{')
             {
-                throw std::runtime_error("Expected ',' or '}' at position " + std::to_string(pos));
+                return ctx.stop(ParseErrc::RootNotObject, ctx.pos);
             }
+            started = true;
+            work.stack.reserve(std::min(options.max_depth, preallocated_depth));
+            return run(ctx);
         }
+    };
 
-        throw std::runtime_error("Unterminated object at position " + std::to_string(pos));
-    }
+    IncrementalParser::IncrementalParser(ParseOptions options) : state(std::make_unique<State>(options)) {}
+    IncrementalParser::~IncrementalParser() = default;
+    IncrementalParser::IncrementalParser(IncrementalParser &&) noexcept = default;
+    IncrementalParser &IncrementalParser::operator=(IncrementalParser &&) noexcept = default;
 
-    // Parse a JSON value (can be object, array, string, number, boolean, or null)
-    std::shared_ptr<JsonObject> parse_value(const std::string &str, size_t &pos)
+    IncrementalParser::Status IncrementalParser::feed(std::string_view chunk)
     {
-        skip_whitespace(str, pos);
-
-        if (pos >= str.length())
+        if (append(chunk) == Status::Failed)
         {
-            throw std::runtime_error("Unexpected end of input");
+            return Status::Failed;
         }
+        state->limit(nullptr);
+        return state->open() ? state->advance() : state->status;
+    }
 
-        char c = str[pos];
+    IncrementalParser::Status IncrementalParser::finish()
+    {
+        end_input();
+        state->limit(nullptr);
+        return state->open() ? state->advance() : state->status;
+    }
 
-        if (c == '{')
-        {
-            return parse_object(str, pos);
-        }
-        else if (c == '[')
+    IncrementalParser::Status IncrementalParser::append(std::string_view chunk)
+    {
+        if (!state->open())
         {
-            return parse_array(str, pos);
+            return state->status;
         }
-        else if (c == '\"')
+        size_t seen = state->ctx.base + state->buffer.size();
+        if (chunk.size() > state->options.max_size - seen)
         {
-            return parse_string(str, pos);
+            return state->fail(ParseErrc::DocumentTooLarge, state->options.max_size);
         }
-        else if (c == '-' || std::isdigit(c))
+        state->buffer.append(chunk);
+        return state->status;
+    }
+
+    void IncrementalParser::end_input()
+    {
+        if (state->open())
         {
-            return parse_number(str, pos);
+            state->ctx.final = true;
         }
-        else if (c == 't' || c == 'f')
+    }
+
+    IncrementalParser::Status IncrementalParser::step(const StepBudget &budget)
+    {
+        if (!state->open())
         {
-            return parse_boolean(str, pos);
+            return state->status;
         }
-        else if (c == 'n')
+        if (budget.cancel && budget.cancel->load(std::memory_order_relaxed))
         {
-            return parse_null(str, pos);
+            return state->fail(ParseErrc::Cancelled, consumed());
         }
-
-        throw std::runtime_error("Unexpected character at position " + std::to_string(pos) + ": " + c);
+        state->limit(&budget);
+        return state->advance();
     }
 
-    std::unordered_map<std::string, std::shared_ptr<JsonObject>>
-    parse(const std::string &jsonString)
+    IncrementalParser::Status IncrementalParser::status() const
     {
-        auto JsonString_copy = jsonString;
-
-        trim(JsonString_copy);
-        remove_spaces_not_in_string_literals(JsonString_copy);
-        erase_comments(JsonString_copy);
-
-        size_t pos = 0;
-        skip_whitespace(JsonString_copy, pos);
+        return state->status;
+    }
 
-        if (pos >= JsonString_copy.length() || JsonString_copy[pos] != '{')
+    Result<std::shared_ptr<JsonObject>> IncrementalParser::result() const
+    {
+        switch (state->status)
         {
-            throw std::runtime_error("JSON must start with an object");
+        case Status::Done:
+            return state->result;
+        case Status::Failed:
+            return state->ctx.error;
+        default:
+            return ParseError{ParseErrc::UnexpectedEnd, consumed(), {}};
         }
-
-        auto root_obj = parse_object(JsonString_copy, pos);
-        return root_obj->get_data();
     }
 
-    std::shared_ptr<JsonObject> JsonValue(const std::string &valueString)
+    size_t IncrementalParser::consumed() const
     {
-        try
-        {
-
-            size_t pos = 0;
-            if (valueString.empty())
-            {
-                return std::make_shared<JsonObject>();
-            }
+        return state->ctx.base + state->ctx.pos;
+    }
 
-            return parse_value(valueString, pos);
-        }
-        catch (const std::exception &e)
-        {
-            std::cerr << e.what() << std::endl;
-            return nullptr;
-        }
+    size_t IncrementalParser::buffered() const
+    {
+        return state->buffer.size();
     }
 
+    void IncrementalParser::reset()
+    {
+        recycle(state->pool, std::move(state->result));
+        state->result = nullptr;
+        state->start();
+    }
 }
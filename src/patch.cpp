@@ -0,0 +1,421 @@
+#include <stdexcept>
+#include <vector>
+
+#include "../includes/patch.hpp"
+#include "../includes/parser.hpp"
+#include "../includes/pointer.hpp"
+#include "../includes/healpers.hpp"
+
+namespace hh_json::patch
+{
+    namespace
+    {
+        // One reversible change, recorded so a failing patch leaves the document as it was
+        struct Undo
+        {
+            enum class Kind
+            {
+                Root,
+                ObjectPut,
+                ObjectErase,
+                ArrayInsert,
+                ArrayErase,
+                ArraySet
+            };
+
+            Kind kind;
+            std::shared_ptr<JsonObject> container;
+            std::string key;
+            size_t index = 0;
+            std::shared_ptr<JsonObject> old;
+            bool existed = false;
+        };
+
+        class Patcher
+        {
+        public:
+            explicit Patcher(std::shared_ptr<JsonObject> &document) : document(document) {}
+
+            void rollback()
+            {
+                for (auto it = log.rbegin(); it != log.rend(); ++it)
+                {
+                    switch (it->kind)
+                    {
+                    case Undo::Kind::Root:
+                        document = it->old;
+                        break;
+                    case Undo::Kind::ObjectPut:
+                        if (it->existed)
+                            it->container->insert(it->key, it->old);
+                        else
+                            it->container->erase(it->key);
+                        break;
+                    case Undo::Kind::ObjectErase:
+                        it->container->insert(it->key, it->old);
+                        break;
+                    case Undo::Kind::ArrayInsert:
+                    {
+                        auto &elements = static_cast<JsonArray &>(*it->container).elements;
+                        elements.erase(elements.begin() + it->index);
+                        break;
+                    }
+                    case Undo::Kind::ArrayErase:
+                    {
+                        auto &elements = static_cast<JsonArray &>(*it->container).elements;
+                        elements.insert(elements.begin() + it->index, it->old);
+                        break;
+                    }
+                    case Undo::Kind::ArraySet:
+                        static_cast<JsonArray &>(*it->container).elements[it->index] = it->old;
+                        break;
+                    }
+                }
+                log.clear();
+            }
+
+            std::shared_ptr<JsonObject> get(const std::vector<std::string> &tokens) const
+            {
+                std::shared_ptr<JsonObject> current = document;
+                for (const auto &token : tokens)
+                {
+                    current = child(current, token);
+                }
+                return current;
+            }
+
+            void add(const std::vector<std::string> &tokens, std::shared_ptr<JsonObject> value)
+            {
+                if (tokens.empty())
+                {
+                    log.push_back({Undo::Kind::Root, nullptr, {}, 0, document});
+                    document = std::move(value);
+                    return;
+                }
+                auto parent = container_of(tokens);
+                const std::string &token = tokens.back();
+                if (parent->type() == JsonType::Array)
+                {
+                    auto &elements = static_cast<JsonArray &>(*parent).elements;
+                    size_t index = pointer::array_index(token, elements.size());
+                    elements.insert(elements.begin() + index, std::move(value));
+                    log.push_back({Undo::Kind::ArrayInsert, parent, {}, index, nullptr});
+                    return;
+                }
+                std::string key = member_key(token);
+                bool existed = parent->has_key(key);
+                log.push_back({Undo::Kind::ObjectPut, parent, key, 0, existed ? parent->get(key) : nullptr, existed});
+                parent->insert(std::move(key), std::move(value));
+            }
+
+            std::shared_ptr<JsonObject> remove(const std::vector<std::string> &tokens)
+            {
+                if (tokens.empty())
+                {
+                    HH_JSON_THROW(std::runtime_error("Cannot remove the document root"));
+                }
+                auto parent = container_of(tokens);
+                const std::string &token = tokens.back();
+                if (parent->type() == JsonType::Array)
+                {
+                    auto &elements = static_cast<JsonArray &>(*parent).elements;
+                    size_t index = existing_index(token, elements.size());
+                    auto old = elements[index];
+                    elements.erase(elements.begin() + index);
+                    log.push_back({Undo::Kind::ArrayErase, parent, {}, index, old});
+                    return old;
+                }
+                std::string key = member_key(token);
+                if (!parent->has_key(key))
+                {
+                    HH_JSON_THROW(std::runtime_error("Path not found: " + token));
+                }
+                auto old = parent->get(key);
+                parent->erase(key);
+                log.push_back({Undo::Kind::ObjectErase, parent, key, 0, old});
+                return old;
+            }
+
+            void replace(const std::vector<std::string> &tokens, std::shared_ptr<JsonObject> value)
+            {
+                if (tokens.empty())
+                {
+                    add(tokens, std::move(value));
+                    return;
+                }
+                auto parent = container_of(tokens);
+                const std::string &token = tokens.back();
+                if (parent->type() == JsonType::Array)
+                {
+                    auto &elements = static_cast<JsonArray &>(*parent).elements;
+                    size_t index = existing_index(token, elements.size());
+                    log.push_back({Undo::Kind::ArraySet, parent, {}, index, elements[index]});
+                    elements[index] = std::move(value);
+                    return;
+                }
+                if (!parent->has_key(member_key(token)))
+                {
+                    HH_JSON_THROW(std::runtime_error("Path not found: " + token));
+                }
+                add(tokens, std::move(value));
+            }
+
+        private:
+            std::shared_ptr<JsonObject> &document;
+            std::vector<Undo> log;
+
+            // Pointer tokens are plain text; object keys are stored escaped (see the parser)
+            static std::string member_key(const std::string &token)
+            {
+                return detail::needs_escaping(token) ? detail::escape_key(token) : token;
+            }
+
+            static size_t existing_index(const std::string &token, size_t size)
+            {
+                size_t index = pointer::array_index(token, size);
+                if (index == size)
+                {
+                    HH_JSON_THROW(std::runtime_error("Array index out of range: " + token));
+                }
+                return index;
+            }
+
+            static std::shared_ptr<JsonObject> child(const std::shared_ptr<JsonObject> &node, const std::string &token)
+            {
+                switch (getter::get_type(node))
+                {
+                case JsonType::Object:
+                {
+                    std::string key = member_key(token);
+                    if (!node->has_key(key))
+                    {
+                        HH_JSON_THROW(std::runtime_error("Path not found: " + token));
+                    }
+                    return node->get(key);
+                }
+                case JsonType::Array:
+                {
+                    const auto &elements = static_cast<const JsonArray &>(*node).elements;
+                    return elements[existing_index(token, elements.size())];
+                }
+                default:
+                    HH_JSON_THROW(std::runtime_error("Cannot descend into a scalar at: " + token));
+                }
+            }
+
+            // Object or array holding the last token of the path
+            std::shared_ptr<JsonObject> container_of(const std::vector<std::string> &tokens) const
+            {
+                std::shared_ptr<JsonObject> current = document;
+                for (size_t i = 0; i + 1 < tokens.size(); ++i)
+                {
+                    current = child(current, tokens[i]);
+                }
+                auto type = getter::get_type(current);
+                if (type != JsonType::Object && type != JsonType::Array)
+                {
+                    HH_JSON_THROW(std::runtime_error("Parent of '" + tokens.back() + "' is not a container"));
+                }
+                return current;
+            }
+        };
+
+        std::string member_string(const std::shared_ptr<JsonObject> &operation, const char *name, size_t index)
+        {
+            auto value = operation->get(name);
+            if (getter::get_type(value) != JsonType::String)
+            {
+                HH_JSON_THROW(std::runtime_error("Patch operation " + std::to_string(index) + " is missing '" + name + "'"));
+            }
+            return static_cast<const JsonString &>(*value).str();
+        }
+
+        std::shared_ptr<JsonObject> member_value(const std::shared_ptr<JsonObject> &operation, size_t index)
+        {
+            if (!operation->has_key("value"))
+            {
+                HH_JSON_THROW(std::runtime_error("Patch operation " + std::to_string(index) + " is missing 'value'"));
+            }
+            return clone(operation->get("value"));
+        }
+
+        bool is_prefix(const std::vector<std::string> &prefix, const std::vector<std::string> &path)
+        {
+            if (prefix.size() >= path.size())
+            {
+                return false;
+            }
+            for (size_t i = 0; i < prefix.size(); ++i)
+            {
+                if (prefix[i] != path[i])
+                    return false;
+            }
+            return true;
+        }
+
+        // JsonValue reports errors as nullptr, which is also the result for a literal null
+        std::shared_ptr<JsonObject> parse_patch_text(const std::string &text)
+        {
+            auto value = JsonValue(text);
+            if (!value)
+            {
+                size_t first = text.find_first_not_of(" \t\r\n");
+                if (first == std::string::npos || text.compare(first, 4, "null") != 0)
+                {
+                    HH_JSON_THROW(std::runtime_error("Invalid patch JSON"));
+                }
+            }
+            return value;
+        }
+
+        std::shared_ptr<JsonObject> merge_into(std::shared_ptr<JsonObject> target, const std::shared_ptr<JsonObject> &mergePatch)
+        {
+            if (getter::get_type(mergePatch) != JsonType::Object)
+            {
+                return clone(mergePatch);
+            }
+            if (getter::get_type(target) != JsonType::Object)
+            {
+                target = std::make_shared<JsonObject>();
+            }
+            for (const auto &[key, value] : mergePatch->get_data())
+            {
+                if (!value)
+                {
+                    target->erase(key);
+                }
+                else
+                {
+                    target->insert(key, merge_into(target->get(key), value));
+                }
+            }
+            return target;
+        }
+    }
+
+    std::shared_ptr<JsonObject> clone(const std::shared_ptr<JsonObject> &value)
+    {
+        switch (getter::get_type(value))
+        {
+        case JsonType::Null:
+            return nullptr;
+        case JsonType::Boolean:
+            return std::make_shared<JsonBoolean>(static_cast<const JsonBoolean &>(*value).value);
+        case JsonType::Number:
+            return std::make_shared<JsonNumber>(static_cast<const JsonNumber &>(*value));
+        case JsonType::String:
+            return std::make_shared<JsonString>(static_cast<const JsonString &>(*value));
+        case JsonType::Array:
+        {
+            auto array = std::make_shared<JsonArray>();
+            const auto &elements = static_cast<const JsonArray &>(*value).elements;
+            array->elements.reserve(elements.size());
+            for (const auto &element : elements)
+            {
+                array->insert(clone(element));
+            }
+            return array;
+        }
+        case JsonType::Object:
+        {
+            auto object = std::make_shared<JsonObject>();
+            for (const auto &[key, item] : value->get_data())
+            {
+                object->insert(key, clone(item));
+            }
+            return object;
+        }
+        }
+        return nullptr;
+    }
+
+    void apply(std::shared_ptr<JsonObject> &document, const std::shared_ptr<JsonObject> &operations)
+    {
+        if (getter::get_type(operations) != JsonType::Array)
+        {
+            HH_JSON_THROW(std::runtime_error("JSON Patch must be an array of operations"));
+        }
+
+        Patcher patcher(document);
+        const auto &ops = static_cast<const JsonArray &>(*operations).elements;
+        HH_JSON_TRY
+        {
+            for (size_t i = 0; i < ops.size(); ++i)
+            {
+                const auto &operation = ops[i];
+                if (getter::get_type(operation) != JsonType::Object)
+                {
+                    HH_JSON_THROW(std::runtime_error("Patch operation " + std::to_string(i) + " is not an object"));
+                }
+
+                std::string op = member_string(operation, "op", i);
+                auto path = pointer::parse(member_string(operation, "path", i));
+
+                if (op == "add")
+                {
+                    patcher.add(path, member_value(operation, i));
+                }
+                else if (op == "remove")
+                {
+                    patcher.remove(path);
+                }
+                else if (op == "replace")
+                {
+                    patcher.replace(path, member_value(operation, i));
+                }
+                else if (op == "move")
+                {
+                    auto from = pointer::parse(member_string(operation, "from", i));
+                    if (is_prefix(from, path))
+                    {
+                        HH_JSON_THROW(std::runtime_error("Cannot move a value into one of its children"));
+                    }
+                    if (from != path)
+                    {
+                        patcher.add(path, patcher.remove(from));
+                    }
+                    else
+                    {
+                        patcher.get(from); // a move onto itself is a no-op, but from must still exist
+                    }
+                }
+                else if (op == "copy")
+                {
+                    auto from = pointer::parse(member_string(operation, "from", i));
+                    patcher.add(path, clone(patcher.get(from)));
+                }
+                else if (op == "test")
+                {
+                    if (!equals(patcher.get(path), operation->get("value")) || !operation->has_key("value"))
+                    {
+                        HH_JSON_THROW(std::runtime_error("Patch test failed at operation " + std::to_string(i)));
+                    }
+                }
+                else
+                {
+                    HH_JSON_THROW(std::runtime_error("Unknown patch operation: " + op));
+                }
+            }
+        }
+        HH_JSON_CATCH_ALL
+        {
+            patcher.rollback();
+            HH_JSON_RETHROW;
+        }
+    }
+
+    void apply(std::shared_ptr<JsonObject> &document, const std::string &patchJson)
+    {
+        patch::apply(document, parse_patch_text(patchJson));
+    }
+
+    void merge(std::shared_ptr<JsonObject> &document, const std::shared_ptr<JsonObject> &mergePatch)
+    {
+        document = merge_into(document, mergePatch);
+    }
+
+    void merge(std::shared_ptr<JsonObject> &document, const std::string &mergePatchJson)
+    {
+        patch::merge(document, parse_patch_text(mergePatchJson));
+    }
+}
@@ -0,0 +1,118 @@
+#include <stdexcept>
+
+#include "../includes/pointer.hpp"
+#include "../includes/error.hpp"
+
+namespace hh_json::pointer
+{
+    bool try_parse(const std::string &pointer, std::vector<std::string> &tokens)
+    {
+        tokens.clear();
+        if (pointer.empty())
+        {
+            return true;
+        }
+        if (pointer[0] != '/')
+        {
+            return false;
+        }
+
+        std::string token;
+        for (size_t i = 1; i <= pointer.size(); ++i)
+        {
+            if (i == pointer.size() || pointer[i] == '/')
+            {
+                tokens.push_back(std::move(token));
+                token.clear();
+            }
+            else if (pointer[i] == '~')
+            {
+                char next = i + 1 < pointer.size() ? pointer[i + 1] : '\0';
+                if (next == '0')
+                    token += '~';
+                else if (next == '1')
+                    token += '/';
+                else
+                    return false;
+                ++i;
+            }
+            else
+            {
+                token += pointer[i];
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::string> parse(const std::string &pointer)
+    {
+        std::vector<std::string> tokens;
+        if (!try_parse(pointer, tokens))
+        {
+            if (pointer[0] != '/')
+                HH_JSON_THROW(std::runtime_error("JSON pointer must start with '/': " + pointer));
+            HH_JSON_THROW(std::runtime_error("Invalid escape in JSON pointer: " + pointer));
+        }
+        return tokens;
+    }
+
+    std::string escape(const std::string &token)
+    {
+        std::string result;
+        result.reserve(token.size());
+        for (char c : token)
+        {
+            if (c == '~')
+                result += "~0";
+            else if (c == '/')
+                result += "~1";
+            else
+                result += c;
+        }
+        return result;
+    }
+
+    void append(std::string &pointer, const std::string &token)
+    {
+        pointer += '/';
+        pointer += escape(token);
+    }
+
+    bool try_array_index(const std::string &token, size_t size, size_t &index)
+    {
+        if (token == "-")
+        {
+            index = size;
+            return true;
+        }
+        if (token.empty() || (token.size() > 1 && token[0] == '0'))
+        {
+            return false;
+        }
+
+        index = 0;
+        for (char c : token)
+        {
+            if (c < '0' || c > '9' || index > (size + 1) / 10 + 1)
+            {
+                return false;
+            }
+            index = index * 10 + static_cast<size_t>(c - '0');
+        }
+        return index <= size;
+    }
+
+    size_t array_index(const std::string &token, size_t size)
+    {
+        size_t index = 0;
+        if (!try_array_index(token, size, index))
+        {
+            bool digits = !token.empty() && token.find_first_not_of("0123456789") == std::string::npos &&
+                          (token.size() == 1 || token[0] != '0');
+            if (!digits)
+                HH_JSON_THROW(std::runtime_error("Invalid array index in JSON pointer: " + token));
+            HH_JSON_THROW(std::runtime_error("Array index out of range: " + token));
+        }
+        return index;
+    }
+}
@@ -0,0 +1,201 @@
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "../includes/pool.hpp"
+
+namespace hh_json::pool
+{
+    namespace
+    {
+        std::atomic<size_t> per_thread_limit{Limits().per_thread};
+        std::atomic<size_t> global_limit{Limits().global};
+
+        // Larger bucket arrays are dropped when a document comes back
+        constexpr size_t max_retained_buckets = 4096;
+
+        template <typename T>
+        struct Overflow
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<T>> items;
+        };
+
+        struct Global
+        {
+            Overflow<Parser> parsers;
+            Overflow<JsonObject> documents;
+        };
+
+        Global &global()
+        {
+            static Global instance;
+            return instance;
+        }
+
+        template <typename T>
+        void overflow(Overflow<T> &shared, std::unique_ptr<T> item)
+        {
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (shared.items.size() < global_limit.load(std::memory_order_relaxed))
+            {
+                shared.items.push_back(std::move(item));
+                return;
+            }
+            // Otherwise item is freed as this returns, after the lock is released
+        }
+
+        template <typename T>
+        std::unique_ptr<T> take(std::vector<std::unique_ptr<T>> &local, Overflow<T> &shared)
+        {
+            std::unique_ptr<T> item;
+            if (!local.empty())
+            {
+                item = std::move(local.back());
+                local.pop_back();
+                return item;
+            }
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (!shared.items.empty())
+            {
+                item = std::move(shared.items.back());
+                shared.items.pop_back();
+            }
+            return item;
+        }
+
+        template <typename T>
+        void put(std::vector<std::unique_ptr<T>> &local, Overflow<T> &shared, std::unique_ptr<T> item)
+        {
+            if (local.size() < per_thread_limit.load(std::memory_order_relaxed))
+            {
+                local.push_back(std::move(item));
+            }
+            else
+            {
+                overflow(shared, std::move(item));
+            }
+        }
+
+        template <typename T>
+        size_t size(Overflow<T> &shared)
+        {
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            return shared.items.size();
+        }
+
+        // Idle items of one thread. On thread exit they move to the overflow, so their warm
+        // buffers serve the threads that remain.
+        struct LocalLists
+        {
+            std::vector<std::unique_ptr<Parser>> parsers;
+            std::vector<std::unique_ptr<JsonObject>> documents;
+
+            ~LocalLists()
+            {
+                Global &shared = global();
+                for (auto &parser : parsers)
+                {
+                    overflow(shared.parsers, std::move(parser));
+                }
+                for (auto &document : documents)
+                {
+                    overflow(shared.documents, std::move(document));
+                }
+            }
+        };
+
+        LocalLists &local()
+        {
+            // The global lists are created first, so they outlive every thread's lists
+            global();
+            thread_local LocalLists lists;
+            return lists;
+        }
+    }
+
+    namespace detail
+    {
+        void give_back(std::unique_ptr<Parser> parser)
+        {
+            // Recycle the last result now; nodes the caller still holds stay theirs
+            parser->reset();
+            put(local().parsers, global().parsers, std::move(parser));
+        }
+
+        void give_back(std::unique_ptr<JsonObject> document)
+        {
+            document->clear();
+            if (document->get_data().bucket_count() > max_retained_buckets)
+            {
+                document->reserve(0);
+            }
+            put(local().documents, global().documents, std::move(document));
+        }
+    }
+
+    Lease<Parser> acquire(const ParseOptions &options)
+    {
+        auto parser = take(local().parsers, global().parsers);
+        if (parser)
+        {
+            parser->set_options(options);
+        }
+        else
+        {
+            parser = std::make_unique<Parser>(options);
+        }
+        return Lease<Parser>(std::move(parser));
+    }
+
+    Lease<JsonObject> acquire_document()
+    {
+        auto document = take(local().documents, global().documents);
+        if (!document)
+        {
+            document = std::make_unique<JsonObject>();
+        }
+        return Lease<JsonObject>(std::move(document));
+    }
+
+    void set_limits(const Limits &limits)
+    {
+        per_thread_limit.store(limits.per_thread, std::memory_order_relaxed);
+        global_limit.store(limits.global, std::memory_order_relaxed);
+    }
+
+    Limits limits()
+    {
+        return {per_thread_limit.load(std::memory_order_relaxed), global_limit.load(std::memory_order_relaxed)};
+    }
+
+    Usage usage()
+    {
+        LocalLists &lists = local();
+        Global &shared = global();
+        Usage result;
+        result.local_parsers = lists.parsers.size();
+        result.local_documents = lists.documents.size();
+        result.global_parsers = size(shared.parsers);
+        result.global_documents = size(shared.documents);
+        return result;
+    }
+
+    void trim()
+    {
+        LocalLists &lists = local();
+        lists.parsers.clear();
+        lists.documents.clear();
+        Global &shared = global();
+        std::vector<std::unique_ptr<Parser>> parsers;
+        std::vector<std::unique_ptr<JsonObject>> documents;
+        {
+            std::lock_guard<std::mutex> lock(shared.parsers.mutex);
+            parsers.swap(shared.parsers.items);
+        }
+        {
+            std::lock_guard<std::mutex> lock(shared.documents.mutex);
+            documents.swap(shared.documents.items);
+        }
+    }
+}
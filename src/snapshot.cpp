@@ -0,0 +1,564 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../includes/snapshot.hpp"
+#include "../includes/JsonArray.hpp"
+#include "../includes/JsonString.hpp"
+#include "../includes/JsonNumber.hpp"
+#include "../includes/JsonBoolean.hpp"
+#include "../includes/healpers.hpp"
+
+namespace hh_json::snapshot
+{
+    namespace
+    {
+        // Version 2: keys are stored as their text rather than the DOM's escaped form
+        constexpr char magic[8] = {'H', 'H', 'J', 'S', 'N', 'A', 'P', '2'};
+        constexpr uint32_t byte_order_mark = 0x01020304;
+        constexpr uint32_t flag_sorted_keys = 1;
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t byte_order;
+            uint32_t flags;
+            uint64_t entries_offset;
+            uint64_t entry_count;
+            uint64_t members_offset;
+            uint64_t member_count;
+            uint64_t strings_offset;
+            uint64_t strings_size;
+            Entry root;
+        };
+
+        static_assert(sizeof(Entry) == 16, "snapshot entries must be 16 bytes");
+        static_assert(sizeof(Member) == 32, "snapshot members must be 32 bytes");
+        static_assert(sizeof(Header) == 80, "snapshot header must be 80 bytes");
+
+        // Entry and member counts are 32-bit; larger values cannot be stored
+        uint32_t count32(size_t count, const char *what)
+        {
+            if (count > UINT32_MAX)
+            {
+                HH_JSON_THROW(std::runtime_error(std::string("Snapshot cannot hold ") + what + " of 2^32 or more"));
+            }
+            return static_cast<uint32_t>(count);
+        }
+
+        uint64_t align16(uint64_t offset)
+        {
+            return (offset + 15) & ~uint64_t(15);
+        }
+
+        class Writer
+        {
+        public:
+            explicit Writer(bool index_keys) : index_keys(index_keys) {}
+
+            std::vector<Entry> entries;
+            std::vector<Member> members;
+            std::string strings;
+
+            Entry encode(const std::shared_ptr<JsonObject> &value)
+            {
+                Entry entry{static_cast<uint32_t>(getter::get_type(value)), 0, 0};
+                switch (getter::get_type(value))
+                {
+                case JsonType::Null:
+                    break;
+                case JsonType::Boolean:
+                    entry.payload = static_cast<const JsonBoolean &>(*value).value ? 1 : 0;
+                    break;
+                case JsonType::Number:
+                {
+                    double number = static_cast<const JsonNumber &>(*value).number();
+                    std::memcpy(&entry.payload, &number, sizeof(number));
+                    break;
+                }
+                case JsonType::String:
+                {
+                    const auto &str = static_cast<const JsonString &>(*value).str();
+                    entry.count = count32(str.size(), "a string");
+                    entry.payload = add_string(str);
+                    break;
+                }
+                case JsonType::Array:
+                {
+                    const auto &elements = static_cast<const JsonArray &>(*value).elements;
+                    entry.count = count32(elements.size(), "an array");
+                    size_t first = entries.size();
+                    entries.resize(first + elements.size());
+                    for (size_t i = 0; i < elements.size(); ++i)
+                    {
+                        Entry child = encode(elements[i]);
+                        entries[first + i] = child;
+                    }
+                    entry.payload = first;
+                    break;
+                }
+                case JsonType::Object:
+                {
+                    const auto &data = value->get_data();
+                    entry.count = count32(data.size(), "an object");
+                    // Keys are written as their text; decoded holds the few that were escaped
+                    std::vector<std::pair<std::string_view, const std::shared_ptr<JsonObject> *>> order;
+                    std::vector<std::string> decoded;
+                    order.reserve(data.size());
+                    decoded.reserve(data.size());
+                    for (const auto &[key, item] : data)
+                    {
+                        if (key.find('\\') == std::string::npos)
+                        {
+                            order.emplace_back(key, &item);
+                        }
+                        else
+                        {
+                            decoded.push_back(detail::unescape_key(key));
+                            order.emplace_back(decoded.back(), &item);
+                        }
+                    }
+                    if (index_keys)
+                    {
+                        std::sort(order.begin(), order.end(), [](const auto &a, const auto &b)
+                                  { return a.first < b.first; });
+                    }
+
+                    size_t first = members.size();
+                    members.resize(first + order.size());
+                    for (size_t i = 0; i < order.size(); ++i)
+                    {
+                        Member member{};
+                        member.key_offset = add_key(order[i].first);
+                        member.key_length = count32(order[i].first.size(), "a key");
+                        member.value = encode(*order[i].second);
+                        members[first + i] = member;
+                    }
+                    entry.payload = first;
+                    break;
+                }
+                }
+                return entry;
+            }
+
+        private:
+            bool index_keys;
+            std::unordered_map<std::string, uint64_t> key_offsets; // keys repeat across records, store each once
+            std::string lookup;
+
+            uint64_t add_string(std::string_view str)
+            {
+                uint64_t offset = strings.size();
+                strings.append(str);
+                return offset;
+            }
+
+            uint64_t add_key(std::string_view key)
+            {
+                lookup.assign(key.data(), key.size()); // reused, so repeated keys do not allocate
+                auto it = key_offsets.find(lookup);
+                if (it != key_offsets.end())
+                {
+                    return it->second;
+                }
+                uint64_t offset = add_string(key);
+                key_offsets.emplace(lookup, offset);
+                return offset;
+            }
+        };
+
+        template <typename T>
+        void append_bytes(std::string &out, const T *data, size_t count)
+        {
+            out.append(reinterpret_cast<const char *>(data), sizeof(T) * count);
+        }
+
+        bool section_fits(uint64_t offset, uint64_t count, uint64_t element_size, uint64_t length)
+        {
+            return offset <= length && count <= (length - offset) / element_size;
+        }
+    }
+
+    void write(const std::shared_ptr<JsonObject> &root, std::string &out, bool index_keys)
+    {
+        Writer writer(index_keys);
+        Entry root_entry = writer.encode(root);
+
+        Header header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.byte_order = byte_order_mark;
+        header.flags = index_keys ? flag_sorted_keys : 0;
+        header.entries_offset = sizeof(Header);
+        header.entry_count = writer.entries.size();
+        header.members_offset = align16(header.entries_offset + writer.entries.size() * sizeof(Entry));
+        header.member_count = writer.members.size();
+        header.strings_offset = align16(header.members_offset + writer.members.size() * sizeof(Member));
+        header.strings_size = writer.strings.size();
+        header.root = root_entry;
+
+        size_t start = out.size();
+        out.reserve(start + header.strings_offset + header.strings_size);
+        append_bytes(out, &header, 1);
+        append_bytes(out, writer.entries.data(), writer.entries.size());
+        out.resize(start + header.members_offset, '\0');
+        append_bytes(out, writer.members.data(), writer.members.size());
+        out.resize(start + header.strings_offset, '\0');
+        out.append(writer.strings);
+    }
+
+    std::string write(const std::shared_ptr<JsonObject> &root, bool index_keys)
+    {
+        std::string out;
+        write(root, out, index_keys);
+        return out;
+    }
+
+    void write_file(const std::shared_ptr<JsonObject> &root, const std::string &path, bool index_keys)
+    {
+        std::string image = write(root, index_keys);
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        if (!ofs || !ofs.write(image.data(), static_cast<std::streamsize>(image.size())))
+        {
+            HH_JSON_THROW(std::runtime_error("Failed to write snapshot file: " + path));
+        }
+    }
+
+    // ------------------------------------------------------------------ Image
+
+    std::shared_ptr<const Image> Image::from_buffer(std::string bytes)
+    {
+        std::shared_ptr<Image> image(new Image());
+        image->storage.resize((bytes.size() + 7) / 8);
+        if (!bytes.empty())
+        {
+            std::memcpy(image->storage.data(), bytes.data(), bytes.size());
+        }
+        image->base = reinterpret_cast<const unsigned char *>(image->storage.data());
+        image->length = bytes.size();
+        image->load();
+        return image;
+    }
+
+    std::shared_ptr<const Image> Image::open(const std::string &path)
+    {
+#if defined(_WIN32)
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs)
+        {
+            HH_JSON_THROW(std::runtime_error("Failed to open snapshot file: " + path));
+        }
+        return from_buffer(std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()));
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            HH_JSON_THROW(std::runtime_error("Failed to open snapshot file: " + path));
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            HH_JSON_THROW(std::runtime_error("Invalid snapshot file: " + path));
+        }
+        void *mapping = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            HH_JSON_THROW(std::runtime_error("Failed to map snapshot file: " + path));
+        }
+
+        std::shared_ptr<Image> image(new Image());
+        image->base = static_cast<const unsigned char *>(mapping);
+        image->length = static_cast<size_t>(st.st_size);
+        image->is_mapped = true;
+        image->load();
+        return image;
+#endif
+    }
+
+    Image::~Image()
+    {
+#if !defined(_WIN32)
+        if (is_mapped)
+        {
+            ::munmap(const_cast<unsigned char *>(base), length);
+        }
+#endif
+    }
+
+    void Image::load()
+    {
+        if (length < sizeof(Header))
+        {
+            HH_JSON_THROW(std::runtime_error("Snapshot image is truncated"));
+        }
+        Header header;
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+        {
+            HH_JSON_THROW(std::runtime_error("Not a snapshot image"));
+        }
+        if (header.byte_order != byte_order_mark)
+        {
+            HH_JSON_THROW(std::runtime_error("Snapshot image was written with a different byte order"));
+        }
+        if (header.entries_offset % 16 != 0 || header.members_offset % 16 != 0 ||
+            !section_fits(header.entries_offset, header.entry_count, sizeof(Entry), length) ||
+            !section_fits(header.members_offset, header.member_count, sizeof(Member), length) ||
+            !section_fits(header.strings_offset, header.strings_size, 1, length))
+        {
+            HH_JSON_THROW(std::runtime_error("Snapshot image sections are out of bounds"));
+        }
+
+        sorted_keys = (header.flags & flag_sorted_keys) != 0;
+        entries = reinterpret_cast<const Entry *>(base + header.entries_offset);
+        entry_count = header.entry_count;
+        members = reinterpret_cast<const Member *>(base + header.members_offset);
+        member_count = header.member_count;
+        strings = reinterpret_cast<const char *>(base + header.strings_offset);
+        strings_size = header.strings_size;
+        root_entry = header.root;
+    }
+
+    std::string_view Image::string_at(uint64_t offset, uint64_t count) const
+    {
+        if (!section_fits(offset, count, 1, strings_size))
+        {
+            HH_JSON_THROW(std::runtime_error("Snapshot string is out of bounds"));
+        }
+        return std::string_view(strings + offset, static_cast<size_t>(count));
+    }
+
+    View Image::root() const
+    {
+        return View(this, &root_entry);
+    }
+
+    size_t Image::size() const
+    {
+        return length;
+    }
+
+    bool Image::mapped() const
+    {
+        return is_mapped;
+    }
+
+    // ------------------------------------------------------------------- View
+
+    View::operator bool() const
+    {
+        return entry != nullptr;
+    }
+
+    JsonType View::type() const
+    {
+        return entry ? static_cast<JsonType>(entry->type) : JsonType::Null;
+    }
+
+    size_t View::size() const
+    {
+        auto t = type();
+        return (t == JsonType::Array || t == JsonType::Object) ? entry->count : 0;
+    }
+
+    View View::get(std::string_view key) const
+    {
+        if (type() != JsonType::Object)
+        {
+            return View();
+        }
+        if (!section_fits(entry->payload, entry->count, 1, image->member_count))
+        {
+            HH_JSON_THROW(std::runtime_error("Snapshot object is out of bounds"));
+        }
+
+        const Member *first = image->members + entry->payload;
+        const Member *last = first + entry->count;
+        if (image->sorted_keys)
+        {
+            auto it = std::lower_bound(first, last, key, [this](const Member &m, std::string_view k)
+                                       { return image->string_at(m.key_offset, m.key_length) < k; });
+            if (it != last && image->string_at(it->key_offset, it->key_length) == key)
+            {
+                return View(image, &it->value);
+            }
+            return View();
+        }
+        for (const Member *m = first; m != last; ++m)
+        {
+            if (image->string_at(m->key_offset, m->key_length) == key)
+            {
+                return View(image, &m->value);
+            }
+        }
+        return View();
+    }
+
+    bool View::has_key(std::string_view key) const
+    {
+        return static_cast<bool>(get(key));
+    }
+
+    View View::at(size_t index) const
+    {
+        auto t = type();
+        if (index >= size())
+        {
+            return View();
+        }
+        if (t == JsonType::Array)
+        {
+            if (!section_fits(entry->payload, entry->count, 1, image->entry_count))
+            {
+                HH_JSON_THROW(std::runtime_error("Snapshot array is out of bounds"));
+            }
+            return View(image, image->entries + entry->payload + index);
+        }
+        if (!section_fits(entry->payload, entry->count, 1, image->member_count))
+        {
+            HH_JSON_THROW(std::runtime_error("Snapshot object is out of bounds"));
+        }
+        return View(image, &image->members[entry->payload + index].value);
+    }
+
+    std::string_view View::key_at(size_t index) const
+    {
+        if (type() != JsonType::Object || index >= size())
+        {
+            HH_JSON_THROW(std::runtime_error("Snapshot key index out of range"));
+        }
+        if (!section_fits(entry->payload, entry->count, 1, image->member_count))
+        {
+            HH_JSON_THROW(std::runtime_error("Snapshot object is out of bounds"));
+        }
+        const Member &member = image->members[entry->payload + index];
+        return image->string_at(member.key_offset, member.key_length);
+    }
+
+    bool View::get_boolean() const
+    {
+        if (type() != JsonType::Boolean || !entry)
+        {
+            HH_JSON_THROW(std::runtime_error("Not a boolean"));
+        }
+        return entry->payload != 0;
+    }
+
+    double View::get_number() const
+    {
+        if (type() != JsonType::Number || !entry)
+        {
+            HH_JSON_THROW(std::runtime_error("Not a number"));
+        }
+        double value;
+        std::memcpy(&value, &entry->payload, sizeof(value));
+        return value;
+    }
+
+    std::string_view View::get_string() const
+    {
+        if (type() != JsonType::String || !entry)
+        {
+            HH_JSON_THROW(std::runtime_error("Not a string"));
+        }
+        return image->string_at(entry->payload, entry->count);
+    }
+
+    void View::stringify_to(std::string &out) const
+    {
+        switch (type())
+        {
+        case JsonType::Null:
+            out += "null";
+            break;
+        case JsonType::Boolean:
+            out += get_boolean() ? "true" : "false";
+            break;
+        case JsonType::Number:
+            JsonNumber(get_number()).stringify_to(out);
+            break;
+        case JsonType::String:
+            out += '"';
+            detail::append_escaped(out, get_string());
+            out += '"';
+            break;
+        case JsonType::Array:
+            out += '[';
+            for (size_t i = 0; i < size(); ++i)
+            {
+                if (i)
+                    out += ',';
+                at(i).stringify_to(out);
+            }
+            out += ']';
+            break;
+        case JsonType::Object:
+            // Same shape as JsonObject::stringify
+            out += '{';
+            for (size_t i = 0; i < size(); ++i)
+            {
+                if (i)
+                    out += ',';
+                out += '"';
+                detail::append_escaped(out, key_at(i));
+                out += "\": ";
+                at(i).stringify_to(out);
+            }
+            out += '}';
+            break;
+        }
+    }
+
+    std::string View::stringify() const
+    {
+        std::string out;
+        stringify_to(out);
+        return out;
+    }
+
+    std::shared_ptr<JsonObject> View::materialize() const
+    {
+        switch (type())
+        {
+        case JsonType::Null:
+            return nullptr;
+        case JsonType::Boolean:
+            return std::make_shared<JsonBoolean>(get_boolean());
+        case JsonType::Number:
+            return std::make_shared<JsonNumber>(get_number());
+        case JsonType::String:
+            return std::make_shared<JsonString>(std::string(get_string()));
+        case JsonType::Array:
+        {
+            auto array = std::make_shared<JsonArray>();
+            array->elements.reserve(size());
+            for (size_t i = 0; i < size(); ++i)
+            {
+                array->insert(at(i).materialize());
+            }
+            return array;
+        }
+        case JsonType::Object:
+        {
+            auto object = std::make_shared<JsonObject>();
+            for (size_t i = 0; i < size(); ++i)
+            {
+                object->insert(detail::escape_key(key_at(i)), at(i).materialize());
+            }
+            return object;
+        }
+        }
+        return nullptr;
+    }
+}
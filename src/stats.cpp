@@ -0,0 +1,64 @@
+#include <mutex>
+#include <utility>
+
+#include "../includes/stats.hpp"
+
+namespace hh_json::stats
+{
+    namespace
+    {
+        std::mutex hook_mutex;
+        Hook installed_hook;
+
+        thread_local unsigned serialize_depth = 0;
+    }
+
+    void set_hook(Hook hook)
+    {
+        std::lock_guard<std::mutex> lock(hook_mutex);
+        installed_hook = std::move(hook);
+    }
+
+    namespace detail
+    {
+        void report(const Stats &stats)
+        {
+            Hook hook;
+            {
+                std::lock_guard<std::mutex> lock(hook_mutex);
+                hook = installed_hook;
+            }
+            // Called outside the lock so the hook may itself parse or replace the hook
+            if (hook)
+            {
+                hook(stats);
+            }
+        }
+
+        SerializeScope::SerializeScope() : outermost(serialize_depth++ == 0)
+        {
+            if (outermost)
+            {
+                start = now_ns();
+            }
+        }
+
+        SerializeScope::~SerializeScope()
+        {
+            --serialize_depth;
+        }
+
+        void SerializeScope::finish(const std::string &output)
+        {
+            if (!outermost)
+            {
+                return;
+            }
+            Stats stats;
+            stats.operation = Operation::Serialize;
+            stats.serialize_ns = now_ns() - start;
+            stats.output_bytes = output.size();
+            report(stats);
+        }
+    }
+}
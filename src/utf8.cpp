@@ -0,0 +1,189 @@
+#include "../includes/utf8.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HH_JSON_UTF8_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define HH_JSON_UTF8_NEON 1
+#endif
+
+#if defined(_MSC_VER) && defined(HH_JSON_UTF8_SSE2)
+#include <intrin.h>
+#endif
+
+namespace hh_json::utf8
+{
+    namespace
+    {
+#if defined(HH_JSON_UTF8_SSE2)
+        inline unsigned first_set_bit(unsigned mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+#endif
+
+        inline bool is_stop(unsigned char c, bool json_specials)
+        {
+            return c >= 0x80 || (json_specials && (c == '"' || c == '\\' || c < 0x20));
+        }
+
+        // Leading bytes below 0x80 (and, with json_specials, other than '"', '\\' and controls)
+        size_t scan(const char *data, size_t length, bool json_specials)
+        {
+            size_t i = 0;
+#if defined(HH_JSON_UTF8_SSE2)
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i space = _mm_set1_epi8(0x20);
+            for (; i + 16 <= length; i += 16)
+            {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                // movemask picks the high bit: set for non-ASCII bytes and for matched specials
+                __m128i stop = chunk;
+                if (json_specials)
+                {
+                    // The signed compare is also true for bytes >= 0x80, which stop anyway
+                    stop = _mm_or_si128(stop, _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+                    stop = _mm_or_si128(stop, _mm_cmplt_epi8(chunk, space));
+                }
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(stop));
+                if (mask)
+                {
+                    return i + first_set_bit(mask);
+                }
+            }
+#elif defined(HH_JSON_UTF8_NEON)
+            const uint8x16_t high = vdupq_n_u8(0x80);
+            const uint8x16_t quote = vdupq_n_u8('"');
+            const uint8x16_t backslash = vdupq_n_u8('\\');
+            const uint8x16_t space = vdupq_n_u8(0x20);
+            for (; i + 16 <= length; i += 16)
+            {
+                uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(data + i));
+                uint8x16_t stop = vcgeq_u8(chunk, high);
+                if (json_specials)
+                {
+                    stop = vorrq_u8(stop, vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)));
+                    stop = vorrq_u8(stop, vcltq_u8(chunk, space));
+                }
+                if (vmaxvq_u8(stop))
+                {
+                    break; // the scalar loop finds the exact byte
+                }
+            }
+#endif
+            for (; i < length; ++i)
+            {
+                if (is_stop(static_cast<unsigned char>(data[i]), json_specials))
+                {
+                    return i;
+                }
+            }
+            return length;
+        }
+
+        inline bool continuation(unsigned char c)
+        {
+            return (c & 0xC0) == 0x80;
+        }
+    }
+
+    size_t plain_prefix(const char *data, size_t length)
+    {
+        return scan(data, length, true);
+    }
+
+    size_t sequence_length(const char *data, size_t length)
+    {
+        if (length == 0)
+        {
+            return 0;
+        }
+        const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+        unsigned char lead = bytes[0];
+
+        if (lead < 0x80)
+        {
+            return 1;
+        }
+        if (lead < 0xC2)
+        {
+            return 0; // continuation byte or overlong 2-byte form
+        }
+        if (lead < 0xE0)
+        {
+            return length >= 2 && continuation(bytes[1]) ? 2 : 0;
+        }
+        if (lead < 0xF0)
+        {
+            // E0 needs A0..BF (no overlongs), ED needs 80..9F (no surrogates)
+            unsigned char low = lead == 0xE0 ? 0xA0 : 0x80;
+            unsigned char high = lead == 0xED ? 0x9F : 0xBF;
+            return length >= 3 && bytes[1] >= low && bytes[1] <= high && continuation(bytes[2]) ? 3 : 0;
+        }
+        if (lead < 0xF5)
+        {
+            // F0 needs 90..BF (no overlongs), F4 needs 80..8F (at most U+10FFFF)
+            unsigned char low = lead == 0xF0 ? 0x90 : 0x80;
+            unsigned char high = lead == 0xF4 ? 0x8F : 0xBF;
+            return length >= 4 && bytes[1] >= low && bytes[1] <= high && continuation(bytes[2]) && continuation(bytes[3]) ? 4 : 0;
+        }
+        return 0;
+    }
+
+    bool validate(const char *data, size_t length, size_t *error_offset)
+    {
+        size_t i = 0;
+        while (true)
+        {
+            i += scan(data + i, length - i, false);
+            if (i >= length)
+            {
+                return true;
+            }
+            size_t n = sequence_length(data + i, length - i);
+            if (n == 0)
+            {
+                if (error_offset)
+                {
+                    *error_offset = i;
+                }
+                return false;
+            }
+            i += n;
+        }
+    }
+
+    void append(std::string &out, uint32_t code_point)
+    {
+        if (code_point < 0x80)
+        {
+            out += static_cast<char>(code_point);
+        }
+        else if (code_point < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (code_point >> 6));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        else if (code_point < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (code_point >> 12));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (code_point >> 18));
+            out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+    }
+}
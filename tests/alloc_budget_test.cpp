@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+using namespace hh_json;
+
+// Replaces the global operator new for the whole test binary. Counting is always on and
+// costs one relaxed atomic add per allocation; AllocationCount measures a window of it.
+namespace
+{
+    std::atomic<size_t> allocation_count{0};
+    std::atomic<size_t> allocation_bytes{0};
+
+    struct AllocationCount
+    {
+        size_t count = allocation_count.load();
+        size_t bytes = allocation_bytes.load();
+
+        size_t allocations() const { return allocation_count.load() - count; }
+        size_t allocated_bytes() const { return allocation_bytes.load() - bytes; }
+    };
+
+    // About 1 KB: 60 short keys with numbers, strings and booleans
+    std::string flat_object()
+    {
+        std::string json = "{";
+        for (int i = 0; i < 60; ++i)
+        {
+            if (i)
+                json += ", ";
+            json += "\"key" + std::to_string(i) + "\": ";
+            if (i % 3 == 0)
+                json += std::to_string(i * 1000);
+            else if (i % 3 == 1)
+                json += "\"value " + std::to_string(i) + "\"";
+            else
+                json += i % 2 ? "true" : "false";
+        }
+        json += "}";
+        return json;
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+class AllocBudgetTest : public ::testing::Test
+{
+};
+
+TEST_F(AllocBudgetTest, ParseFlatObject)
+{
+    std::string json = flat_object();
+    ASSERT_GT(json.size(), 900u);
+    ASSERT_LT(json.size(), 1200u);
+
+    AllocationCount window;
+    auto parsed = parse(json);
+    size_t allocations = window.allocations();
+    size_t bytes = window.allocated_bytes();
+    ASSERT_EQ(parsed.size(), 60u);
+
+    // One node and one map entry per member, plus the preprocessing copies, the parse stack
+    // and bucket growth. Keys and values here fit the small-string buffer.
+    EXPECT_LE(allocations, 2 * parsed.size() + 16);
+    EXPECT_LE(bytes, 24 * json.size());
+}
+
+TEST_F(AllocBudgetTest, ParseDoesNotCopyPerCharacter)
+{
+    // A long string value is decoded straight into its node: a bounded number of buffer growths
+    std::string json = "{\"text\": \"" + std::string(64 * 1024, 'x') + "\"}";
+    AllocationCount window;
+    auto parsed = parse(json);
+    ASSERT_EQ(getter::get_string_view(parsed["text"]).size(), 64u * 1024);
+    EXPECT_LE(window.allocations(), 32u);
+}
+
+TEST_F(AllocBudgetTest, ReusedParserReachesZeroAllocations)
+{
+    std::string flat = flat_object();
+    std::string nested = R"({"user": {"id": 7, "name": "a name longer than the small-string buffer",
+        "roles": ["admin", "ops"]}, "items": [{"sku": 1, "qty": 2.5}, {"sku": 2, "qty": 1}], "ok": true})";
+    // Pooled nodes are handed out in varying order, so it takes a few rounds until every
+    // buffer has grown to the largest content it receives
+    Parser parser;
+    for (int i = 0; i < 32; ++i)
+    {
+        ASSERT_TRUE(parser.parse(flat));
+        ASSERT_TRUE(parser.parse(nested));
+    }
+
+    AllocationCount window;
+    for (int i = 0; i < 10; ++i)
+    {
+        // Each result is released before the next parse, which then takes its nodes back
+        {
+            auto first = parser.parse(flat);
+            ASSERT_TRUE(first);
+            ASSERT_EQ((*first)->get_data().size(), 60u);
+        }
+        auto second = parser.parse(nested);
+        ASSERT_TRUE(second);
+    }
+    EXPECT_EQ(window.allocations(), 0u);
+}
+
+TEST_F(AllocBudgetTest, PooledParserDoesNotAllocate)
+{
+    std::string json = flat_object();
+    for (int i = 0; i < 4; ++i)
+    {
+        auto parser = pool::acquire();
+        ASSERT_TRUE(parser->parse(json));
+    }
+
+    AllocationCount window;
+    for (int i = 0; i < 10; ++i)
+    {
+        auto parser = pool::acquire();
+        auto result = parser->parse(json);
+        ASSERT_TRUE(result);
+        ASSERT_EQ((*result)->get_data().size(), 60u);
+    }
+    EXPECT_EQ(window.allocations(), 0u);
+}
+
+TEST_F(AllocBudgetTest, StringifyAllocatesOnlyTheResult)
+{
+    auto root = JsonValue(flat_object());
+    ASSERT_NE(root, nullptr);
+    std::string warm = root->stringify(); // sizes this thread's scratch buffer
+
+    AllocationCount window;
+    std::string text = root->stringify();
+    EXPECT_EQ(window.allocations(), 1u);
+    EXPECT_EQ(window.allocated_bytes(), text.size() + 1);
+    EXPECT_EQ(text, warm);
+}
+
+TEST_F(AllocBudgetTest, StringifyToReservedBufferDoesNotAllocate)
+{
+    auto root = JsonValue(R"({"list": [1, 2.5, "a\nb", true, null], "nested": {"k": "v"}})");
+    ASSERT_NE(root, nullptr);
+    std::string expected = root->stringify();
+
+    std::string out;
+    out.reserve(expected.size());
+    AllocationCount window;
+    root->stringify_to(out);
+    EXPECT_EQ(window.allocations(), 0u);
+    EXPECT_EQ(out, expected);
+}
+
+TEST_F(AllocBudgetTest, Insert)
+{
+    JsonObject object;
+    object.reserve(8);
+    auto value = maker::make_number(1);
+    std::string key = "a key that does not fit the small buffer";
+
+    AllocationCount window;
+    object.insert(std::move(key), value);
+    // Only the map entry; the key's buffer is moved in
+    EXPECT_EQ(window.allocations(), 1u);
+
+    AllocationCount replace;
+    object.insert("a key that does not fit the small buffer", value);
+    // The temporary key; the existing entry is reused
+    EXPECT_EQ(replace.allocations(), 1u);
+
+    JsonArray array;
+    array.elements.reserve(4);
+    AllocationCount append;
+    array.insert(value);
+    EXPECT_EQ(append.allocations(), 0u);
+}
+
+TEST_F(AllocBudgetTest, GettersDoNotAllocate)
+{
+    auto root = JsonValue(R"({"n": 4, "s": "a string longer than the small-string buffer", "b": true, "a": [1, 2], "o": {"k": 1}})");
+    ASSERT_NE(root, nullptr);
+    auto n = root->get("n");
+    auto s = root->get("s");
+    auto b = root->get("b");
+    auto a = root->get("a");
+    auto o = root->get("o");
+
+    AllocationCount window;
+    EXPECT_EQ(getter::get_number(n), 4);
+    EXPECT_EQ(getter::get_string_view(s).size(), 44u);
+    EXPECT_EQ(getter::get_string_ref(s).size(), 44u);
+    EXPECT_TRUE(getter::get_boolean(b));
+    EXPECT_EQ(getter::get_array_ref(a).size(), 2u);
+    EXPECT_EQ(getter::get_object(o).size(), 1u);
+    EXPECT_NE(root->get("a"), nullptr);
+    EXPECT_EQ(window.allocations(), 0u);
+}
@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+
+// Built as C++20 by the json_parser_async_tests target; empty in the C++17 test binary
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace hh_json;
+
+namespace
+{
+    // Single-threaded event loop: every suspension queues its coroutine to be resumed later
+    struct Loop
+    {
+        std::deque<std::coroutine_handle<>> ready;
+        size_t turns = 0;
+
+        struct Schedule
+        {
+            Loop &loop;
+            bool await_ready() { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { loop.ready.push_back(handle); }
+            void await_resume() {}
+        };
+
+        Schedule schedule() { return {*this}; }
+
+        void run()
+        {
+            while (!ready.empty())
+            {
+                auto handle = ready.front();
+                ready.pop_front();
+                ++turns;
+                handle.resume();
+            }
+        }
+    };
+
+    // Body arriving in chunks, each read completing on a later turn of the loop
+    struct ChunkSource
+    {
+        Loop &loop;
+        std::vector<std::string> chunks;
+        size_t next = 0;
+        size_t yields = 0;
+
+        struct Read
+        {
+            ChunkSource &source;
+            bool await_ready() { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { source.loop.ready.push_back(handle); }
+            std::string_view await_resume()
+            {
+                return source.next < source.chunks.size() ? std::string_view(source.chunks[source.next++]) : std::string_view();
+            }
+        };
+
+        Read read() { return {*this}; }
+        Loop::Schedule yield()
+        {
+            ++yields;
+            return loop.schedule();
+        }
+    };
+
+    struct StringSink
+    {
+        Loop &loop;
+        std::string text = {};
+        size_t writes = 0;
+
+        Loop::Schedule write(std::string_view data)
+        {
+            text += data;
+            ++writes;
+            return loop.schedule();
+        }
+    };
+
+    std::string large_document()
+    {
+        std::string json = "{\"items\": [";
+        for (int i = 0; i < 5000; ++i)
+        {
+            json += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"name\": \"item " + std::to_string(i) + "\"}";
+        }
+        return json + "], \"ok\": true}";
+    }
+
+    std::vector<std::string> split(const std::string &text, size_t size)
+    {
+        std::vector<std::string> chunks;
+        for (size_t i = 0; i < text.size(); i += size)
+        {
+            chunks.push_back(text.substr(i, size));
+        }
+        return chunks;
+    }
+
+    // Another connection on the same loop, counting how often it got to run
+    async::Task<void> ticker(Loop &loop, const bool &stop, size_t &ticks)
+    {
+        while (!stop)
+        {
+            ++ticks;
+            co_await loop.schedule();
+        }
+    }
+}
+
+class AsyncTest : public ::testing::Test
+{
+};
+
+TEST_F(AsyncTest, ParseFromChunkedSourceInterleavesWithOtherWork)
+{
+    std::string json = large_document();
+    Loop loop;
+    ChunkSource source{loop, split(json, 4096)};
+
+    bool stop = false;
+    size_t ticks = 0;
+    auto other = ticker(loop, stop, ticks);
+    other.start();
+
+    auto task = async::parse_async(source);
+    task.start();
+    while (!task.done())
+    {
+        ASSERT_FALSE(loop.ready.empty());
+        auto handle = loop.ready.front();
+        loop.ready.pop_front();
+        handle.resume();
+    }
+    stop = true;
+    loop.run();
+
+    auto result = task.get();
+    ASSERT_TRUE(result) << result.error().message();
+    EXPECT_TRUE(equals(*result, std::make_shared<JsonObject>(parse(json))));
+    // The other task ran between the chunks
+    EXPECT_GE(ticks, source.chunks.size());
+}
+
+TEST_F(AsyncTest, TimeBudgetYieldsWithinOneChunk)
+{
+    std::string json = large_document();
+    Loop loop;
+    ChunkSource source{loop, {json}};
+    async::Budget budget;
+    budget.piece = 1024;
+    budget.slice = std::chrono::microseconds(0);
+
+    auto task = async::parse_async(source, ParseOptions(), budget);
+    task.start();
+    loop.run();
+    ASSERT_TRUE(task.done());
+    ASSERT_TRUE(task.get());
+    EXPECT_GE(source.yields, json.size() / 1024 - 1);
+}
+
+TEST_F(AsyncTest, SourceWithoutYieldParsesChunksSplitAtValueBoundaries)
+{
+    struct PlainSource
+    {
+        Loop &loop;
+        std::vector<std::string> chunks;
+        size_t next = 0;
+
+        struct Read
+        {
+            PlainSource &source;
+            bool await_ready() { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { source.loop.ready.push_back(handle); }
+            std::string_view await_resume()
+            {
+                return source.next < source.chunks.size() ? std::string_view(source.chunks[source.next++]) : std::string_view();
+            }
+        };
+
+        Read read() { return {*this}; }
+    };
+
+    Loop loop;
+    PlainSource source{loop, {"{\"a\": 1, \"b\":", " 2}"}};
+    auto task = async::parse_async(source);
+    task.start();
+    loop.run();
+    ASSERT_TRUE(task.done());
+    auto result = task.get();
+    ASSERT_TRUE(result) << result.error().message();
+    EXPECT_TRUE(equals(*result, JsonValue(R"({"a": 1, "b": 2})")));
+}
+
+TEST_F(AsyncTest, ParseErrorsAreResults)
+{
+    Loop loop;
+    ChunkSource source{loop, {"{\"a\": [1, ", "2, }"}};
+    auto task = async::parse_async(source);
+    task.start();
+    loop.run();
+    auto result = task.get();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::UnexpectedCharacter);
+
+    ChunkSource truncated{loop, {"{\"a\": [1, 2"}};
+    auto incomplete = async::parse_async(truncated);
+    incomplete.start();
+    loop.run();
+    EXPECT_EQ(incomplete.get().error().code, ParseErrc::UnterminatedArray);
+}
+
+TEST_F(AsyncTest, SerializeWritesPiecesOfTheStringifiedText)
+{
+    auto document = std::make_shared<JsonObject>(parse(large_document()));
+    Loop loop;
+    StringSink sink{loop};
+    async::Budget budget;
+    budget.piece = 4096;
+
+    auto task = async::serialize_async(document, sink, budget);
+    task.start();
+    loop.run();
+    ASSERT_TRUE(task.done());
+    task.get();
+    EXPECT_EQ(sink.text, document->stringify());
+    EXPECT_GE(sink.writes, sink.text.size() / 4096);
+}
+
+TEST_F(AsyncTest, TasksCompose)
+{
+    Loop loop;
+    ChunkSource source{loop, {"{\"name\": \"in\", ", "\"n\": 3}"}};
+    StringSink sink{loop};
+
+    auto round_trip = [&]() -> async::Task<size_t>
+    {
+        auto parsed = co_await async::parse_async(source);
+        co_await async::serialize_async(parsed.value(), sink);
+        co_return sink.text.size();
+    };
+    auto task = round_trip();
+    task.start();
+    loop.run();
+    ASSERT_TRUE(task.done());
+    EXPECT_EQ(task.get(), sink.text.size());
+    EXPECT_TRUE(equals(JsonValue(sink.text), JsonValue("{\"name\": \"in\", \"n\": 3}")));
+}
+
+#endif
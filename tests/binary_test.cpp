@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <memory>
+#include <string>
+
+using namespace hh_json;
+
+class BinaryTest : public ::testing::Test
+{
+protected:
+    std::shared_ptr<JsonObject> sample()
+    {
+        return JsonValue(R"({
+            "name": "Alice",
+            "age": 30,
+            "balance": -1234.5,
+            "ratio": 0.1,
+            "active": true,
+            "nothing": null,
+            "tags": ["a", "b", {"nested": [1, -1, 300, -70000, 5000000000]}],
+            "long": "this string is longer than thirty one bytes for sure"
+        })");
+    }
+};
+
+TEST_F(BinaryTest, CborRoundTrip)
+{
+    auto doc = sample();
+    auto encoded = cbor::encode(doc);
+    auto decoded = cbor::decode(encoded);
+    EXPECT_TRUE(equals(doc, decoded));
+}
+
+TEST_F(BinaryTest, MsgpackRoundTrip)
+{
+    auto doc = sample();
+    auto encoded = msgpack::encode(doc);
+    auto decoded = msgpack::decode(encoded);
+    EXPECT_TRUE(equals(doc, decoded));
+}
+
+TEST_F(BinaryTest, KeysTravelAsTheirText)
+{
+    auto doc = JsonValue(R"({"a\"b": 1, "c\\d": 2})");
+    EXPECT_EQ(cbor::encode(doc).find("a\\\"b"), std::string::npos);
+    EXPECT_NE(cbor::encode(doc).find("a\"b"), std::string::npos);
+    EXPECT_NE(msgpack::encode(doc).find("c\\d"), std::string::npos);
+    EXPECT_TRUE(equals(cbor::decode(cbor::encode(doc)), doc));
+    EXPECT_TRUE(equals(msgpack::decode(msgpack::encode(doc)), doc));
+
+    // Foreign maps with such keys decode to valid JSON
+    auto from_cbor = cbor::decode(std::string("\xa1\x63" "a\"b\x01", 6));
+    EXPECT_TRUE(equals(JsonValue(from_cbor->stringify()), from_cbor));
+    EXPECT_TRUE(equals(from_cbor, JsonValue(R"({"a\"b": 1})")));
+    auto from_msgpack = msgpack::decode(std::string("\x81\xa3" "c\\d\x02", 6));
+    EXPECT_TRUE(equals(from_msgpack, JsonValue(R"({"c\\d": 2})")));
+}
+
+TEST_F(BinaryTest, CborKnownEncodings)
+{
+    // RFC 8949 Appendix A examples
+    EXPECT_EQ(cbor::encode(maker::make_number(0)), std::string("\x00", 1));
+    EXPECT_EQ(cbor::encode(maker::make_number(100)), "\x18\x64");
+    EXPECT_EQ(cbor::encode(maker::make_number(-1000)), "\x39\x03\xe7");
+    EXPECT_EQ(cbor::encode(maker::make_number(1.5)), std::string("\xfa\x3f\xc0\x00\x00", 5));
+    EXPECT_EQ(cbor::encode(maker::make_boolean(true)), "\xf5");
+    EXPECT_EQ(cbor::encode(nullptr), "\xf6");
+    EXPECT_EQ(cbor::encode(maker::make_string("IETF")), "\x64IETF");
+
+    // Half float, tag and indefinite-length containers are accepted on input
+    EXPECT_DOUBLE_EQ(getter::get_number(cbor::decode(std::string("\xf9\x3c\x00", 3))), 1.0);
+    EXPECT_DOUBLE_EQ(getter::get_number(cbor::decode(std::string("\xc1\x1a\x51\x4b\x67\xb0", 6))), 1363896240.0);
+    auto indefinite = cbor::decode(std::string("\xbf\x63""Fun\xf5\x63""Amt\x9f\x01\x02\xff\xff"));
+    EXPECT_TRUE(getter::get_boolean(indefinite->get("Fun")));
+    EXPECT_EQ(getter::get_array(indefinite->get("Amt")).size(), 2u);
+}
+
+TEST_F(BinaryTest, MsgpackKnownEncodings)
+{
+    EXPECT_EQ(msgpack::encode(maker::make_number(5)), "\x05");
+    EXPECT_EQ(msgpack::encode(maker::make_number(-5)), "\xfb");
+    EXPECT_EQ(msgpack::encode(maker::make_number(200)), "\xcc\xc8");
+    EXPECT_EQ(msgpack::encode(maker::make_number(-200)), "\xd1\xff\x38");
+    EXPECT_EQ(msgpack::encode(maker::make_string("hi")), "\xa2hi");
+    EXPECT_EQ(msgpack::encode(nullptr), "\xc0");
+    EXPECT_EQ(msgpack::encode(std::make_shared<JsonArray>()), "\x90");
+}
+
+TEST_F(BinaryTest, EncodeAppendsToBuffer)
+{
+    std::string buffer = "prefix";
+    cbor::encode(maker::make_boolean(false), buffer);
+    msgpack::encode(maker::make_boolean(false), buffer);
+    EXPECT_EQ(buffer, "prefix\xf4\xc2");
+}
+
+TEST_F(BinaryTest, EncodersLeaveLazyStringsUntouched)
+{
+    ParseOptions options;
+    options.lazy_strings = true;
+    auto doc = std::make_shared<JsonObject>(parse(R"({"name": "Alice", "tags": ["a", "b"]})", options));
+    auto name = std::static_pointer_cast<JsonString>(doc->get("name"));
+    ASSERT_TRUE(name->is_lazy());
+
+    auto cbor_bytes = cbor::encode(doc);
+    auto msgpack_bytes = msgpack::encode(doc);
+    EXPECT_TRUE(name->is_lazy());
+    EXPECT_TRUE(equals(cbor::decode(cbor_bytes), doc));
+    EXPECT_TRUE(equals(msgpack::decode(msgpack_bytes), doc));
+}
+
+TEST_F(BinaryTest, MalformedInputThrows)
+{
+    EXPECT_THROW(cbor::decode(std::string("\x62\x61", 2)), std::runtime_error);   // truncated string
+    EXPECT_THROW(cbor::decode(std::string("\xa1\x01\x02", 3)), std::runtime_error); // non-text key
+    EXPECT_THROW(cbor::decode(std::string("\xf5\xf5", 2)), std::runtime_error);    // trailing bytes
+    EXPECT_THROW(msgpack::decode(std::string("\xdc\xff\xff", 3)), std::runtime_error);
+    EXPECT_THROW(msgpack::decode(std::string("\xc1", 1)), std::runtime_error);
+    EXPECT_THROW(msgpack::decode(std::string(2000, '\x91')), std::runtime_error);  // nesting limit
+}
+
+TEST_F(BinaryTest, NonFiniteFloatsAreRejected)
+{
+    // JSON cannot represent NaN or infinity, in any float width
+    EXPECT_THROW(cbor::decode(std::string("\xf9\x7e\x00", 3)), std::runtime_error);                     // half NaN
+    EXPECT_THROW(cbor::decode(std::string("\xf9\xfc\x00", 3)), std::runtime_error);                     // half -Inf
+    EXPECT_THROW(cbor::decode(std::string("\xfa\x7f\x80\x00\x00", 5)), std::runtime_error);             // single +Inf
+    EXPECT_THROW(cbor::decode(std::string("\xfb\x7f\xf8\x00\x00\x00\x00\x00\x00", 9)), std::runtime_error); // double NaN
+    EXPECT_DOUBLE_EQ(getter::get_number(cbor::decode(std::string("\xf9\x3e\x00", 3))), 1.5);
+
+    EXPECT_THROW(msgpack::decode(std::string("\xca\x7f\xc0\x00\x00", 5)), std::runtime_error);             // float NaN
+    EXPECT_THROW(msgpack::decode(std::string("\xcb\xff\xf0\x00\x00\x00\x00\x00\x00", 9)), std::runtime_error); // double -Inf
+    EXPECT_DOUBLE_EQ(getter::get_number(msgpack::decode(std::string("\xca\x3f\xc0\x00\x00", 5))), 1.5);
+}
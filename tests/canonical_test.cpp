@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <cmath>
+#include <limits>
+#include <string>
+
+using namespace hh_json;
+
+class CanonicalTest : public ::testing::Test
+{
+protected:
+    static std::shared_ptr<JsonObject> doc(const std::string &json, const ParseOptions &options = ParseOptions())
+    {
+        return std::make_shared<JsonObject>(parse(json, options));
+    }
+
+    static std::string number(double value)
+    {
+        std::string out;
+        canonical::append_number(value, out);
+        return out;
+    }
+};
+
+TEST_F(CanonicalTest, SortsMembersWithoutWhitespace)
+{
+    EXPECT_EQ(canonical::stringify(doc(R"({"b": [1, true, null, "s"], "a": {"d": {}, "c": []}})")),
+              R"({"a":{"c":[],"d":{}},"b":[1,true,null,"s"]})");
+    EXPECT_EQ(canonical::stringify(std::shared_ptr<JsonObject>()), "null");
+
+    std::string json, expected;
+    for (int i = 0; i < 50; ++i)
+    {
+        json += "{\"z\": " + std::to_string(i) + ", \"a\": ";
+        expected += "{\"a\":";
+    }
+    json += "null";
+    expected += "null";
+    for (int i = 49; i >= 0; --i)
+    {
+        json += "}";
+        expected += ",\"z\":" + std::to_string(i) + "}";
+    }
+    EXPECT_EQ(canonical::stringify(doc(json)), expected);
+}
+
+TEST_F(CanonicalTest, NumbersFollowEcmaScript)
+{
+    // Samples from RFC 8785 appendix B
+    EXPECT_EQ(number(0), "0");
+    EXPECT_EQ(number(-0.0), "0");
+    EXPECT_EQ(number(5e-324), "5e-324");
+    EXPECT_EQ(number(-5e-324), "-5e-324");
+    EXPECT_EQ(number(1.7976931348623157e308), "1.7976931348623157e+308");
+    EXPECT_EQ(number(9007199254740992), "9007199254740992");
+    EXPECT_EQ(number(295147905179352830000.0), "295147905179352830000");
+    EXPECT_EQ(number(1e21), "1e+21");
+    EXPECT_EQ(number(1e-7), "1e-7");
+    EXPECT_EQ(number(0.000001), "0.000001");
+    EXPECT_EQ(number(333333333.3333333), "333333333.3333333");
+    EXPECT_EQ(number(-1.5e-9), "-1.5e-9");
+    EXPECT_EQ(number(0.1), "0.1");
+    EXPECT_EQ(number(100), "100");
+
+    EXPECT_THROW(number(std::numeric_limits<double>::quiet_NaN()), std::runtime_error);
+    EXPECT_THROW(number(INFINITY), std::runtime_error);
+    // Same text whatever the source spelled
+    EXPECT_EQ(canonical::stringify(doc(R"({"n": [1.0, 1E2, -0, 0.10e1]})")), R"({"n":[1,100,0,1]})");
+}
+
+TEST_F(CanonicalTest, StringsUseOnlyRequiredEscapes)
+{
+    // RFC 8785 section 3.2.2.2, in a value and in a key
+    EXPECT_EQ(canonical::stringify(doc(R"({"€$\u000F\u000aA'\u0042\u0022\u005c\\\"\/": "€$\u000F\u000aA'\u0042\u0022\u005c\\\"\/"})")),
+              "{\"\xE2\x82\xAC$\\u000f\\nA'B\\\"\\\\\\\\\\\"/\":\"\xE2\x82\xAC$\\u000f\\nA'B\\\"\\\\\\\\\\\"/\"}");
+}
+
+TEST_F(CanonicalTest, KeysSortByUtf16CodeUnits)
+{
+    // RFC 8785 section 3.2.3: the emoji (a surrogate pair) sorts before U+FB33
+    auto value = doc(R"({"€": "Euro Sign", "\r": "Carriage Return", "דּ": "Hebrew Letter Dalet With Dagesh",
+                          "1": "One", "😀": "Emoji: Grinning Face", "\u0080": "Control", "ö": "Latin Small Letter O With Diaeresis"})");
+    std::string text = canonical::stringify(value);
+    std::vector<std::string> order = {"Carriage Return", "One", "Control", "Latin Small Letter O With Diaeresis",
+                                      "Euro Sign", "Emoji: Grinning Face", "Hebrew Letter Dalet With Dagesh"};
+    size_t last = 0;
+    for (const auto &name : order)
+    {
+        size_t at = text.find(name);
+        ASSERT_NE(at, std::string::npos) << name;
+        EXPECT_GT(at, last) << name;
+        last = at;
+    }
+}
+
+TEST_F(CanonicalTest, EscapedKeysInNestedAndSiblingObjects)
+{
+    // Decoded keys are dropped when their object closes; the keys of open objects stay intact
+    auto value = doc(R"({"b\"2": {"z\"w": 3}, "a\"1": {"x\\y": 1, "p": {"q\"r": 2}, "o\"k": 4}})");
+    EXPECT_EQ(canonical::stringify(value), R"({"a\"1":{"o\"k":4,"p":{"q\"r":2},"x\\y":1},"b\"2":{"z\"w":3}})");
+}
+
+TEST_F(CanonicalTest, HashIsTheCanonicalTextHash)
+{
+    std::string json = "{\"items\": [";
+    for (int i = 0; i < 2000; ++i)
+    {
+        json += (i ? ", " : "") + std::string("{\"z\": ") + std::to_string(i) + ", \"a\": \"item " + std::to_string(i) + "\"}";
+    }
+    json += "]}";
+    auto value = doc(json);
+    ASSERT_GT(canonical::stringify(value).size(), 4096u * 4);
+    EXPECT_EQ(canonical::hash(value), hash::xxh64(canonical::stringify(value)));
+    EXPECT_EQ(canonical::hash(value, 7), hash::xxh64(canonical::stringify(value), 7));
+    EXPECT_EQ(canonical::hash(*value), canonical::hash(value));
+}
+
+TEST_F(CanonicalTest, EqualDocumentsHashEqually)
+{
+    auto a = doc(R"({"x": {"p": 1, "q": [null, true]}, "y": "sé"})");
+    auto b = std::make_shared<JsonObject>();
+    b->insert("y", maker::make_string("s\xC3\xA9"));
+    b->insert("x", doc(R"({"q": [null, true], "p": 1.0})"));
+    EXPECT_EQ(canonical::stringify(a), canonical::stringify(b));
+    EXPECT_EQ(canonical::hash(a), canonical::hash(b));
+
+    ParseOptions lazy;
+    lazy.lazy_strings = true;
+    lazy.lazy_numbers = true;
+    EXPECT_EQ(canonical::hash(doc(R"({"y": "sé", "x": {"q": [null, true], "p": 10e-1}})", lazy)), canonical::hash(a));
+
+    EXPECT_NE(canonical::hash(doc(R"({"a": [1, 2]})")), canonical::hash(doc(R"({"a": [2, 1]})")));
+    EXPECT_NE(canonical::hash(doc(R"({"a": "1"})")), canonical::hash(doc(R"({"a": 1})")));
+}
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if HH_JSON_ZLIB
+#include <zlib.h>
+#endif
+#if HH_JSON_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace hh_json;
+
+class CompressionTest : public ::testing::Test
+{
+protected:
+    static std::string document()
+    {
+        std::string json = "{\"items\": [";
+        for (int i = 0; i < 3000; ++i)
+        {
+            json += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"name\": \"item " + std::to_string(i) + "\"}";
+        }
+        return json + "], \"ok\": true}";
+    }
+
+    static std::string ndjson(int lines)
+    {
+        std::string text;
+        for (int i = 0; i < lines; ++i)
+        {
+            text += "{\"n\": " + std::to_string(i) + ", \"pad\": \"" + std::string(static_cast<size_t>(i % 50), 'x') + "\"}\n";
+        }
+        return text;
+    }
+
+    static compression::PipelineOptions small_blocks(bool threaded)
+    {
+        compression::PipelineOptions pipeline;
+        pipeline.block_size = 512;
+        pipeline.queue_depth = 2;
+        pipeline.threaded = threaded;
+        return pipeline;
+    }
+
+#if HH_JSON_ZLIB
+    static std::string gzip(const std::string &text)
+    {
+        z_stream stream{};
+        // 15 + 16: gzip framing
+        EXPECT_EQ(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY), Z_OK);
+        std::string out(deflateBound(&stream, static_cast<uLong>(text.size())), '\0');
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(text.data()));
+        stream.avail_in = static_cast<uInt>(text.size());
+        stream.next_out = reinterpret_cast<Bytef *>(&out[0]);
+        stream.avail_out = static_cast<uInt>(out.size());
+        EXPECT_EQ(deflate(&stream, Z_FINISH), Z_STREAM_END);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        return out;
+    }
+#endif
+};
+
+TEST_F(CompressionTest, DetectsFormatFromMagicBytes)
+{
+    using compression::Format;
+    EXPECT_EQ(compression::detect("\x1f\x8b\x08"), Format::Gzip);
+    EXPECT_EQ(compression::detect("\x78\x9c"), Format::Gzip); // zlib
+    EXPECT_EQ(compression::detect("\x28\xb5\x2f\xfd"), Format::Zstd);
+    EXPECT_EQ(compression::detect("{\"a\": 1}"), Format::Plain);
+    EXPECT_EQ(compression::detect(" \n{"), Format::Plain);
+    EXPECT_EQ(compression::detect(""), Format::Plain);
+    EXPECT_TRUE(compression::available(Format::Plain));
+    EXPECT_THROW(compression::Decompressor(Format::Auto), std::runtime_error);
+}
+
+TEST_F(CompressionTest, PlainStreamParses)
+{
+    std::string json = document();
+    auto expected = std::make_shared<JsonObject>(parse(json));
+    for (bool threaded : {false, true})
+    {
+        std::istringstream in(json);
+        auto result = compression::parse(in, ParseOptions(), small_blocks(threaded));
+        ASSERT_TRUE(result) << result.error().message();
+        EXPECT_TRUE(equals(*result, expected));
+    }
+
+    std::istringstream broken(R"({"a":[1,2)");
+    auto result = compression::parse(broken);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, try_parse(R"({"a":[1,2)").error().code);
+}
+
+TEST_F(CompressionTest, NdjsonRecordsArriveInOrder)
+{
+    std::string text = ndjson(500) + "\n  \n{\"bad\": }\n{\"n\": 500, \"pad\": \"\"}"; // blank lines, an error, no final newline
+    for (bool threaded : {false, true})
+    {
+        std::istringstream in(text);
+        std::vector<double> seen;
+        std::vector<size_t> failed_lines;
+        auto count = compression::read_ndjson(
+            in, [&](size_t line, Result<std::shared_ptr<JsonObject>> record)
+            {
+                if (record)
+                    seen.push_back(getter::get_number((*record)->get("n")));
+                else
+                    failed_lines.push_back(line);
+                return true; },
+            ParseOptions(), small_blocks(threaded));
+        ASSERT_TRUE(count);
+        EXPECT_EQ(*count, 502u);
+        ASSERT_EQ(seen.size(), 501u);
+        for (size_t i = 0; i < seen.size(); ++i)
+        {
+            EXPECT_EQ(seen[i], static_cast<double>(i));
+        }
+        EXPECT_EQ(failed_lines, std::vector<size_t>{503});
+    }
+}
+
+TEST_F(CompressionTest, HandlerCanStopTheReader)
+{
+    std::string text = ndjson(5000);
+    for (bool threaded : {false, true})
+    {
+        std::istringstream in(text);
+        size_t calls = 0;
+        auto count = compression::read_ndjson(in, [&](size_t, Result<std::shared_ptr<JsonObject>>)
+                                              { return ++calls < 3; },
+                                              ParseOptions(), small_blocks(threaded));
+        ASSERT_TRUE(count);
+        EXPECT_EQ(*count, 3u);
+        EXPECT_EQ(calls, 3u);
+    }
+}
+
+TEST_F(CompressionTest, OverlongNdjsonLineFailsWithoutBuffering)
+{
+    ParseOptions options;
+    options.max_size = 100;
+    std::istringstream in("{\"a\": 1}\n{\"long\": \"" + std::string(5000, 'x') + "\"}\n{\"b\": 2}\n");
+    std::vector<ParseErrc> codes;
+    auto count = compression::read_ndjson(in, [&](size_t, Result<std::shared_ptr<JsonObject>> record)
+                                          { codes.push_back(record.error().code); return true; },
+                                          options, small_blocks(false));
+    ASSERT_TRUE(count);
+    EXPECT_EQ(codes, (std::vector<ParseErrc>{ParseErrc::None, ParseErrc::DocumentTooLarge, ParseErrc::None}));
+}
+
+#if HH_JSON_ZLIB
+TEST_F(CompressionTest, GzipStreamMatchesParse)
+{
+    std::string json = document();
+    std::string packed = gzip(json);
+    ASSERT_LT(packed.size(), json.size());
+    auto expected = std::make_shared<JsonObject>(parse(json));
+    for (bool threaded : {false, true})
+    {
+        std::istringstream in(packed);
+        auto result = compression::parse(in, ParseOptions(), small_blocks(threaded));
+        ASSERT_TRUE(result) << result.error().message();
+        EXPECT_TRUE(equals(*result, expected));
+    }
+}
+
+TEST_F(CompressionTest, ConcatenatedGzipMembersAreOneStream)
+{
+    // What `cat a.jsonl.gz b.jsonl.gz` produces
+    std::istringstream in(gzip(ndjson(300)) + gzip(ndjson(200)));
+    size_t records = 0;
+    auto count = compression::read_ndjson(in, [&](size_t, Result<std::shared_ptr<JsonObject>> record)
+                                          { records += record.has_value(); return true; },
+                                          ParseOptions(), small_blocks(true));
+    ASSERT_TRUE(count) << count.error().message();
+    EXPECT_EQ(*count, 500u);
+    EXPECT_EQ(records, 500u);
+}
+
+TEST_F(CompressionTest, CorruptOrTruncatedGzipFails)
+{
+    std::string packed = gzip(document());
+
+    std::istringstream truncated(packed.substr(0, packed.size() / 2));
+    auto result = compression::parse(truncated, ParseOptions(), small_blocks(true));
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::DecompressionFailed);
+
+    std::string corrupt = packed;
+    for (size_t i = 20; i < 40; ++i)
+    {
+        corrupt[i] = static_cast<char>(~corrupt[i]);
+    }
+    std::istringstream damaged(corrupt);
+    result = compression::parse(damaged, ParseOptions(), small_blocks(false));
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::DecompressionFailed);
+    EXPECT_FALSE(result.error().detail.empty());
+
+    // Text decompressed before the damage still reaches the parser, which needs no more
+    std::istringstream trailing(gzip(R"({"a": 1})" + std::string(100000, ' ')) + "garbage");
+    EXPECT_TRUE(compression::parse(trailing, ParseOptions(), small_blocks(true)));
+}
+#endif
+
+#if HH_JSON_ZSTD
+TEST_F(CompressionTest, ZstdStreamMatchesParse)
+{
+    std::string json = document();
+    std::string packed(ZSTD_compressBound(json.size()), '\0');
+    size_t size = ZSTD_compress(&packed[0], packed.size(), json.data(), json.size(), 3);
+    ASSERT_FALSE(ZSTD_isError(size));
+    packed.resize(size);
+
+    std::istringstream in(packed);
+    auto result = compression::parse(in, ParseOptions(), small_blocks(true));
+    ASSERT_TRUE(result) << result.error().message();
+    EXPECT_TRUE(equals(*result, std::make_shared<JsonObject>(parse(json))));
+
+    std::istringstream truncated(packed.substr(0, packed.size() - 10));
+    result = compression::parse(truncated, ParseOptions(), small_blocks(false));
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::DecompressionFailed);
+}
+#else
+TEST_F(CompressionTest, ZstdWithoutLibzstdIsAnError)
+{
+    std::istringstream in(std::string("\x28\xb5\x2f\xfd\x00\x00", 6));
+    auto result = compression::parse(in);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::DecompressionFailed);
+    EXPECT_FALSE(compression::available(compression::Format::Zstd));
+}
+#endif
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <memory>
+#include <string>
+
+using namespace hh_json;
+
+class DiffTest : public ::testing::Test
+{
+protected:
+    std::shared_ptr<JsonObject> doc(const std::string &json)
+    {
+        return JsonValue(json);
+    }
+
+    // Applies diff(from, to) to a copy of `from` and checks it reproduces `to`
+    std::shared_ptr<JsonArray> round_trip(const std::string &from, const std::string &to)
+    {
+        auto source = doc(from);
+        auto target = doc(to);
+        auto ops = patch::diff(source, target);
+        auto patched = patch::clone(source);
+        patch::apply(patched, ops);
+        EXPECT_TRUE(equals(patched, target)) << ops->stringify();
+        return ops;
+    }
+};
+
+TEST_F(DiffTest, IdenticalDocumentsProduceEmptyPatch)
+{
+    auto ops = round_trip(R"({"a": 1, "b": [1, 2, {"c": "d"}], "e": {"f": null}})",
+                          R"({"e": {"f": null}, "b": [1, 2, {"c": "d"}], "a": 1})");
+    EXPECT_TRUE(ops->elements.empty());
+}
+
+TEST_F(DiffTest, ObjectMembers)
+{
+    auto ops = round_trip(R"({"keep": 1, "drop": 2, "change": {"x": 1, "y": 2}})",
+                          R"({"keep": 1, "add": 3, "change": {"x": 1, "y": 5}})");
+    ASSERT_EQ(ops->elements.size(), 3u);
+    EXPECT_TRUE(equals(ops->elements[0], doc(R"({"op": "add", "path": "/add", "value": 3})")));
+    EXPECT_TRUE(equals(ops->elements[1], doc(R"({"op": "replace", "path": "/change/y", "value": 5})")));
+    EXPECT_TRUE(equals(ops->elements[2], doc(R"({"op": "remove", "path": "/drop"})")));
+}
+
+TEST_F(DiffTest, ArrayInsertAndRemoveAreMinimal)
+{
+    auto ops = round_trip(R"({"l": [1, 2, 3, 4, 5]})", R"({"l": [1, 2, 9, 3, 4, 5]})");
+    ASSERT_EQ(ops->elements.size(), 1u);
+    EXPECT_TRUE(equals(ops->elements[0], doc(R"({"op": "add", "path": "/l/2", "value": 9})")));
+
+    ops = round_trip(R"({"l": ["a", "b", "c", "d"]})", R"({"l": ["a", "c", "d"]})");
+    ASSERT_EQ(ops->elements.size(), 1u);
+    EXPECT_TRUE(equals(ops->elements[0], doc(R"({"op": "remove", "path": "/l/1"})")));
+}
+
+TEST_F(DiffTest, ArrayElementsAreDiffedInPlace)
+{
+    auto ops = round_trip(R"([{"id": 1, "v": "a"}, {"id": 2, "v": "b"}])", R"([{"id": 1, "v": "a"}, {"id": 2, "v": "c"}])");
+    ASSERT_EQ(ops->elements.size(), 1u);
+    EXPECT_TRUE(equals(ops->elements[0], doc(R"({"op": "replace", "path": "/1/v", "value": "c"})")));
+}
+
+TEST_F(DiffTest, MixedChanges)
+{
+    round_trip(R"({"l": [1, 2, 3, 4, 5, 6], "t": "x"})", R"({"l": [0, 2, 4, 7, 6, 8, 9], "t": [1]})");
+    round_trip(R"({"l": [1, 2, 3]})", R"({"l": []})");
+    round_trip(R"({"l": []})", R"({"l": [[1], {"a": 2}]})");
+    round_trip(R"({"a/b": {"m~n": 1}})", R"({"a/b": {"m~n": 2}})");
+    round_trip(R"({"a": 1})", R"([1, 2])");
+}
+
+TEST_F(DiffTest, HasherIgnoresMemberOrderAndReusesCache)
+{
+    patch::SubtreeHasher hasher;
+    auto a = doc(R"({"x": {"p": 1, "q": [true, null]}, "y": "s"})");
+    auto b = doc(R"({"y": "s", "x": {"q": [true, null], "p": 1}})");
+    EXPECT_EQ(hasher.hash(a), hasher.hash(b));
+    EXPECT_NE(hasher.hash(a), hasher.hash(doc(R"({"x": {"p": 1, "q": [null, true]}, "y": "s"})")));
+    EXPECT_NE(hasher.hash(doc("[1, 2]")), hasher.hash(doc("[2, 1]")));
+    EXPECT_EQ(hasher.hash(doc("0")), hasher.hash(doc("-0")));
+
+    size_t cached = hasher.cached();
+    EXPECT_GT(cached, 0u);
+    EXPECT_TRUE(patch::diff(a, b, hasher)->elements.empty());
+    EXPECT_EQ(hasher.cached(), cached);
+
+    hasher.clear();
+    EXPECT_EQ(hasher.cached(), 0u);
+}
+
+TEST_F(DiffTest, ReusedHasherSurvivesFreedDocuments)
+{
+    patch::SubtreeHasher hasher;
+    auto base = doc(R"({"a": [1]})");
+    for (int i = 0; i < 100; ++i)
+    {
+        {
+            auto same = doc(R"({"a": [1]})");
+            EXPECT_TRUE(patch::diff(base, same, hasher)->elements.empty());
+        }
+        // Nodes of this tree may land at the addresses of the one just freed
+        auto changed = doc(R"({"a": [2]})");
+        auto ops = patch::diff(base, changed, hasher);
+        ASSERT_EQ(ops->elements.size(), 1u) << i;
+        auto patched = patch::clone(base);
+        patch::apply(patched, ops);
+        EXPECT_TRUE(equals(patched, changed));
+    }
+}
+
+TEST_F(DiffTest, PathsUseTheKeyText)
+{
+    auto ops = round_trip(R"({"a\"b": 1, "c\\d": [1]})", R"({"a\"b": 2, "c\\d": [1, 2]})");
+    ASSERT_EQ(ops->elements.size(), 2u);
+    EXPECT_EQ(getter::get_string(ops->elements[0]->get("path")), "/a\"b");
+    EXPECT_EQ(getter::get_string(ops->elements[1]->get("path")), "/c\\d/1");
+}
+
+TEST_F(DiffTest, SnapshotViews)
+{
+    auto from = snapshot::Image::from_buffer(snapshot::write(doc(R"({"a": [1, 2], "b": "x"})")));
+    auto to = snapshot::Image::from_buffer(snapshot::write(doc(R"({"a": [1, 2, 3], "b": "x"})")));
+    auto ops = patch::diff(from->root(), to->root());
+    ASSERT_EQ(ops->elements.size(), 1u);
+    EXPECT_TRUE(equals(ops->elements[0], doc(R"({"op": "add", "path": "/a/2", "value": 3})")));
+}
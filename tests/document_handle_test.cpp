@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hh_json;
+
+class DocumentHandleTest : public ::testing::Test
+{
+protected:
+    static FrozenDocument config(int version)
+    {
+        std::string v = std::to_string(version);
+        return freeze(parse("{\"version\": " + v + ", \"copy\": " + v + ", \"name\": \"v" + v + "\"}"));
+    }
+};
+
+TEST_F(DocumentHandleTest, PublishReplacesTheCurrentVersion)
+{
+    DocumentHandle handle(config(1));
+    EXPECT_EQ(handle.read()["version"].as_number(), 1);
+    EXPECT_EQ(handle.version(), 0u);
+
+    handle.publish(config(2));
+    EXPECT_EQ(handle.read()["name"].as_string(), "v2");
+    EXPECT_EQ(handle.version(), 1u);
+
+    DocumentHandle empty;
+    EXPECT_EQ(empty.read()->stringify(), "{}");
+}
+
+TEST_F(DocumentHandleTest, GuardPinsItsVersion)
+{
+    DocumentHandle handle(config(1));
+    {
+        auto guard = handle.read();
+        handle.publish(config(2));
+        // The replaced version stays alive for the guard
+        EXPECT_EQ(handle.reclaim(), 1u);
+        EXPECT_EQ(guard["version"].as_number(), 1);
+
+        // A nested read sees the new version and keeps the outer pin
+        {
+            auto inner = handle.read();
+            EXPECT_EQ(inner["version"].as_number(), 2);
+        }
+        EXPECT_EQ(handle.reclaim(), 1u);
+        EXPECT_EQ(guard["name"].as_string(), "v1");
+    }
+    EXPECT_EQ(handle.reclaim(), 0u);
+}
+
+TEST_F(DocumentHandleTest, SnapshotOutlivesPublish)
+{
+    DocumentHandle handle(config(1));
+    FrozenDocument old = handle.snapshot();
+    handle.publish(config(2));
+    EXPECT_EQ(handle.reclaim(), 0u);
+    EXPECT_EQ(old["version"].as_number(), 1);
+}
+
+TEST_F(DocumentHandleTest, ConcurrentReadersAndWriter)
+{
+    DocumentHandle handle(config(0));
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<int> reads{0};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 6; ++t)
+    {
+        readers.emplace_back([&]
+                             {
+            double last = 0;
+            while (!done.load())
+            {
+                auto guard = handle.read();
+                double version = guard["version"].as_number();
+                // Each document is internally consistent and versions never go backwards
+                if (guard["copy"].as_number() != version || guard["name"].as_string() != "v" + std::to_string(static_cast<int>(version)) || version < last)
+                {
+                    ++torn;
+                }
+                last = version;
+                ++reads;
+            } });
+    }
+
+    for (int version = 1; version <= 300; ++version)
+    {
+        handle.publish(config(version));
+    }
+    while (reads.load() < 1000)
+    {
+        std::this_thread::yield();
+    }
+    done = true;
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(handle.version(), 300u);
+    EXPECT_EQ(handle.reclaim(), 0u);
+    EXPECT_EQ(handle.read()["version"].as_number(), 300);
+}
+
+TEST_F(DocumentHandleTest, ManyThreadsAndHandles)
+{
+    // More reader threads than one slot block, each reading two handles
+    DocumentHandle first(config(1));
+    DocumentHandle second(config(2));
+    std::atomic<int> wrong{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 40; ++t)
+    {
+        threads.emplace_back([&]
+                             {
+            for (int i = 0; i < 100; ++i)
+            {
+                auto a = first.read();
+                auto b = second.read();
+                if (a["version"].as_number() + 1 != b["version"].as_number())
+                {
+                    ++wrong;
+                }
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(wrong.load(), 0);
+    first.publish(config(5));
+    EXPECT_EQ(first.reclaim(), 0u);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <memory>
+#include <string>
+
+// Also built with -fno-exceptions (json_parser_noexcept_tests), so only the
+// throwing checks are guarded by HH_JSON_EXCEPTIONS.
+
+using namespace hh_json;
+
+class ErrorTest : public ::testing::Test
+{
+};
+
+TEST_F(ErrorTest, TryParseSuccess)
+{
+    auto result = try_parse(R"({"a": [1, 2], "b": {"c": "d"}})");
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result.has_value());
+    EXPECT_FALSE(result.error());
+    EXPECT_EQ(result->size(), 2u);
+    EXPECT_EQ(getter::get_array_ref((*result)["a"]).size(), 2u);
+}
+
+TEST_F(ErrorTest, ErrorCodesAndOffsets)
+{
+    struct Case
+    {
+        const char *json;
+        ParseErrc code;
+        size_t offset;
+    };
+    // Offsets refer to the input as given, whitespace included
+    const Case cases[] = {
+        {"[1]", ParseErrc::RootNotObject, 0},
+        {"", ParseErrc::RootNotObject, 0},
+        {R"({"a" 1})", ParseErrc::ExpectedColon, 5},
+        {R"({"a":1 "b":2})", ParseErrc::ExpectedCommaOrBrace, 7},
+        {R"({1:2})", ParseErrc::ExpectedKey, 1},
+        {R"({"a":[1}})", ParseErrc::ExpectedCommaOrBracket, 7},
+        {R"({"a":[1,2)", ParseErrc::UnterminatedArray, 9},
+        {R"({"a":1)", ParseErrc::UnterminatedObject, 6},
+        {R"({"a":"abc)", ParseErrc::UnterminatedString, 9},
+        {R"({"a":tru})", ParseErrc::InvalidLiteral, 5},
+        {R"({"a":-})", ParseErrc::InvalidNumber, 5},
+        {R"({"a":@})", ParseErrc::UnexpectedCharacter, 5},
+        {R"({"a":)", ParseErrc::UnexpectedEnd, 5},
+        {"  [1]", ParseErrc::RootNotObject, 2},
+        {"{\n  \"a\": 1,\n  \"b\": [1, 2,, 3]\n}", ParseErrc::UnexpectedCharacter, 25},
+    };
+    for (const auto &c : cases)
+    {
+        auto result = try_parse(c.json);
+        ASSERT_FALSE(result) << c.json;
+        EXPECT_EQ(result.error().code, c.code) << c.json << ": " << result.error().message();
+        EXPECT_EQ(result.error().offset, c.offset) << c.json;
+    }
+}
+
+TEST_F(ErrorTest, MessageIsFormattedOnRequest)
+{
+    auto result = try_parse(R"({"a" 1})");
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().message(), "Expected ':' at position 5");
+    EXPECT_STREQ(describe(ParseErrc::UnterminatedArray), "Unterminated array");
+    EXPECT_EQ(ParseError{}.message(), "No error");
+}
+
+TEST_F(ErrorTest, TryParseValue)
+{
+    auto value = try_parse_value("[true, null, \"x\"]");
+    ASSERT_TRUE(value);
+    EXPECT_EQ(getter::get_type(*value), JsonType::Array);
+
+    // A literal null is a successful parse with a null result
+    auto null_value = try_parse_value("null");
+    ASSERT_TRUE(null_value);
+    EXPECT_EQ(*null_value, nullptr);
+
+    auto bad = try_parse_value("[1,");
+    ASSERT_FALSE(bad);
+    EXPECT_EQ(bad.error().code, ParseErrc::UnterminatedArray);
+
+    // JsonValue keeps reporting failures as nullptr, now without writing to stderr
+    testing::internal::CaptureStderr();
+    EXPECT_EQ(JsonValue("[1,"), nullptr);
+    EXPECT_EQ(testing::internal::GetCapturedStderr(), "");
+}
+
+TEST_F(ErrorTest, SchemaViolationCarriesReason)
+{
+    SchemaValidator validator(R"({"type": "object", "properties": {"n": {"type": "integer"}}})");
+    auto result = try_parse(R"({"n": 1.5})", validator);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::SchemaViolation);
+    EXPECT_EQ(result.error().offset, 6u);
+    EXPECT_FALSE(result.error().detail.empty());
+    EXPECT_EQ(result.error().message().rfind("Schema violation at position 6: ", 0), 0u);
+}
+
+#if HH_JSON_EXCEPTIONS
+TEST_F(ErrorTest, ThrowingApiUsesSameMessages)
+{
+    try
+    {
+        parse(R"({"a" 1})");
+        FAIL() << "expected a parse error";
+    }
+    catch (const std::runtime_error &e)
+    {
+        EXPECT_STREQ(e.what(), "Expected ':' at position 5");
+    }
+
+    auto result = try_parse("[]");
+    EXPECT_THROW(result.value(), std::runtime_error);
+
+    JsonObject obj;
+    EXPECT_THROW(obj.set_json_data("{"), std::runtime_error);
+}
+#endif
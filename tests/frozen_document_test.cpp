@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace hh_json;
+
+class FrozenDocumentTest : public ::testing::Test
+{
+};
+
+TEST_F(FrozenDocumentTest, ReadsWithoutInserting)
+{
+    auto doc = freeze(parse(R"({"name": "svc", "port": 8080, "tls": true, "hosts": ["a", "b"], "limits": {"rps": 5}})"));
+
+    EXPECT_EQ(doc["name"].as_string(), "svc");
+    EXPECT_EQ(doc["port"].as_number(), 8080);
+    EXPECT_TRUE(doc["tls"].as_boolean());
+    EXPECT_EQ(doc["hosts"][1].as_string(), "b");
+    EXPECT_EQ(doc["hosts"].size(), 2u);
+    EXPECT_EQ(doc["limits"]["rps"].as_number(), 5);
+
+    // Missing members and indexes read as null and leave the tree alone
+    EXPECT_TRUE(doc["missing"].is_null());
+    EXPECT_TRUE(doc["limits"]["missing"]["deeper"].is_null());
+    EXPECT_TRUE(doc["hosts"][7].is_null());
+    EXPECT_TRUE(doc["port"]["not an object"].is_null());
+    EXPECT_FALSE(doc.contains("missing"));
+    EXPECT_EQ(doc.root().size(), 5u);
+    EXPECT_EQ(doc["limits"].size(), 1u);
+
+    EXPECT_THROW(doc["name"].as_number(), std::runtime_error);
+    EXPECT_THROW(doc["hosts"].members(), std::runtime_error);
+}
+
+TEST_F(FrozenDocumentTest, IterationHandsOutFrozenValues)
+{
+    auto doc = freeze(parse(R"({"hosts": ["a", "b"], "limits": {"rps": 5, "burst": 10}})"));
+
+    std::string hosts;
+    for (FrozenValue host : doc["hosts"].elements())
+    {
+        hosts += host.as_string();
+    }
+    EXPECT_EQ(hosts, "ab");
+    EXPECT_EQ(doc["hosts"].elements()[1].as_string(), "b");
+
+    double total = 0;
+    for (const auto &[key, value] : doc["limits"].members())
+    {
+        EXPECT_TRUE(key == "rps" || key == "burst") << key;
+        total += value.as_number();
+    }
+    EXPECT_EQ(total, 15);
+    EXPECT_EQ(doc["limits"].members().size(), 2u);
+    EXPECT_THROW(doc["limits"].elements(), std::runtime_error);
+
+    // Nothing the views hand out can reach a mutable node
+    static_assert(std::is_same_v<decltype(*doc["hosts"].elements().begin()), FrozenValue>);
+    static_assert(std::is_same_v<decltype(doc["hosts"][0].get()), const JsonObject *>);
+}
+
+TEST_F(FrozenDocumentTest, KeysWithEscapesAreFound)
+{
+    auto doc = freeze(parse(R"({"a\"b": 1, "c\\d": {"e\nf": true}, "plain": 2})"));
+
+    EXPECT_EQ(doc["a\"b"].as_number(), 1);
+    EXPECT_TRUE(doc["c\\d"]["e\nf"].as_boolean());
+    EXPECT_TRUE(doc.contains("a\"b"));
+    EXPECT_TRUE(doc["c\\d"].contains("e\nf"));
+    EXPECT_EQ(doc["plain"].as_number(), 2);
+    // The stored (escaped) spelling is not the key
+    EXPECT_FALSE(doc.contains("a\\\"b"));
+}
+
+TEST_F(FrozenDocumentTest, LazyValuesAreDecodedWhenFrozen)
+{
+    ParseOptions options;
+    options.lazy_strings = true;
+    options.lazy_numbers = true;
+    auto doc = freeze(parse(R"({"a": "x\ty", "list": ["plain", 2.5]})", options));
+
+    const auto *a = static_cast<const JsonString *>(doc["a"].get());
+    const auto *plain = static_cast<const JsonString *>(doc["list"][0].get());
+    const auto *number = static_cast<const JsonNumber *>(doc["list"][1].get());
+    EXPECT_FALSE(a->is_lazy());
+    EXPECT_FALSE(plain->is_lazy());
+    EXPECT_FALSE(number->is_lazy());
+    EXPECT_EQ(doc["a"].as_string(), "x\ty");
+    EXPECT_EQ(doc["list"][0].as_string(), "plain");
+    EXPECT_EQ(doc["list"][1].as_number(), 2.5);
+}
+
+TEST_F(FrozenDocumentTest, FreezingAValueCopiesIt)
+{
+    ParseOptions options;
+    options.lazy_strings = true;
+    auto source = *try_parse_value(R"({"k": "v\n", "n": [1]})", options);
+    auto doc = freeze(source);
+
+    source->insert("k", maker::make_string("changed"));
+    static_cast<JsonArray &>(*source->get("n")).insert(maker::make_number(2));
+
+    EXPECT_EQ(doc["k"].as_string(), "v\n");
+    EXPECT_EQ(doc["n"].size(), 1u);
+    EXPECT_EQ(doc.stringify(), freeze(JsonValue(doc.stringify())).stringify());
+
+    auto null_doc = freeze(std::shared_ptr<JsonObject>());
+    EXPECT_TRUE(null_doc.root().is_null());
+    EXPECT_EQ(null_doc.stringify(), "null");
+    EXPECT_EQ(FrozenDocument().stringify(), "{}");
+}
+
+TEST_F(FrozenDocumentTest, ConcurrentReaders)
+{
+    std::string json = "{\"items\": [";
+    for (int i = 0; i < 200; ++i)
+    {
+        json += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"name\": \"item\\n" + std::to_string(i) + "\"}";
+    }
+    json += "]}";
+    ParseOptions options;
+    options.lazy_strings = true;
+    options.lazy_numbers = true;
+    const auto doc = freeze(parse(json, options));
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 8; ++t)
+    {
+        readers.emplace_back([&doc, &mismatches]
+                             {
+            for (int round = 0; round < 50; ++round)
+            {
+                for (size_t i = 0; i < doc["items"].size(); ++i)
+                {
+                    auto item = doc["items"][i];
+                    if (item["id"].as_number() != static_cast<double>(i) ||
+                        item["name"].as_string() != "item\n" + std::to_string(i) || !item["absent"].is_null())
+                    {
+                        ++mismatches;
+                    }
+                }
+            } });
+    }
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(doc["items"][0].members().size(), 2u);
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <string>
+
+using namespace hh_json;
+
+TEST(HashTest, Xxh64ReferenceVectors)
+{
+    EXPECT_EQ(hash::xxh64("", 0), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(hash::xxh64("abc"), 0x44BC2CF5AD770999ULL);
+    EXPECT_EQ(hash::xxh64("The quick brown fox jumps over the lazy dog"), 0x0B242D361FDA71BCULL);
+}
+
+TEST(HashTest, SeedChangesHash)
+{
+    EXPECT_NE(hash::xxh64("abc", 0), hash::xxh64("abc", 1));
+}
+
+TEST(HashTest, StreamingMatchesOneShot)
+{
+    std::string input;
+    for (int i = 0; i < 1000; ++i)
+    {
+        input += static_cast<char>('a' + i % 26);
+    }
+
+    for (size_t chunk : {1u, 3u, 7u, 31u, 32u, 33u, 100u})
+    {
+        hash::Xxh64 h;
+        for (size_t pos = 0; pos < input.size(); pos += chunk)
+        {
+            h.update(std::string_view(input).substr(pos, chunk));
+        }
+        EXPECT_EQ(h.digest(), hash::xxh64(input)) << "chunk size " << chunk;
+    }
+}
@@ -91,14 +91,27 @@ TEST_F(HelpersTest, MakeNumber)
 
 TEST_F(HelpersTest, MakeObject)
 {
-    // make_object is not available in the current helper functions
-    GTEST_SKIP() << "make_object helper function not implemented";
+    auto obj = maker::make_object({{"name", maker::make_string("test")}, {"count", maker::make_number(2)}});
+    ASSERT_NE(obj, nullptr);
+    EXPECT_EQ(obj->type(), JsonType::Object);
+    EXPECT_EQ(getter::get_string(obj->get("name")), "test");
+    EXPECT_DOUBLE_EQ(getter::get_number(obj->get("count")), 2);
+
+    EXPECT_TRUE(maker::make_object()->get_data().empty());
 }
 
 TEST_F(HelpersTest, MakeArray)
 {
-    // make_array is not available in the current helper functions
-    GTEST_SKIP() << "make_array helper function not implemented";
+    std::vector<std::shared_ptr<JsonObject>> elements{maker::make_number(1), maker::make_boolean(false)};
+    const JsonObject *first = elements[0].get();
+
+    auto arr = maker::make_array(std::move(elements));
+    ASSERT_NE(arr, nullptr);
+    EXPECT_EQ(arr->type(), JsonType::Array);
+    ASSERT_EQ(getter::get_array_ref(arr).size(), 2u);
+    EXPECT_EQ(getter::get_array_ref(arr)[0].get(), first);
+
+    EXPECT_TRUE(getter::get_array_ref(maker::make_array()).empty());
 }
 
 TEST_F(HelpersTest, GetBoolean)
@@ -157,8 +170,15 @@ TEST_F(HelpersTest, GetNumber)
 
 TEST_F(HelpersTest, GetObject)
 {
-    // get_object is not available in the current helper functions
-    GTEST_SKIP() << "get_object helper function not implemented";
+    auto obj = std::make_shared<JsonObject>();
+    obj->insert("key", maker::make_boolean(true));
+
+    const auto &members = getter::get_object(obj);
+    EXPECT_EQ(&members, &obj->get_data());
+    EXPECT_EQ(members.size(), 1u);
+
+    EXPECT_THROW(getter::get_object(maker::make_string("x")), std::runtime_error);
+    EXPECT_THROW(getter::get_object(nullptr), std::runtime_error);
 }
 
 TEST_F(HelpersTest, GetArray)
@@ -259,3 +279,56 @@ TEST_F(HelpersTest, HelperIntegration)
         GTEST_SKIP() << "Helper functions not available for integration test";
     }
 }
+
+// Reference accessors read the node without copying
+TEST_F(HelpersTest, ReferenceAccessors)
+{
+    auto str = maker::make_string(std::string(64, 'x'));
+    const std::string &ref = getter::get_string_ref(str);
+    EXPECT_EQ(&ref, &static_cast<JsonString &>(*str).value);
+    EXPECT_EQ(getter::get_string_view(str).data(), ref.data());
+    EXPECT_EQ(getter::get_string_view(str).size(), 64u);
+
+    auto arr = std::make_shared<JsonArray>();
+    arr->insert(maker::make_number(1));
+    EXPECT_EQ(&getter::get_array_ref(arr), &arr->elements);
+
+    EXPECT_THROW(getter::get_string_ref(arr), std::runtime_error);
+    EXPECT_THROW(getter::get_string_view(nullptr), std::runtime_error);
+    EXPECT_THROW(getter::get_array_ref(str), std::runtime_error);
+}
+
+TEST_F(HelpersTest, MoveConstructionDoesNotCopyBuffers)
+{
+    std::string text(256, 'a');
+    const char *buffer = text.data();
+    auto str = maker::make_string(std::move(text));
+    EXPECT_EQ(getter::get_string_ref(str).data(), buffer);
+
+    std::vector<std::shared_ptr<JsonObject>> elements(8);
+    const auto *storage = elements.data();
+    JsonArray arr(std::move(elements));
+    EXPECT_EQ(arr.elements.data(), storage);
+
+    std::string key(64, 'k');
+    const char *key_buffer = key.data();
+    JsonObject obj;
+    obj.insert(std::move(key), nullptr);
+    EXPECT_EQ(obj.get_data().begin()->first.data(), key_buffer);
+}
+
+TEST_F(HelpersTest, Emplace)
+{
+    JsonObject obj;
+    obj.reserve(4);
+    auto name = obj.emplace<JsonString>("name", "value");
+    auto list = obj.emplace<JsonArray>("list");
+    list->emplace_back<JsonNumber>(3);
+    list->emplace_back<JsonBoolean>(true);
+
+    EXPECT_EQ(obj.get("name"), name);
+    EXPECT_EQ(name->value, "value");
+    ASSERT_EQ(list->elements.size(), 2u);
+    EXPECT_DOUBLE_EQ(getter::get_number(list->elements[0]), 3);
+    EXPECT_TRUE(getter::get_boolean(list->elements[1]));
+}
@@ -0,0 +1,263 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+
+using namespace hh_json;
+
+class IncrementalParserTest : public ::testing::Test
+{
+protected:
+    // Every kind of token, including escapes, a surrogate pair and empty containers
+    const std::string document = R"({"name":"café \"x\"\n","pair":"😀","n":-12.5e+3,"i":42,)"
+                                 R"("t":true,"f":false,"z":null,"e":[],"o":{},"list":[1,[2,[3,{"deep":"yes"}]],"s"]})";
+
+    static std::shared_ptr<JsonObject> feed_in_pieces(const std::string &json, size_t piece)
+    {
+        IncrementalParser parser;
+        for (size_t i = 0; i < json.size(); i += piece)
+        {
+            parser.feed(std::string_view(json).substr(i, piece));
+        }
+        EXPECT_EQ(parser.finish(), IncrementalParser::Status::Done);
+        auto result = parser.result();
+        return result ? *result : nullptr;
+    }
+};
+
+TEST_F(IncrementalParserTest, EverySplitPointGivesTheSameTree)
+{
+    auto expected = std::make_shared<JsonObject>(parse(document));
+    for (size_t split = 0; split <= document.size(); ++split)
+    {
+        IncrementalParser parser;
+        parser.feed(std::string_view(document).substr(0, split));
+        parser.feed(std::string_view(document).substr(split));
+        ASSERT_EQ(parser.status(), IncrementalParser::Status::Done) << split;
+        EXPECT_TRUE(equals(parser.result().value(), expected)) << split;
+    }
+}
+
+TEST_F(IncrementalParserTest, ByteAtATime)
+{
+    auto expected = std::make_shared<JsonObject>(parse(document));
+    EXPECT_TRUE(equals(feed_in_pieces(document, 1), expected));
+
+    std::string spaced = "  {\n  \"a\" : [ 1 , 2 ] ,\t\"b\" : { \"c\" : \"d\" }\n}\n";
+    EXPECT_TRUE(equals(feed_in_pieces(spaced, 1), std::make_shared<JsonObject>(parse(spaced))));
+}
+
+TEST_F(IncrementalParserTest, NumbersAndLiteralsWaitAtTheEndOfAChunk)
+{
+    IncrementalParser parser;
+    EXPECT_EQ(parser.feed(R"({"n": 12)"), IncrementalParser::Status::NeedInput);
+    EXPECT_EQ(parser.feed(R"(34, "b": tr)"), IncrementalParser::Status::NeedInput);
+    EXPECT_EQ(parser.feed("ue}"), IncrementalParser::Status::Done);
+    auto root = parser.result().value();
+    EXPECT_EQ(getter::get_number(root->get("n")), 1234);
+    EXPECT_TRUE(getter::get_boolean(root->get("b")));
+}
+
+TEST_F(IncrementalParserTest, OnlyTheUnfinishedTokenIsBuffered)
+{
+    std::string json = "{\"items\": [";
+    for (int i = 0; i < 2000; ++i)
+    {
+        json += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"tag\": \"item\"}";
+    }
+    json += "], \"text\": \"" + std::string(5000, 'x') + "\"}";
+
+    IncrementalParser parser;
+    size_t most = 0;
+    for (size_t i = 0; i < json.size(); i += 64)
+    {
+        parser.feed(std::string_view(json).substr(i, 64));
+        most = std::max(most, parser.buffered());
+    }
+    ASSERT_EQ(parser.status(), IncrementalParser::Status::Done);
+    EXPECT_EQ(parser.consumed(), json.size());
+    // The long string is the largest token; nothing else piles up
+    EXPECT_LT(most, 5000u + 64 + 8);
+    EXPECT_EQ(getter::get_array_ref(parser.result().value()->get("items")).size(), 2000u);
+}
+
+TEST_F(IncrementalParserTest, ErrorsMatchTryParse)
+{
+    // Compact input: parse() strips whitespace first, which shifts its offsets
+    for (std::string json : {R"({"a":[1,2,{"b":tru}]})", R"({"a":"x",})", R"({"a"1})", R"([1])", R"({"a":[1,2)", R"({"a":)", "", R"({"a":"\x"})"})
+    {
+        IncrementalParser parser;
+        parser.feed(json);
+        EXPECT_EQ(parser.finish(), IncrementalParser::Status::Failed) << json;
+        auto expected = try_parse(json);
+        ASSERT_FALSE(expected) << json;
+        EXPECT_EQ(parser.result().error().code, expected.error().code) << json;
+        EXPECT_EQ(parser.result().error().offset, expected.error().offset) << json;
+    }
+}
+
+TEST_F(IncrementalParserTest, LimitsApplyBeforeTheInputIsComplete)
+{
+    ParseOptions options;
+    options.max_string_length = 100;
+    IncrementalParser strings(options);
+    strings.feed("{\"a\": \"" + std::string(200, 'x'));
+    EXPECT_EQ(strings.status(), IncrementalParser::Status::Failed);
+    EXPECT_EQ(strings.result().error().code, ParseErrc::StringTooLong);
+
+    options = ParseOptions();
+    options.max_size = 10;
+    IncrementalParser size(options);
+    EXPECT_EQ(size.feed("{\"a\": "), IncrementalParser::Status::NeedInput);
+    EXPECT_EQ(size.feed("12345"), IncrementalParser::Status::Failed);
+    EXPECT_EQ(size.result().error().code, ParseErrc::DocumentTooLarge);
+}
+
+TEST_F(IncrementalParserTest, ResultBeforeTheEnd)
+{
+    IncrementalParser parser;
+    parser.feed(R"({"a": [1, 2)");
+    auto result = parser.result();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::UnexpectedEnd);
+}
+
+TEST_F(IncrementalParserTest, ResetStartsANewDocument)
+{
+    IncrementalParser parser;
+    parser.feed(R"({"a": 1} trailing input is ignored)");
+    ASSERT_EQ(parser.status(), IncrementalParser::Status::Done);
+    parser.reset();
+    EXPECT_EQ(parser.consumed(), 0u);
+    EXPECT_EQ(parser.feed(R"({"b": "two"})"), IncrementalParser::Status::Done);
+    auto root = parser.result().value();
+    EXPECT_FALSE(root->has_key("a"));
+    EXPECT_EQ(getter::get_string(root->get("b")), "two");
+}
+
+TEST_F(IncrementalParserTest, ChunkedSerializerMatchesStringify)
+{
+    auto root = JsonValue(document);
+    ASSERT_NE(root, nullptr);
+    std::string expected = root->stringify();
+
+    for (size_t piece : {1, 7, 64, 100000})
+    {
+        ChunkedSerializer serializer(root);
+        std::string out;
+        size_t calls = 0;
+        while (!serializer.write_some(out, piece))
+        {
+            ++calls;
+        }
+        EXPECT_TRUE(serializer.done());
+        EXPECT_EQ(out, expected) << piece;
+        if (piece == 1)
+        {
+            EXPECT_GT(calls, 10u);
+        }
+    }
+
+    std::string out;
+    EXPECT_TRUE(ChunkedSerializer(nullptr).write_some(out, 16));
+    EXPECT_EQ(out, "null");
+}
+
+TEST_F(IncrementalParserTest, StepsStayWithinAByteBudget)
+{
+    std::string json = "{\"items\": [";
+    for (int i = 0; i < 2000; ++i)
+    {
+        json += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"tag\": \"item\"}";
+    }
+    json += "]}";
+
+    IncrementalParser parser;
+    parser.append(json);
+    parser.end_input();
+    StepBudget budget;
+    budget.bytes = 256;
+    size_t steps = 0;
+    size_t before = 0;
+    while (parser.step(budget) == IncrementalParser::Status::NeedTime)
+    {
+        ++steps;
+        // A step may finish the token it is in past the budget
+        EXPECT_LE(parser.consumed() - before, 256u + 16) << steps;
+        EXPECT_GT(parser.consumed(), before);
+        before = parser.consumed();
+    }
+    ASSERT_EQ(parser.status(), IncrementalParser::Status::Done);
+    EXPECT_GE(steps, json.size() / (256 + 16));
+    EXPECT_LT(parser.buffered(), json.size());
+    EXPECT_TRUE(equals(parser.result().value(), std::make_shared<JsonObject>(parse(json))));
+}
+
+TEST_F(IncrementalParserTest, EveryStepMakesProgress)
+{
+    IncrementalParser parser;
+    parser.append(document);
+    parser.end_input();
+    StepBudget budget;
+    budget.bytes = 0;
+    budget.time = std::chrono::microseconds(0);
+    size_t steps = 0;
+    while (parser.step(budget) == IncrementalParser::Status::NeedTime)
+    {
+        ASSERT_LT(++steps, document.size());
+    }
+    ASSERT_EQ(parser.status(), IncrementalParser::Status::Done);
+    EXPECT_GT(steps, 10u);
+    EXPECT_TRUE(equals(parser.result().value(), std::make_shared<JsonObject>(parse(document))));
+}
+
+TEST_F(IncrementalParserTest, StepsInterleaveWithInput)
+{
+    IncrementalParser parser;
+    StepBudget budget;
+    budget.bytes = 8;
+    for (size_t i = 0; i < document.size(); i += 16)
+    {
+        parser.append(std::string_view(document).substr(i, 16));
+        parser.step(budget);
+    }
+    parser.end_input();
+    while (parser.step(budget) == IncrementalParser::Status::NeedTime)
+    {
+    }
+    ASSERT_EQ(parser.status(), IncrementalParser::Status::Done);
+    EXPECT_TRUE(equals(parser.result().value(), std::make_shared<JsonObject>(parse(document))));
+}
+
+TEST_F(IncrementalParserTest, ExhaustedBufferNeedsInputNotTime)
+{
+    IncrementalParser parser;
+    parser.append("{\"a\": 1, \"b\":");
+    EXPECT_EQ(parser.step(StepBudget{}), IncrementalParser::Status::NeedInput);
+
+    StepBudget budget;
+    budget.bytes = 64;
+    parser.append(" 2,");
+    EXPECT_EQ(parser.step(budget), IncrementalParser::Status::NeedInput);
+    parser.append(" \"c\": 3}");
+    EXPECT_EQ(parser.step(budget), IncrementalParser::Status::Done);
+    EXPECT_TRUE(equals(parser.result().value(), JsonValue(R"({"a": 1, "b": 2, "c": 3})")));
+}
+
+TEST_F(IncrementalParserTest, CancelStopsTheParse)
+{
+    std::atomic<bool> cancel{false};
+    StepBudget budget;
+    budget.bytes = 32;
+    budget.cancel = &cancel;
+
+    IncrementalParser parser;
+    parser.append(document);
+    parser.end_input();
+    EXPECT_EQ(parser.step(budget), IncrementalParser::Status::NeedTime);
+    cancel = true;
+    EXPECT_EQ(parser.step(budget), IncrementalParser::Status::Failed);
+    EXPECT_EQ(parser.result().error().code, ParseErrc::Cancelled);
+    EXPECT_EQ(parser.result().error().offset, parser.consumed());
+}
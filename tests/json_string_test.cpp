@@ -155,3 +155,20 @@ TEST_F(JsonStringTest, ModifyAfterCreation)
     EXPECT_EQ(json_str->value, "modified");
     EXPECT_EQ(json_str->stringify(), "\"modified\"");
 }
+
+TEST_F(JsonStringTest, LazySliceMaterializes)
+{
+    auto source = std::make_shared<const std::string>(R"(["ab\tc"])");
+    JsonString lazy(source, 2, 5, true);
+    EXPECT_TRUE(lazy.is_lazy());
+    EXPECT_EQ(lazy.stringify(), R"("ab\tc")");
+
+    EXPECT_EQ(lazy.str(), "ab\tc");
+    EXPECT_FALSE(lazy.is_lazy());
+    EXPECT_EQ(source.use_count(), 1);
+
+    JsonString reset(source, 2, 2, false);
+    reset.set_json_data("new");
+    EXPECT_FALSE(reset.is_lazy());
+    EXPECT_EQ(reset.view(), "new");
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace hh_json;
+
+class NdjsonTest : public ::testing::Test
+{
+protected:
+    static std::vector<std::shared_ptr<JsonObject>> documents(int count)
+    {
+        std::vector<std::shared_ptr<JsonObject>> result;
+        for (int i = 0; i < count; ++i)
+        {
+            result.push_back(std::make_shared<JsonObject>(parse(
+                "{\"n\": " + std::to_string(i) + ", \"tags\": [\"" + std::string(static_cast<size_t>(i % 40), 'x') + "\"]}")));
+        }
+        return result;
+    }
+
+    static std::string serial(const std::vector<std::shared_ptr<JsonObject>> &docs)
+    {
+        std::string text;
+        for (const auto &doc : docs)
+        {
+            text += doc->stringify() + "\n";
+        }
+        return text;
+    }
+
+    static std::vector<std::string> lines(const std::string &text)
+    {
+        std::vector<std::string> result;
+        std::istringstream in(text);
+        for (std::string line; std::getline(in, line);)
+        {
+            result.push_back(line);
+        }
+        return result;
+    }
+
+    static ndjson::WriteOptions options(size_t threads, bool ordered)
+    {
+        ndjson::WriteOptions options;
+        options.threads = threads;
+        options.batch = 7;
+        options.ordered = ordered;
+        options.write_size = 300;
+        return options;
+    }
+};
+
+// Records the size of every write, then fails after a number of them
+class CountingSink : public ndjson::Sink
+{
+public:
+    explicit CountingSink(size_t fail_after) : fail_after(fail_after) {}
+
+    bool write(const std::string_view *pieces, size_t count) override
+    {
+        if (writes.size() == fail_after)
+            return false;
+        writes.push_back(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            text.append(pieces[i]);
+        }
+        return true;
+    }
+
+    size_t fail_after;
+    std::vector<size_t> writes;
+    std::string text;
+};
+
+TEST_F(NdjsonTest, OrderedOutputMatchesSerialStringify)
+{
+    auto docs = documents(1000);
+    std::string expected = serial(docs);
+    for (size_t threads : {1, 2, 8})
+    {
+        std::string text;
+        ndjson::StringSink sink(text);
+        EXPECT_EQ(ndjson::write(docs, sink, options(threads, true)), docs.size());
+        EXPECT_EQ(text, expected) << threads << " threads";
+    }
+}
+
+TEST_F(NdjsonTest, UnorderedOutputHasEveryLineOnce)
+{
+    auto docs = documents(1000);
+    auto expected = lines(serial(docs));
+    std::sort(expected.begin(), expected.end());
+
+    std::string text;
+    ndjson::StringSink sink(text);
+    EXPECT_EQ(ndjson::write(docs, sink, options(4, false)), docs.size());
+    auto written = lines(text);
+    std::sort(written.begin(), written.end());
+    EXPECT_EQ(written, expected);
+}
+
+TEST_F(NdjsonTest, AcceptsOtherDocumentRanges)
+{
+    std::vector<std::shared_ptr<JsonObject>> with_null = {std::make_shared<JsonObject>(parse(R"({"a": 1})")), nullptr};
+    std::string text;
+    ndjson::StringSink sink(text);
+    ndjson::write(with_null, sink);
+    EXPECT_EQ(text, with_null[0]->stringify() + "\nnull\n");
+
+    std::array<FrozenDocument, 2> frozen = {freeze(parse(R"({"a": [1, 2]})")), FrozenDocument()};
+    text.clear();
+    ndjson::write(frozen, sink, options(2, true));
+    EXPECT_EQ(text, frozen[0].stringify() + "\n{}\n");
+
+    std::vector<std::shared_ptr<JsonObject>> empty;
+    EXPECT_EQ(ndjson::write(empty, sink), 0u);
+}
+
+TEST_F(NdjsonTest, SmallBatchesAreGatheredIntoLargeWrites)
+{
+    auto docs = documents(2000);
+    CountingSink sink(SIZE_MAX);
+    auto opts = options(4, true);
+    opts.write_size = 64 * 1024;
+    EXPECT_EQ(ndjson::write(docs, sink, opts), docs.size());
+    EXPECT_EQ(sink.text, serial(docs));
+    EXPECT_LT(sink.writes.size(), 2000u / 7);
+    EXPECT_GT(*std::max_element(sink.writes.begin(), sink.writes.end()), 1u);
+}
+
+TEST_F(NdjsonTest, FailingSinkStopsTheWrite)
+{
+    auto docs = documents(1000);
+    for (size_t threads : {1, 4})
+    {
+        CountingSink sink(3);
+        size_t written = ndjson::write(docs, sink, options(threads, true));
+        EXPECT_LT(written, docs.size());
+        // Exactly the documents the sink accepted
+        EXPECT_EQ(lines(sink.text).size(), written);
+        EXPECT_EQ(sink.text, serial({docs.begin(), docs.begin() + static_cast<std::ptrdiff_t>(written)}));
+    }
+}
+
+TEST_F(NdjsonTest, FdSinkWritesEverything)
+{
+    auto docs = documents(3000);
+    std::string expected = serial(docs);
+    char path[] = "/tmp/hh_json_ndjsonXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ndjson::FdSink sink(fd);
+    EXPECT_EQ(ndjson::write(docs, sink, options(4, true)), docs.size());
+    close(fd);
+
+    std::ifstream in(path, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unlink(path);
+    EXPECT_EQ(text, expected);
+}
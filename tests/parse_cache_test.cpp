@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hh_json;
+
+class ParseCacheTest : public ::testing::Test
+{
+protected:
+    const std::string config = R"({"feature": true, "limit": 10, "name": "flags"})";
+};
+
+TEST_F(ParseCacheTest, HitReturnsSameDocument)
+{
+    ParseCache cache(1 << 20);
+
+    auto first = cache.parse(config);
+    auto second = cache.parse(config);
+
+    EXPECT_EQ(first, second);
+    EXPECT_TRUE(first->has_key("feature"));
+    EXPECT_DOUBLE_EQ(getter::get_number(first->get("limit")), 10.0);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_GT(stats.bytes, config.size());
+}
+
+TEST_F(ParseCacheTest, ValueAndParseAreCachedSeparately)
+{
+    ParseCache cache(1 << 20);
+
+    auto doc = cache.parse(config);
+    auto value = cache.value(config);
+
+    EXPECT_NE(doc, value);
+    EXPECT_EQ(cache.stats().misses, 2u);
+    EXPECT_EQ(cache.value("[1, 2]")->type(), JsonType::Array);
+}
+
+TEST_F(ParseCacheTest, EvictsLeastRecentlyUsedUnderMemoryCap)
+{
+    ParseCache probe(1 << 20);
+    probe.parse(config);
+    size_t entry_bytes = probe.stats().bytes;
+
+    // Room for two entries of this size
+    ParseCache cache(entry_bytes * 2 + entry_bytes / 2);
+    const std::string a = R"({"feature": true, "limit": 11, "name": "flags"})";
+    const std::string b = R"({"feature": true, "limit": 12, "name": "flags"})";
+    const std::string c = R"({"feature": true, "limit": 13, "name": "flags"})";
+
+    auto held = cache.parse(a);
+    cache.parse(b);
+    cache.parse(a); // a becomes most recent
+    cache.parse(c); // evicts b
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_LE(stats.bytes, cache.capacity());
+
+    cache.parse(a);
+    EXPECT_EQ(cache.stats().hits, 2u);
+    cache.parse(b);
+    EXPECT_EQ(cache.stats().misses, 4u);
+
+    // Handles outlive eviction
+    EXPECT_DOUBLE_EQ(getter::get_number(held->get("limit")), 11.0);
+}
+
+TEST_F(ParseCacheTest, OversizedDocumentsAreNotCached)
+{
+    ParseCache cache(16);
+    auto doc = cache.parse(config);
+    ASSERT_NE(doc, nullptr);
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST_F(ParseCacheTest, InvalidInputIsNotCached)
+{
+    ParseCache cache(1 << 20);
+    EXPECT_THROW(cache.parse(R"({"key": })"), std::exception);
+    EXPECT_EQ(cache.value("{invalid"), nullptr);
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST_F(ParseCacheTest, ConcurrentReaders)
+{
+    ParseCache cache(1 << 20);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&]
+                             {
+            for (int i = 0; i < 200; ++i)
+            {
+                auto doc = cache.parse(config);
+                ASSERT_TRUE(doc->has_key("name"));
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 800u);
+    EXPECT_EQ(stats.entries, 1u);
+}
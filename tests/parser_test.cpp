@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "../json-parser.hpp"
+#include <cstdio>
 #include <memory>
 #include <string>
 
@@ -362,3 +363,294 @@ TEST_F(ParserTest, ParseComplexJson)
         FAIL() << "Parsing failed: " << e.what();
     }
 }
+
+// Hostile nesting fails with an error instead of exhausting the stack
+TEST_F(ParserTest, DeepNestingHitsDepthLimit)
+{
+    std::string deep = "{\"a\":" + std::string(100000, '[') + std::string(100000, ']') + "}";
+    auto result = try_parse(deep);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::DepthLimitExceeded);
+    EXPECT_EQ(result.error().offset, 5u + 1023u);
+
+    EXPECT_THROW(parse(deep), std::runtime_error);
+    EXPECT_EQ(JsonValue(std::string(100000, '[')), nullptr);
+
+    ParseOptions options;
+    options.max_depth = 3;
+    EXPECT_TRUE(try_parse(R"({"a": [{"b": 1}]})", options));
+    auto too_deep = try_parse(R"({"a": [{"b": []}]})", options);
+    ASSERT_FALSE(too_deep);
+    EXPECT_EQ(too_deep.error().code, ParseErrc::DepthLimitExceeded);
+}
+
+TEST_F(ParserTest, SizeStringAndElementLimits)
+{
+    ParseOptions options;
+    options.max_size = 16;
+    EXPECT_TRUE(try_parse(R"({"a": "b"})", options));
+    auto large = try_parse(R"({"a": "0123456789"})", options);
+    ASSERT_FALSE(large);
+    EXPECT_EQ(large.error().code, ParseErrc::DocumentTooLarge);
+
+    options = ParseOptions{};
+    options.max_string_length = 4;
+    EXPECT_TRUE(try_parse(R"({"abcd": "wxyz"})", options));
+    auto long_value = try_parse(R"({"a": "abcde"})", options);
+    ASSERT_FALSE(long_value);
+    EXPECT_EQ(long_value.error().code, ParseErrc::StringTooLong);
+    EXPECT_EQ(long_value.error().offset, 6u);
+    auto long_key = try_parse(R"({"abcde": 1})", options);
+    ASSERT_FALSE(long_key);
+    EXPECT_EQ(long_key.error().code, ParseErrc::StringTooLong);
+
+    // The root object counts as a value
+    options = ParseOptions{};
+    options.max_elements = 4;
+    EXPECT_TRUE(try_parse(R"({"a": [1, 2]})", options));
+    auto many = try_parse(R"({"a": [1, 2, 3]})", options);
+    ASSERT_FALSE(many);
+    EXPECT_EQ(many.error().code, ParseErrc::TooManyElements);
+
+    auto value = try_parse_value("[1, 2, 3]", options);
+    EXPECT_TRUE(value);
+    EXPECT_FALSE(try_parse_value("[1, 2, 3, 4]", options));
+}
+
+TEST_F(ParserTest, IterativeParserMatchesStructure)
+{
+    auto value = JsonValue(R"({"a": [[], {}, [1, [2, {"b": [3]}]]], "c": {"d": {"e": null}}})");
+    ASSERT_NE(value, nullptr);
+    EXPECT_TRUE(equals(value->get("a"), JsonValue(R"([[], {}, [1, [2, {"b": [3]}]]])")));
+    EXPECT_TRUE(value->get("c")->get("d")->has_key("e"));
+    EXPECT_EQ(value->get("c")->get("d")->get("e"), nullptr);
+}
+
+TEST_F(ParserTest, UnicodeEscapesDecodeToUtf8)
+{
+    auto parsed = parse(R"({"a": "\u0041\u00e9\u4E16", "b": "\ud83c\udf0d", "c": "raw 世界"})");
+    EXPECT_EQ(getter::get_string(parsed["a"]), "A\xC3\xA9\xE4\xB8\x96");
+    EXPECT_EQ(getter::get_string(parsed["b"]), "\xF0\x9F\x8C\x8D");
+    EXPECT_EQ(getter::get_string(parsed["c"]), "raw 世界");
+
+    auto key = parse(R"({"\u006bey": 1})");
+    EXPECT_TRUE(key.count("key"));
+}
+
+TEST_F(ParserTest, ControlCharactersRoundTrip)
+{
+    for (int c = 0; c < 0x20; ++c)
+    {
+        char escape[8];
+        std::snprintf(escape, sizeof(escape), "\\u%04X", c);
+        auto value = JsonValue(std::string("{\"k\": \"x") + escape + "\", \"" + escape + "\": 1}");
+        ASSERT_NE(value, nullptr) << c;
+        EXPECT_EQ(getter::get_string(value->get("k")), "x" + std::string(1, static_cast<char>(c)));
+
+        std::string text = value->stringify();
+        for (char ch : text)
+        {
+            EXPECT_GE(static_cast<unsigned char>(ch), 0x20u) << "raw control in " << text;
+        }
+        auto again = JsonValue(text);
+        ASSERT_NE(again, nullptr) << text;
+        EXPECT_TRUE(equals(value, again)) << text;
+    }
+}
+
+TEST_F(ParserTest, InvalidEscapesAndUtf8AreRejected)
+{
+    const char *escapes[] = {
+        R"({"a": "\ud83c"})",        // lone high surrogate
+        R"({"a": "\udf0d"})",        // lone low surrogate
+        R"({"a": "\ud83c\u0041"})",  // high surrogate without low
+        R"({"a": "\u12"})",          // short
+        R"({"a": "\uZZZZ"})",        // not hex
+        R"({"a": "\q"})",            // unknown escape
+    };
+    for (const char *json : escapes)
+    {
+        auto result = try_parse(json);
+        ASSERT_FALSE(result) << json;
+        EXPECT_EQ(result.error().code, ParseErrc::InvalidEscape) << json;
+        EXPECT_EQ(result.error().offset, 7u) << json;
+    }
+
+    auto bad = try_parse("{\"a\":\"ok\xC0\xAF\"}");
+    ASSERT_FALSE(bad);
+    EXPECT_EQ(bad.error().code, ParseErrc::InvalidUtf8);
+    EXPECT_EQ(bad.error().offset, 8u);
+
+    for (const std::string &json : {std::string("{\"a\": \"x\ty\"}"), std::string("{\"a\": \"x\ny\"}"), std::string("{\"a\": \"x\0y\"}", 12), std::string("{\"x\ty\": 1}")})
+    {
+        auto control = try_parse(json);
+        ASSERT_FALSE(control) << json;
+        EXPECT_EQ(control.error().code, ParseErrc::ControlCharacter) << json;
+    }
+    auto tab = try_parse("{\"a\": \"x\ty\"}");
+    EXPECT_EQ(tab.error().offset, 8u);
+}
+
+TEST_F(ParserTest, LazyStringsDecodeOnAccess)
+{
+    ParseOptions options;
+    options.lazy_strings = true;
+    auto parsed = parse(R"({"plain": "hello", "esc": "a\nbé", "list": ["x", "\"y\""]})", options);
+
+    auto plain = std::static_pointer_cast<JsonString>(parsed["plain"]);
+    auto esc = std::static_pointer_cast<JsonString>(parsed["esc"]);
+    ASSERT_TRUE(plain->is_lazy());
+    ASSERT_TRUE(esc->is_lazy());
+
+    // Unescaped text is viewed in place; escaped text is decoded once
+    EXPECT_EQ(plain->view(), "hello");
+    EXPECT_TRUE(plain->is_lazy());
+    EXPECT_EQ(esc->view(), "a\nb\xC3\xA9");
+    EXPECT_FALSE(esc->is_lazy());
+    EXPECT_EQ(getter::get_string(parsed["list"]->get("1")), "\"y\"");
+
+    // Untouched strings serialize from the original bytes
+    EXPECT_EQ(parsed["list"]->get("1")->stringify(), R"("\"y\"")");
+    EXPECT_TRUE(equals(parsed["list"], JsonValue(R"(["x", "\"y\""])")));
+}
+
+TEST_F(ParserTest, SetReplacesLazyString)
+{
+    ParseOptions options;
+    options.lazy_strings = true;
+    auto parsed = parse(R"({"a": "old"})", options);
+
+    auto a = std::static_pointer_cast<JsonString>(parsed["a"]);
+    ASSERT_TRUE(a->is_lazy());
+    a->set("new \"text\"");
+    EXPECT_FALSE(a->is_lazy());
+    EXPECT_EQ(a->view(), "new \"text\"");
+    EXPECT_EQ(a->stringify(), R"("new \"text\"")");
+}
+
+TEST_F(ParserTest, LazyStringsValidateEagerly)
+{
+    ParseOptions options;
+    options.lazy_strings = true;
+    auto result = try_parse(R"({"a": "\q"})", options);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::InvalidEscape);
+
+    // A raw control character fails as in eager mode instead of being copied out verbatim
+    auto tab = try_parse("{\"a\": \"x\ty\"}", options);
+    ASSERT_FALSE(tab);
+    EXPECT_EQ(tab.error().code, ParseErrc::ControlCharacter);
+    auto escaped_tab = parse(R"({"a": "x\ty"})", options);
+    EXPECT_EQ(escaped_tab["a"]->stringify(), R"("x\ty")");
+
+    auto value = try_parse_value(R"(["🌍"])", options);
+    ASSERT_TRUE(value);
+    EXPECT_EQ(getter::get_string((*value)->get("0")), "\xF0\x9F\x8C\x8D");
+}
+
+TEST_F(ParserTest, LazyNumbersConvertOnAccess)
+{
+    ParseOptions options;
+    options.lazy_numbers = true;
+    auto parsed = parse(R"({"a": 1.50, "b": -2E+3, "list": [0.1, 7]})", options);
+
+    auto a = std::static_pointer_cast<JsonNumber>(parsed["a"]);
+    auto b = std::static_pointer_cast<JsonNumber>(parsed["b"]);
+    ASSERT_TRUE(a->is_lazy());
+    ASSERT_TRUE(b->is_lazy());
+
+    // Untouched numbers serialize as written
+    EXPECT_EQ(a->stringify(), "1.50");
+    EXPECT_EQ(parsed["list"]->stringify(), "[0.1,7]");
+
+    EXPECT_EQ(getter::get_number(parsed["b"]), -2000);
+    EXPECT_FALSE(b->is_lazy());
+    EXPECT_EQ(b->stringify(), "-2000");
+    EXPECT_TRUE(equals(parsed["list"], JsonValue("[0.1, 7.0]")));
+    EXPECT_TRUE(equals(std::make_shared<JsonObject>(parsed), std::make_shared<JsonObject>(parse(R"({"a": 1.5, "b": -2000, "list": [0.1, 7]})"))));
+}
+
+TEST_F(ParserTest, SetReplacesLazyNumber)
+{
+    ParseOptions options;
+    options.lazy_numbers = true;
+    auto parsed = parse(R"({"a": 1.5})", options);
+
+    auto a = std::static_pointer_cast<JsonNumber>(parsed["a"]);
+    ASSERT_TRUE(a->is_lazy());
+    a->set(7);
+    EXPECT_FALSE(a->is_lazy());
+    EXPECT_EQ(a->stringify(), "7");
+    EXPECT_DOUBLE_EQ(a->number(), 7.0);
+}
+
+TEST_F(ParserTest, NumbersFollowTheJsonGrammar)
+{
+    ParseOptions lazy_options;
+    lazy_options.lazy_numbers = true;
+    for (std::string number : {"01", "-01", "00", "1.", "-.5", "1.e5", "1e", "1E+", "-"})
+    {
+        std::string json = "{\"a\": " + number + "}";
+        for (const ParseOptions &options : {ParseOptions{}, lazy_options})
+        {
+            auto result = try_parse(json, options);
+            ASSERT_FALSE(result) << json;
+            EXPECT_EQ(result.error().code, ParseErrc::InvalidNumber) << json;
+            EXPECT_EQ(result.error().offset, 6u) << json;
+        }
+    }
+    for (std::string number : {"0", "-0", "0.5", "-0.0e-0", "10", "1E5", "1e+05"})
+    {
+        std::string json = "{\"a\": " + number + "}";
+        ASSERT_TRUE(try_parse(json)) << json;
+        auto lazy = try_parse(json, lazy_options);
+        ASSERT_TRUE(lazy) << json;
+        EXPECT_EQ((*lazy)["a"]->stringify(), number);
+    }
+}
+
+TEST_F(ParserTest, LazyNumbersValidateEagerly)
+{
+    ParseOptions options;
+    options.lazy_numbers = true;
+    for (std::string json : {R"({"a":1e})", R"({"a":-})", R"({"a":1e999})", R"({"a":-1e-999})", R"({"a":1e+})"})
+    {
+        auto lazy = try_parse(json, options);
+        auto eager = try_parse(json);
+        ASSERT_FALSE(lazy) << json;
+        ASSERT_FALSE(eager) << json;
+        EXPECT_EQ(lazy.error().code, eager.error().code) << json;
+        EXPECT_EQ(lazy.error().offset, eager.error().offset) << json;
+    }
+
+    // Near the edge of the range the text is converted while parsing
+    auto large = try_parse(R"({"a": 1e300, "b": 12})", options);
+    ASSERT_TRUE(large);
+    EXPECT_FALSE(std::static_pointer_cast<JsonNumber>((*large)["a"])->is_lazy());
+    EXPECT_TRUE(std::static_pointer_cast<JsonNumber>((*large)["b"])->is_lazy());
+    EXPECT_EQ(getter::get_number((*large)["a"]), 1e300);
+}
+
+TEST_F(ParserTest, LazyNumbersToInt64)
+{
+    ParseOptions options;
+    options.lazy_numbers = true;
+    auto parsed = parse(R"({"big": 9007199254740993, "neg": -42, "frac": 2.5, "whole": 3.0, "huge": 1e30})", options);
+    auto number = [&](const char *key)
+    { return std::static_pointer_cast<JsonNumber>(parsed[key]); };
+
+    int64_t value = 0;
+    // Beyond 2^53, exact only from the original text
+    ASSERT_TRUE(number("big")->to_int64(value));
+    EXPECT_EQ(value, 9007199254740993LL);
+    EXPECT_TRUE(number("big")->is_lazy());
+    ASSERT_TRUE(number("neg")->to_int64(value));
+    EXPECT_EQ(value, -42);
+    ASSERT_TRUE(number("whole")->to_int64(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_FALSE(number("frac")->to_int64(value));
+    EXPECT_FALSE(number("huge")->to_int64(value));
+    EXPECT_FALSE(JsonNumber(2.5).to_int64(value));
+    ASSERT_TRUE(JsonNumber(-8).to_int64(value));
+    EXPECT_EQ(value, -8);
+}
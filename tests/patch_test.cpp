@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <memory>
+#include <string>
+
+using namespace hh_json;
+
+class PatchTest : public ::testing::Test
+{
+protected:
+    std::shared_ptr<JsonObject> doc(const std::string &json)
+    {
+        return JsonValue(json);
+    }
+};
+
+// RFC 6902 Appendix A examples
+TEST_F(PatchTest, AddObjectMemberAndArrayElement)
+{
+    auto target = doc(R"({"foo": "bar", "list": ["a", "c"]})");
+    patch::apply(target, R"([
+        {"op": "add", "path": "/baz", "value": "qux"},
+        {"op": "add", "path": "/list/1", "value": "b"},
+        {"op": "add", "path": "/list/-", "value": "d"}
+    ])");
+    EXPECT_TRUE(equals(target, doc(R"({"foo": "bar", "baz": "qux", "list": ["a", "b", "c", "d"]})")));
+}
+
+TEST_F(PatchTest, RemoveAndReplace)
+{
+    auto target = doc(R"({"baz": "qux", "foo": "bar", "list": [1, 2, 3]})");
+    patch::apply(target, R"([
+        {"op": "remove", "path": "/baz"},
+        {"op": "replace", "path": "/foo", "value": "boo"},
+        {"op": "remove", "path": "/list/0"}
+    ])");
+    EXPECT_TRUE(equals(target, doc(R"({"foo": "boo", "list": [2, 3]})")));
+}
+
+TEST_F(PatchTest, KeysWithQuotesAndBackslashes)
+{
+    auto target = doc(R"({"a\"b": 1, "c\\d": {"x": 1}})");
+    patch::apply(target, R"([
+        {"op": "replace", "path": "/a\"b", "value": 2},
+        {"op": "remove", "path": "/c\\d/x"},
+        {"op": "add", "path": "/e\"f", "value": true},
+        {"op": "test", "path": "/e\"f", "value": true}
+    ])");
+    auto expected = doc(R"({"a\"b": 2, "c\\d": {}, "e\"f": true})");
+    EXPECT_TRUE(equals(target, expected));
+    // Still valid JSON after the insert
+    EXPECT_TRUE(equals(JsonValue(target->stringify()), expected));
+}
+
+TEST_F(PatchTest, MoveAndCopy)
+{
+    auto target = doc(R"({"foo": {"bar": "baz", "waldo": "fred"}, "qux": {"corge": "grault"}})");
+    patch::apply(target, R"([
+        {"op": "move", "from": "/foo/waldo", "path": "/qux/thud"},
+        {"op": "copy", "from": "/qux", "path": "/copied"}
+    ])");
+    EXPECT_TRUE(equals(target, doc(R"({
+        "foo": {"bar": "baz"},
+        "qux": {"corge": "grault", "thud": "fred"},
+        "copied": {"corge": "grault", "thud": "fred"}
+    })")));
+
+    // The copy is independent of its source
+    patch::apply(target, R"([{"op": "remove", "path": "/qux/thud"}])");
+    EXPECT_TRUE(target->get("copied")->has_key("thud"));
+}
+
+TEST_F(PatchTest, TestOperation)
+{
+    auto target = doc(R"({"baz": "qux", "foo": ["a", 2, "c"]})");
+    EXPECT_NO_THROW(patch::apply(target, R"([
+        {"op": "test", "path": "/baz", "value": "qux"},
+        {"op": "test", "path": "/foo/1", "value": 2}
+    ])"));
+    EXPECT_THROW(patch::apply(target, R"([{"op": "test", "path": "/baz", "value": "bar"}])"), std::runtime_error);
+}
+
+TEST_F(PatchTest, FailedPatchIsRolledBack)
+{
+    auto target = doc(R"({"a": 1, "list": [1, 2], "obj": {"k": "v"}})");
+    auto original = patch::clone(target);
+
+    EXPECT_THROW(patch::apply(target, R"([
+        {"op": "add", "path": "/b", "value": 2},
+        {"op": "remove", "path": "/list/0"},
+        {"op": "replace", "path": "/obj/k", "value": "w"},
+        {"op": "move", "from": "/a", "path": "/obj/a"},
+        {"op": "remove", "path": "/missing"}
+    ])"),
+                 std::runtime_error);
+    EXPECT_TRUE(equals(target, original));
+}
+
+TEST_F(PatchTest, RootOperations)
+{
+    auto target = doc(R"({"a": 1})");
+    patch::apply(target, R"([{"op": "replace", "path": "", "value": [1, 2]}])");
+    EXPECT_EQ(getter::get_type(target), JsonType::Array);
+    EXPECT_THROW(patch::apply(target, R"([{"op": "remove", "path": ""}])"), std::runtime_error);
+}
+
+TEST_F(PatchTest, InvalidPatches)
+{
+    auto target = doc(R"({"a": {"b": 1}, "list": [1]})");
+    EXPECT_THROW(patch::apply(target, R"({"op": "add"})"), std::runtime_error);
+    EXPECT_THROW(patch::apply(target, R"([{"op": "frobnicate", "path": "/a"}])"), std::runtime_error);
+    EXPECT_THROW(patch::apply(target, R"([{"op": "add", "path": "/x/y", "value": 1}])"), std::runtime_error);
+    EXPECT_THROW(patch::apply(target, R"([{"op": "add", "path": "/list/5", "value": 1}])"), std::runtime_error);
+    EXPECT_THROW(patch::apply(target, R"([{"op": "move", "from": "/a", "path": "/a/b/c"}])"), std::runtime_error);
+    EXPECT_THROW(patch::apply(target, R"([{"op": "move", "from": "/missing", "path": "/missing"}])"), std::runtime_error);
+    EXPECT_THROW(patch::apply(target, R"([{"op": "move", "from": "/list/3", "path": "/list/3"}])"), std::runtime_error);
+    EXPECT_NO_THROW(patch::apply(target, R"([{"op": "move", "from": "/a/b", "path": "/a/b"}])"));
+    EXPECT_THROW(patch::apply(target, R"([{"op": "add", "path": "/a/b/c", "value": 1}])"), std::runtime_error);
+    EXPECT_THROW(patch::apply(target, "[{"), std::runtime_error);
+}
+
+// RFC 7396 Section 3 example
+TEST_F(PatchTest, MergePatch)
+{
+    auto target = doc(R"({
+        "title": "Goodbye!",
+        "author": {"givenName": "John", "familyName": "Doe"},
+        "tags": ["example", "sample"],
+        "content": "This will be unchanged"
+    })");
+    patch::merge(target, R"({
+        "title": "Hello!",
+        "phoneNumber": "+01-123-456-7890",
+        "author": {"familyName": null},
+        "tags": ["example"]
+    })");
+    EXPECT_TRUE(equals(target, doc(R"({
+        "title": "Hello!",
+        "author": {"givenName": "John"},
+        "tags": ["example"],
+        "content": "This will be unchanged",
+        "phoneNumber": "+01-123-456-7890"
+    })")));
+}
+
+TEST_F(PatchTest, MergePatchNonObjects)
+{
+    auto target = doc(R"({"a": "b"})");
+    patch::merge(target, R"(["c"])");
+    EXPECT_TRUE(equals(target, doc(R"(["c"])")));
+
+    patch::merge(target, R"({"a": {"b": "c"}})");
+    EXPECT_TRUE(equals(target, doc(R"({"a": {"b": "c"}})")));
+
+    patch::merge(target, "null");
+    EXPECT_EQ(target, nullptr);
+}
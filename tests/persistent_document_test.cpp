@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <memory>
+#include <string>
+
+using namespace hh_json;
+
+class PersistentDocumentTest : public ::testing::Test
+{
+protected:
+    std::shared_ptr<JsonObject> base = JsonValue(R"({
+        "service": {"name": "api", "replicas": 3},
+        "limits": {"cpu": 2, "memory": 512},
+        "regions": ["eu", "us"]
+    })");
+};
+
+TEST_F(PersistentDocumentTest, WithLeavesOriginalUntouched)
+{
+    PersistentDocument v1(base);
+    auto v2 = v1.with("/service/replicas", maker::make_number(5));
+
+    EXPECT_DOUBLE_EQ(getter::get_number(v1.get("/service/replicas")), 3.0);
+    EXPECT_DOUBLE_EQ(getter::get_number(v2.get("/service/replicas")), 5.0);
+    EXPECT_TRUE(equals(v1.to_object(), base));
+}
+
+TEST_F(PersistentDocumentTest, UntouchedSubtreesAreShared)
+{
+    PersistentDocument v1(base);
+    auto v2 = v1.with("/service/replicas", maker::make_number(5));
+
+    EXPECT_TRUE(v1.same_subtree(v2, "/limits"));
+    EXPECT_TRUE(v1.same_subtree(v2, "/regions"));
+    EXPECT_TRUE(v1.same_subtree(v2, "/service/name"));
+    EXPECT_FALSE(v1.same_subtree(v2, "/service"));
+    EXPECT_FALSE(v1.same_subtree(v2, ""));
+}
+
+TEST_F(PersistentDocumentTest, AddAppendAndRemove)
+{
+    PersistentDocument v1(base);
+    auto v2 = v1.with("/limits/disk", maker::make_number(10))
+                  .with("/regions/-", maker::make_string("ap"))
+                  .with("/regions/0", maker::make_string("eu-west"));
+
+    EXPECT_EQ(v2.size("/limits"), 3u);
+    EXPECT_EQ(v2.size("/regions"), 3u);
+    EXPECT_EQ(getter::get_string(v2.get("/regions/0")), "eu-west");
+    EXPECT_EQ(getter::get_string(v2.get("/regions/2")), "ap");
+
+    auto v3 = v2.without("/limits/cpu").without("/regions/1");
+    EXPECT_FALSE(v3.contains("/limits/cpu"));
+    EXPECT_EQ(v3.size("/regions"), 2u);
+    EXPECT_EQ(getter::get_string(v3.get("/regions/1")), "ap");
+    EXPECT_TRUE(v2.contains("/limits/cpu"));
+}
+
+TEST_F(PersistentDocumentTest, LargeObjectUsesTrie)
+{
+    auto wide = std::make_shared<JsonObject>();
+    for (int i = 0; i < 5000; ++i)
+    {
+        wide->insert("key" + std::to_string(i), maker::make_number(i));
+    }
+
+    PersistentDocument v1(wide);
+    EXPECT_EQ(v1.size(), 5000u);
+
+    auto v2 = v1.with("/key1234", maker::make_string("changed")).without("/key42");
+    EXPECT_EQ(v2.size(), 4999u);
+    EXPECT_EQ(getter::get_string(v2.get("/key1234")), "changed");
+    EXPECT_FALSE(v2.contains("/key42"));
+    EXPECT_TRUE(v2.same_subtree(v1, "/key4999"));
+    EXPECT_DOUBLE_EQ(getter::get_number(v1.get("/key1234")), 1234.0);
+
+    for (int i = 0; i < 5000; i += 97)
+    {
+        auto path = "/key" + std::to_string(i);
+        if (i != 1234 && i != 42)
+        {
+            EXPECT_DOUBLE_EQ(getter::get_number(v2.get(path)), i);
+        }
+    }
+}
+
+TEST_F(PersistentDocumentTest, PointerEscapesAndErrors)
+{
+    PersistentDocument doc;
+    auto v = doc.with("/a~1b", maker::make_string("slash")).with("/c~0d", maker::make_string("tilde"));
+
+    EXPECT_EQ(getter::get_string(v.get("/a~1b")), "slash");
+    EXPECT_EQ(getter::get_string(v.get("/c~0d")), "tilde");
+
+    EXPECT_THROW(v.with("/missing/child", maker::make_number(1)), std::runtime_error);
+    EXPECT_THROW(v.get("/nope"), std::runtime_error);
+    EXPECT_THROW(v.without(""), std::runtime_error);
+    EXPECT_FALSE(v.contains("/a~1b/x"));
+}
+
+TEST_F(PersistentDocumentTest, ReplaceRoot)
+{
+    PersistentDocument doc(base);
+    auto replaced = doc.with("", JsonValue("[1, 2, 3]"));
+    EXPECT_EQ(replaced.type(), JsonType::Array);
+    EXPECT_EQ(replaced.size(), 3u);
+}
+
+TEST_F(PersistentDocumentTest, RemoveEveryKeyFromLargeObject)
+{
+    PersistentDocument doc;
+    for (int i = 0; i < 2000; ++i)
+    {
+        doc = doc.with("/k" + std::to_string(i), maker::make_number(i));
+    }
+    EXPECT_EQ(doc.size(), 2000u);
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        int key = (i * 7) % 2000;
+        doc = doc.without("/k" + std::to_string(key));
+        ASSERT_FALSE(doc.contains("/k" + std::to_string(key)));
+    }
+    EXPECT_EQ(doc.size(), 0u);
+    EXPECT_EQ(doc.stringify(), "{}");
+}
+
+TEST_F(PersistentDocumentTest, PointerTokensMatchEscapedKeys)
+{
+    PersistentDocument doc(JsonValue(R"({"a\"b": 1, "c\\d": 2})"));
+    EXPECT_TRUE(doc.contains("/a\"b"));
+    EXPECT_TRUE(doc.contains("/c\\d"));
+    EXPECT_DOUBLE_EQ(getter::get_number(doc.get("/a\"b")), 1.0);
+    EXPECT_DOUBLE_EQ(getter::get_number(doc.get("/c\\d")), 2.0);
+
+    auto replaced = doc.with("/a\"b", maker::make_number(5));
+    EXPECT_EQ(replaced.size(), 2u);
+    EXPECT_DOUBLE_EQ(getter::get_number(replaced.get("/a\"b")), 5.0);
+
+    auto added = doc.with("/x\"y", maker::make_number(3));
+    EXPECT_TRUE(equals(JsonValue(added.stringify()), JsonValue(R"({"a\"b": 1, "c\\d": 2, "x\"y": 3})")));
+
+    auto removed = doc.without("/c\\d");
+    EXPECT_FALSE(removed.contains("/c\\d"));
+    EXPECT_EQ(removed.size(), 1u);
+}
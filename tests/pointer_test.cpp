@@ -0,0 +1,22 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <string>
+#include <vector>
+
+using namespace hh_json;
+
+TEST(PointerTest, ParseAndEscape)
+{
+    EXPECT_TRUE(pointer::parse("").empty());
+    EXPECT_EQ(pointer::parse("/a/b~1c/~0"), (std::vector<std::string>{"a", "b/c", "~"}));
+    EXPECT_EQ(pointer::parse("/"), (std::vector<std::string>{""}));
+    EXPECT_EQ(pointer::escape("a/b~c"), "a~1b~0c");
+    EXPECT_THROW(pointer::parse("a"), std::runtime_error);
+    EXPECT_THROW(pointer::parse("/~2"), std::runtime_error);
+
+    EXPECT_EQ(pointer::array_index("-", 4), 4u);
+    EXPECT_EQ(pointer::array_index("3", 4), 3u);
+    EXPECT_THROW(pointer::array_index("01", 4), std::runtime_error);
+    EXPECT_THROW(pointer::array_index("5", 4), std::runtime_error);
+    EXPECT_THROW(pointer::array_index("99999999999999999999999", 4), std::runtime_error);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hh_json;
+
+class PoolTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        saved = pool::limits();
+        pool::trim();
+    }
+    void TearDown() override
+    {
+        pool::set_limits(saved);
+        pool::trim();
+    }
+
+    pool::Limits saved;
+};
+
+TEST_F(PoolTest, ReusesTheSameParserOnOneThread)
+{
+    Parser *first;
+    {
+        auto parser = pool::acquire();
+        first = parser.get();
+        auto result = parser->parse(R"({"a": [1, 2]})");
+        ASSERT_TRUE(result);
+    }
+    EXPECT_EQ(pool::usage().local_parsers, 1u);
+
+    auto again = pool::acquire();
+    EXPECT_EQ(again.get(), first);
+    EXPECT_EQ(pool::usage().local_parsers, 0u);
+    auto result = again->parse(R"({"b": "x"})");
+    ASSERT_TRUE(result);
+    EXPECT_EQ(getter::get_string((*result)->get("b")), "x");
+}
+
+TEST_F(PoolTest, AcquireAppliesOptions)
+{
+    {
+        auto parser = pool::acquire();
+    }
+    ParseOptions options;
+    options.max_depth = 1;
+    auto parser = pool::acquire(options);
+    auto result = parser->parse(R"({"a": {"b": 1}})");
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, ParseErrc::DepthLimitExceeded);
+}
+
+TEST_F(PoolTest, FullThreadListOverflowsToTheBoundedGlobalList)
+{
+    pool::set_limits({1, 2});
+    {
+        std::vector<pool::Lease<Parser>> leases;
+        for (int i = 0; i < 4; ++i)
+        {
+            leases.push_back(pool::acquire());
+        }
+    }
+    auto usage = pool::usage();
+    EXPECT_EQ(usage.local_parsers, 1u);
+    EXPECT_EQ(usage.global_parsers, 2u); // the fourth was freed
+
+    // Another thread has nothing of its own and draws from the overflow
+    std::thread([]
+                {
+                    auto parser = pool::acquire();
+                    EXPECT_EQ(pool::usage().local_parsers, 0u);
+                    EXPECT_EQ(pool::usage().global_parsers, 1u);
+                    parser.reset();
+                    EXPECT_EQ(pool::usage().local_parsers, 1u); })
+        .join();
+}
+
+TEST_F(PoolTest, ExitingThreadHandsItsItemsToTheGlobalList)
+{
+    std::thread([]
+                {
+                    auto parser = pool::acquire();
+                    auto document = pool::acquire_document(); })
+        .join();
+    auto usage = pool::usage();
+    EXPECT_EQ(usage.local_parsers, 0u);
+    EXPECT_EQ(usage.global_parsers, 1u);
+    EXPECT_EQ(usage.global_documents, 1u);
+
+    auto parser = pool::acquire();
+    EXPECT_EQ(pool::usage().global_parsers, 0u);
+}
+
+TEST_F(PoolTest, DocumentsComeBackEmpty)
+{
+    JsonObject *first;
+    {
+        auto document = pool::acquire_document();
+        first = document.get();
+        document->insert("status", maker::make_string("ok"));
+        document->insert("count", maker::make_number(3));
+        EXPECT_EQ(document->get_data().size(), 2u);
+    }
+
+    auto document = pool::acquire_document();
+    EXPECT_EQ(document.get(), first);
+    EXPECT_TRUE(document->get_data().empty());
+}
+
+TEST_F(PoolTest, LeasesMove)
+{
+    auto a = pool::acquire();
+    Parser *parser = a.get();
+    pool::Lease<Parser> b = std::move(a);
+    EXPECT_EQ(a.get(), nullptr);
+    EXPECT_EQ(b.get(), parser);
+
+    auto c = pool::acquire();
+    c = std::move(b); // c's own parser goes back to the pool
+    EXPECT_EQ(c.get(), parser);
+    EXPECT_EQ(pool::usage().local_parsers, 1u);
+}
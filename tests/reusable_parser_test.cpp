@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <string>
+#include <vector>
+
+using namespace hh_json;
+
+class ReusableParserTest : public ::testing::Test
+{
+protected:
+    // Same document through the free function, for comparison
+    static std::shared_ptr<JsonObject> reference(const std::string &json)
+    {
+        return std::make_shared<JsonObject>(hh_json::parse(json));
+    }
+};
+
+TEST_F(ReusableParserTest, MatchesTryParseAcrossDifferentDocuments)
+{
+    std::vector<std::string> documents = {
+        R"({"name": "svc", "port": 8080, "tags": ["a", "b", {"deep": [1, 2, 3]}], "tls": true, "proxy": null})",
+        R"({"port": "not a number any more", "tags": {"a": 1}, "x\ty": [false, 2.5, "three"]})",
+        R"({"list": [[], {}, [[]]], "text": "a string longer than the small-string buffer"})",
+        R"({})",
+        R"({"name": "svc", "port": 8080, "tags": ["a", "b", {"deep": [1, 2, 3]}], "tls": true, "proxy": null})",
+    };
+
+    Parser parser;
+    for (int round = 0; round < 3; ++round)
+    {
+        for (const auto &json : documents)
+        {
+            auto result = parser.parse(json);
+            ASSERT_TRUE(result) << result.error().message();
+            EXPECT_TRUE(equals(*result, reference(json))) << json;
+        }
+    }
+}
+
+TEST_F(ReusableParserTest, KeptResultsAreNotReused)
+{
+    Parser parser;
+    auto first = parser.parse(R"({"a": [1, 2], "b": {"c": "first"}})").value();
+    auto kept_subtree = parser.parse(R"({"list": ["x", "y"], "n": 1})").value()->get("list");
+
+    // Neither the kept document nor the kept subtree of a dropped one is handed out again
+    for (int i = 0; i < 4; ++i)
+    {
+        auto result = parser.parse(R"({"a": [3], "b": {"c": "later"}, "list": ["z"]})");
+        ASSERT_TRUE(result);
+    }
+    EXPECT_TRUE(equals(first, reference(R"({"a": [1, 2], "b": {"c": "first"}})")));
+    ASSERT_NE(kept_subtree, nullptr);
+    EXPECT_EQ(kept_subtree->stringify(), "[\"x\",\"y\"]");
+}
+
+TEST_F(ReusableParserTest, DuplicateKeysOverwriteWithRecycledEntries)
+{
+    Parser parser;
+    ASSERT_TRUE(parser.parse(R"({"a": 1, "b": 2, "c": 3})"));
+    auto result = parser.parse(R"({"k": 1, "k": 2, "k": "last"})");
+    ASSERT_TRUE(result);
+    EXPECT_EQ((*result)->get_data().size(), 1u);
+    EXPECT_EQ(getter::get_string((*result)->get("k")), "last");
+}
+
+TEST_F(ReusableParserTest, ErrorsMatchTryParseAndLeaveTheParserUsable)
+{
+    Parser parser;
+    for (std::string json : {R"({"a": [1, 2, {"b": tru}]})", R"({"a": "unterminated)", R"([1, 2])", R"({"a": 1,})"})
+    {
+        auto result = parser.parse(json);
+        auto expected = try_parse(json);
+        ASSERT_FALSE(result);
+        ASSERT_FALSE(expected);
+        EXPECT_EQ(result.error().code, expected.error().code) << json;
+        EXPECT_EQ(result.error().offset, expected.error().offset) << json;
+
+        auto good = parser.parse(R"({"a": [1, 2, {"b": true}]})");
+        ASSERT_TRUE(good);
+        EXPECT_TRUE(equals(*good, reference(R"({"a": [1, 2, {"b": true}]})")));
+    }
+}
+
+TEST_F(ReusableParserTest, ParseValueAndOptions)
+{
+    ParseOptions options;
+    options.max_depth = 2;
+    Parser parser(options);
+    EXPECT_EQ(parser.options().max_depth, 2u);
+
+    auto value = parser.parse_value("[1, \"two\", [3]]");
+    ASSERT_TRUE(value);
+    EXPECT_EQ((*value)->stringify(), "[1,\"two\",[3]]");
+
+    auto number = parser.parse_value("42");
+    ASSERT_TRUE(number);
+    EXPECT_EQ(getter::get_number(*number), 42);
+
+    auto deep = parser.parse_value("[[[1]]]");
+    ASSERT_FALSE(deep);
+    EXPECT_EQ(deep.error().code, ParseErrc::DepthLimitExceeded);
+
+    parser.release();
+    auto again = parser.parse(R"({"after": "release"})");
+    ASSERT_TRUE(again);
+    EXPECT_EQ(getter::get_string((*again)->get("after")), "release");
+}
+
+TEST_F(ReusableParserTest, LazyStringsAndNumbers)
+{
+    ParseOptions options;
+    options.lazy_strings = true;
+    options.lazy_numbers = true;
+    Parser parser(options);
+    ASSERT_TRUE(parser.parse(R"({"a": "first", "b": ["x\ny", 1.25]})"));
+
+    auto result = parser.parse(R"({"a": "second", "b": ["p\tq", 2e1]})");
+    ASSERT_TRUE(result);
+    EXPECT_EQ(getter::get_string_view((*result)->get("a")), "second");
+    EXPECT_EQ((*result)->get("b")->stringify(), R"(["p\tq",2e1])");
+    EXPECT_TRUE(equals(*result, reference(R"({"a": "second", "b": ["p\tq", 20]})")));
+
+    // Recycled lazy numbers are reset before an eager parse reuses them
+    parser.set_options(ParseOptions());
+    auto eager = parser.parse(R"({"n": 3})");
+    ASSERT_TRUE(eager);
+    EXPECT_FALSE(std::static_pointer_cast<JsonNumber>((*eager)->get("n"))->is_lazy());
+    EXPECT_EQ((*eager)->get("n")->stringify(), "3");
+}
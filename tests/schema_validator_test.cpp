@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <memory>
+#include <string>
+
+using namespace hh_json;
+
+class SchemaValidatorTest : public ::testing::Test
+{
+protected:
+    const std::string user_schema = R"({
+        "type": "object",
+        "required": ["name", "age"],
+        "properties": {
+            "name": {"type": "string", "minLength": 1, "pattern": "^[A-Z]"},
+            "age": {"type": "integer", "minimum": 0, "maximum": 150},
+            "role": {"enum": ["admin", "user"]},
+            "tags": {"type": "array", "maxItems": 3, "items": {"type": "string"}}
+        }
+    })";
+};
+
+TEST_F(SchemaValidatorTest, CompilesToProgram)
+{
+    SchemaValidator validator(user_schema);
+    EXPECT_GT(validator.program_size(), 0u);
+}
+
+TEST_F(SchemaValidatorTest, ValidateParsedTree)
+{
+    SchemaValidator validator(user_schema);
+
+    auto valid = JsonValue(R"({"name": "Alice", "age": 30, "role": "admin", "tags": ["a", "b"]})");
+    EXPECT_TRUE(validator.validate(valid));
+
+    std::string error;
+    auto wrong_type = JsonValue(R"({"name": "Alice", "age": "thirty"})");
+    EXPECT_FALSE(validator.validate(wrong_type, &error));
+    EXPECT_EQ(error, "/age: unexpected type string");
+
+    auto missing = JsonValue(R"({"name": "Alice"})");
+    EXPECT_FALSE(validator.validate(missing, &error));
+    EXPECT_EQ(error, "/: missing required property 'age'");
+
+    auto bad_item = JsonValue(R"({"name": "Alice", "age": 1, "tags": ["a", 2]})");
+    EXPECT_FALSE(validator.validate(bad_item, &error));
+    EXPECT_EQ(error, "/tags/1: unexpected type number");
+}
+
+TEST_F(SchemaValidatorTest, NumericAndStringConstraints)
+{
+    SchemaValidator validator(user_schema);
+
+    EXPECT_FALSE(validator.validate(JsonValue(R"({"name": "Alice", "age": 151})")));
+    EXPECT_FALSE(validator.validate(JsonValue(R"({"name": "Alice", "age": 1.5})")));
+    EXPECT_FALSE(validator.validate(JsonValue(R"({"name": "", "age": 1})")));
+    EXPECT_FALSE(validator.validate(JsonValue(R"({"name": "alice", "age": 1})")));
+    EXPECT_FALSE(validator.validate(JsonValue(R"({"name": "Alice", "age": 1, "role": "root"})")));
+    EXPECT_FALSE(validator.validate(JsonValue(R"({"name": "Alice", "age": 1, "tags": ["a", "b", "c", "d"]})")));
+}
+
+TEST_F(SchemaValidatorTest, ExclusiveBoundsAndTypeLists)
+{
+    SchemaValidator validator(R"({"type": ["number", "null"], "exclusiveMinimum": 0, "exclusiveMaximum": 1})");
+
+    EXPECT_TRUE(validator.validate(maker::make_number(0.5)));
+    EXPECT_TRUE(validator.validate(nullptr));
+    EXPECT_FALSE(validator.validate(maker::make_number(0)));
+    EXPECT_FALSE(validator.validate(maker::make_number(1)));
+    EXPECT_FALSE(validator.validate(maker::make_string("0.5")));
+}
+
+TEST_F(SchemaValidatorTest, FusedParseAcceptsValidDocument)
+{
+    SchemaValidator validator(user_schema);
+
+    auto parsed = parse(R"({"name": "Bob", "age": 42, "tags": ["x"]})", validator);
+    ASSERT_NE(parsed.find("name"), parsed.end());
+    EXPECT_EQ(getter::get_string(parsed["name"]), "Bob");
+    EXPECT_DOUBLE_EQ(getter::get_number(parsed["age"]), 42.0);
+}
+
+TEST_F(SchemaValidatorTest, FusedParseFailsAtFirstViolation)
+{
+    SchemaValidator validator(user_schema);
+
+    try
+    {
+        parse(R"({"age": "old", "name": "Bob"})", validator);
+        FAIL() << "Expected schema violation";
+    }
+    catch (const std::runtime_error &e)
+    {
+        EXPECT_NE(std::string(e.what()).find("Schema violation at position 8"), std::string::npos) << e.what();
+    }
+
+    EXPECT_THROW(parse(R"({"name": "Bob"})", validator), std::runtime_error);
+    EXPECT_THROW(parse(R"({"name": "Bob", "age": 1, "tags": [1]})", validator), std::runtime_error);
+}
+
+TEST_F(SchemaValidatorTest, RequiredMatchesEscapedKeys)
+{
+    SchemaValidator validator(R"({"type": "object", "required": ["a\"b", "c\\d"]})");
+
+    EXPECT_TRUE(validator.validate(JsonValue(R"({"a\"b": 1, "c\\d": 2})")));
+    EXPECT_NO_THROW(parse(R"({"a\"b": 1, "c\\d": 2})", validator));
+
+    std::string error;
+    EXPECT_FALSE(validator.validate(JsonValue(R"({"c\\d": 2})"), &error));
+    EXPECT_EQ(error, "/: missing required property 'a\"b'");
+}
+
+TEST_F(SchemaValidatorTest, InvalidSchemaThrows)
+{
+    EXPECT_THROW(SchemaValidator(R"({"type": "text"})"), std::runtime_error);
+    EXPECT_THROW(SchemaValidator(R"({"minimum": "zero"})"), std::runtime_error);
+    EXPECT_THROW(SchemaValidator(R"({"pattern": "("})"), std::runtime_error);
+    EXPECT_THROW(SchemaValidator(R"(42)"), std::runtime_error);
+}
+
+TEST_F(SchemaValidatorTest, EqualsComparesStructurally)
+{
+    auto a = JsonValue(R"({"x": [1, "two", {"y": true}], "z": null})");
+    auto b = JsonValue(R"({"z": null, "x": [1, "two", {"y": true}]})");
+    auto c = JsonValue(R"({"x": [1, "two", {"y": false}], "z": null})");
+
+    EXPECT_TRUE(equals(a, b));
+    EXPECT_FALSE(equals(a, c));
+    EXPECT_EQ(getter::get_type(nullptr), JsonType::Null);
+    EXPECT_EQ(getter::get_type(a), JsonType::Object);
+}
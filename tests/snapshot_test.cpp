@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+using namespace hh_json;
+
+class SnapshotTest : public ::testing::Test
+{
+protected:
+    std::shared_ptr<JsonObject> doc = JsonValue(R"({
+        "name": "reference",
+        "version": 3,
+        "enabled": true,
+        "missing": null,
+        "items": [{"id": 1, "label": "one"}, {"id": 2, "label": "two"}],
+        "weights": [0.5, 1.25, -3]
+    })");
+};
+
+TEST_F(SnapshotTest, QueryFromBuffer)
+{
+    auto image = snapshot::Image::from_buffer(snapshot::write(doc));
+    auto root = image->root();
+
+    EXPECT_EQ(root.type(), JsonType::Object);
+    EXPECT_EQ(root.size(), 6u);
+    EXPECT_EQ(root.get("name").get_string(), "reference");
+    EXPECT_DOUBLE_EQ(root.get("version").get_number(), 3.0);
+    EXPECT_TRUE(root.get("enabled").get_boolean());
+
+    EXPECT_TRUE(root.has_key("missing"));
+    EXPECT_EQ(root.get("missing").type(), JsonType::Null);
+    EXPECT_FALSE(root.get("absent"));
+
+    auto items = root.get("items");
+    EXPECT_EQ(items.type(), JsonType::Array);
+    ASSERT_EQ(items.size(), 2u);
+    EXPECT_EQ(items.at(1).get("label").get_string(), "two");
+    EXPECT_FALSE(items.at(2));
+}
+
+TEST_F(SnapshotTest, MaterializeRoundTrip)
+{
+    auto image = snapshot::Image::from_buffer(snapshot::write(doc));
+    EXPECT_TRUE(equals(image->root().materialize(), doc));
+    EXPECT_TRUE(equals(JsonValue(image->root().stringify()), doc));
+}
+
+TEST_F(SnapshotTest, UnindexedKeysStillResolve)
+{
+    auto image = snapshot::Image::from_buffer(snapshot::write(doc, false));
+    EXPECT_EQ(image->root().get("name").get_string(), "reference");
+    EXPECT_DOUBLE_EQ(image->root().get("weights").at(2).get_number(), -3.0);
+}
+
+TEST_F(SnapshotTest, IndexedKeysAreSorted)
+{
+    auto image = snapshot::Image::from_buffer(snapshot::write(doc));
+    auto root = image->root();
+    for (size_t i = 1; i < root.size(); ++i)
+    {
+        EXPECT_LT(root.key_at(i - 1), root.key_at(i));
+    }
+}
+
+TEST_F(SnapshotTest, KeysWithEscapesResolve)
+{
+    auto escaped = JsonValue(R"({"a\"b": 1, "c\\d": {"\n": true}, "plain": 2})");
+    for (bool index_keys : {true, false})
+    {
+        auto image = snapshot::Image::from_buffer(snapshot::write(escaped, index_keys));
+        auto root = image->root();
+        EXPECT_DOUBLE_EQ(root.get("a\"b").get_number(), 1.0);
+        EXPECT_TRUE(root.get("c\\d").get("\n").get_boolean());
+        EXPECT_TRUE(equals(image->root().materialize(), escaped));
+        EXPECT_TRUE(equals(JsonValue(image->root().stringify()), escaped));
+    }
+}
+
+TEST_F(SnapshotTest, MapFile)
+{
+    auto path = (std::filesystem::temp_directory_path() / "hh_json_snapshot_test.bin").string();
+    snapshot::write_file(doc, path);
+
+    {
+        auto image = snapshot::Image::open(path);
+        EXPECT_EQ(image->root().get("items").at(0).get("label").get_string(), "one");
+        EXPECT_TRUE(equals(image->root().materialize(), doc));
+    }
+    std::remove(path.c_str());
+}
+
+TEST_F(SnapshotTest, RejectsCorruptImages)
+{
+    EXPECT_THROW(snapshot::Image::from_buffer("short"), std::runtime_error);
+    EXPECT_THROW(snapshot::Image::from_buffer(std::string(128, 'x')), std::runtime_error);
+
+    auto bytes = snapshot::write(doc);
+    bytes.resize(bytes.size() / 2);
+    EXPECT_THROW(snapshot::Image::from_buffer(bytes), std::runtime_error);
+}
+
+TEST_F(SnapshotTest, TypeMismatchThrows)
+{
+    auto image = snapshot::Image::from_buffer(snapshot::write(doc));
+    EXPECT_THROW(image->root().get("name").get_number(), std::runtime_error);
+    EXPECT_THROW(image->root().get("version").get_string(), std::runtime_error);
+}
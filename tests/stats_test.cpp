@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <string>
+#include <vector>
+
+using namespace hh_json;
+
+// Built into the main suite (stats off) and json_parser_stats_tests (HH_JSON_STATS=1)
+class StatsTest : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        stats::set_hook(nullptr);
+    }
+};
+
+TEST_F(StatsTest, ParseFillsCounters)
+{
+    stats::Stats collected;
+    collected.objects = 99; // overwritten even when stats are compiled out
+    ParseOptions options;
+    options.stats = &collected;
+
+    auto parsed = parse(R"({"a": [1, 2.5, "x\ny"], "b": {"c": true, "d": null}, "long": "a string longer than any small buffer"})", options);
+    ASSERT_EQ(parsed.size(), 3u);
+
+    if (!stats::enabled)
+    {
+        EXPECT_EQ(collected.objects, 0u);
+        EXPECT_EQ(collected.input_bytes, 0u);
+        return;
+    }
+    EXPECT_EQ(collected.operation, stats::Operation::Parse);
+    EXPECT_EQ(collected.objects, 2u);
+    EXPECT_EQ(collected.arrays, 1u);
+    EXPECT_EQ(collected.strings, 2u);
+    EXPECT_EQ(collected.numbers, 2u);
+    EXPECT_EQ(collected.booleans, 1u);
+    EXPECT_EQ(collected.nulls, 1u);
+    EXPECT_EQ(collected.escapes, 1u);
+    EXPECT_EQ(collected.max_depth, 2u);
+    EXPECT_GT(collected.input_bytes, 0u);
+    // Keys a, b, c, d, long plus both string values
+    EXPECT_EQ(collected.bytes_copied, 1u + 1 + 1 + 1 + 4 + 3 + 37);
+    // 8 non-null nodes plus the one string too long for the small-string buffer
+    EXPECT_EQ(collected.allocations, 9u);
+}
+
+TEST_F(StatsTest, HookSeesParsesAndSerialization)
+{
+    std::vector<stats::Stats> seen;
+    stats::set_hook([&seen](const stats::Stats &s)
+                    { seen.push_back(s); });
+
+    auto value = JsonValue(R"({"list": [[1], [2]]})");
+    ASSERT_NE(value, nullptr);
+    std::string text = value->stringify();
+
+    if (!stats::enabled)
+    {
+        EXPECT_TRUE(seen.empty());
+        return;
+    }
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0].operation, stats::Operation::Parse);
+    EXPECT_EQ(seen[0].arrays, 3u);
+    EXPECT_EQ(seen[0].max_depth, 3u);
+    // Nested containers do not report on their own
+    EXPECT_EQ(seen[1].operation, stats::Operation::Serialize);
+    EXPECT_EQ(seen[1].output_bytes, text.size());
+}
+
+TEST_F(StatsTest, FailedParseIsReported)
+{
+    stats::Stats collected;
+    ParseOptions options;
+    options.stats = &collected;
+    size_t calls = 0;
+    stats::set_hook([&calls](const stats::Stats &)
+                    { ++calls; });
+
+    EXPECT_FALSE(try_parse(R"({"a": [1, 2})", options));
+    EXPECT_EQ(calls, stats::enabled ? 1u : 0u);
+    EXPECT_EQ(collected.numbers, stats::enabled ? 2u : 0u);
+}
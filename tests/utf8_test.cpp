@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "../json-parser.hpp"
+#include <string>
+
+using namespace hh_json;
+
+class Utf8Test : public ::testing::Test
+{
+};
+
+TEST_F(Utf8Test, ValidSequences)
+{
+    EXPECT_TRUE(utf8::validate(""));
+    EXPECT_TRUE(utf8::validate("plain ascii"));
+    EXPECT_TRUE(utf8::validate("Hello 世界 🌍 é"));
+    EXPECT_TRUE(utf8::validate("\xF4\x8F\xBF\xBF"));      // U+10FFFF
+    EXPECT_TRUE(utf8::validate("\xEF\xBF\xBD"));          // U+FFFD
+    EXPECT_EQ(utf8::sequence_length("\xC3\xA9", 2), 2u);
+    EXPECT_EQ(utf8::sequence_length("\xF0\x9F\x8C\x8D", 4), 4u);
+}
+
+TEST_F(Utf8Test, InvalidSequences)
+{
+    const char *invalid[] = {
+        "\x80",             // lone continuation
+        "\xC0\xAF",         // overlong '/'
+        "\xE0\x80\xAF",     // overlong 3-byte
+        "\xED\xA0\x80",     // UTF-16 surrogate
+        "\xF4\x90\x80\x80", // above U+10FFFF
+        "\xF5\x80\x80\x80", // invalid lead byte
+        "\xE4\xB8",         // truncated
+        "\xC3\x28",         // bad continuation
+    };
+    for (const char *text : invalid)
+    {
+        EXPECT_FALSE(utf8::validate(text)) << text;
+    }
+
+    size_t offset = 0;
+    EXPECT_FALSE(utf8::validate("abc\xE4\xB8", &offset));
+    EXPECT_EQ(offset, 3u);
+}
+
+// Errors past the first vector-sized chunk are found at the right offset
+TEST_F(Utf8Test, LongInputs)
+{
+    std::string text(100, 'a');
+    text += "世界";
+    text += std::string(37, 'b');
+    EXPECT_TRUE(utf8::validate(text));
+
+    text[120] = '\xFF';
+    size_t offset = 0;
+    EXPECT_FALSE(utf8::validate(text, &offset));
+    EXPECT_EQ(offset, 120u);
+}
+
+TEST_F(Utf8Test, PlainPrefixStopsAtSpecials)
+{
+    std::string text(40, 'x');
+    EXPECT_EQ(utf8::plain_prefix(text.data(), text.size()), 40u);
+    text[33] = '"';
+    EXPECT_EQ(utf8::plain_prefix(text.data(), text.size()), 33u);
+    text[17] = '\\';
+    EXPECT_EQ(utf8::plain_prefix(text.data(), text.size()), 17u);
+    text[2] = '\xC3';
+    EXPECT_EQ(utf8::plain_prefix(text.data(), text.size()), 2u);
+
+    // Control characters must be escaped in JSON strings, so they stop the run too
+    std::string controls(40, 'x');
+    controls[35] = '\x1F';
+    EXPECT_EQ(utf8::plain_prefix(controls.data(), controls.size()), 35u);
+    controls[20] = '\t';
+    EXPECT_EQ(utf8::plain_prefix(controls.data(), controls.size()), 20u);
+    controls[0] = '\0';
+    EXPECT_EQ(utf8::plain_prefix(controls.data(), controls.size()), 0u);
+    EXPECT_TRUE(utf8::validate(controls));
+}
+
+TEST_F(Utf8Test, Append)
+{
+    std::string out;
+    utf8::append(out, 0x41);
+    utf8::append(out, 0xE9);
+    utf8::append(out, 0x4E16);
+    utf8::append(out, 0x1F30D);
+    EXPECT_EQ(out, "A\xC3\xA9\xE4\xB8\x96\xF0\x9F\x8C\x8D");
+}